@@ -8,9 +8,13 @@
 #include "Omega_h_histogram.hpp"
 #include "Omega_h_laplace.hpp"
 #include "Omega_h_map.hpp"
+#include "Omega_h_mark.hpp"
 #include "Omega_h_profile.hpp"
 #include "Omega_h_quality.hpp"
 #include "Omega_h_refine.hpp"
+#include "Omega_h_refine_coarsen.hpp"
+#include "Omega_h_shape.hpp"
+#include "Omega_h_smooth.hpp"
 #include "Omega_h_swap.hpp"
 #include "Omega_h_timer.hpp"
 #include "Omega_h_transfer.hpp"
@@ -74,7 +78,7 @@ AdaptOpts::AdaptOpts(Int dim) {
 #ifdef OMEGA_H_USE_EGADS
   egads_model = nullptr;
   should_smooth_snap = true;
-  snap_smooth_tolerance = 1e-2;
+  snap_smooth_tolerance = 1e-4;
   allow_snap_failure = false;
 #endif
   should_refine = true;
@@ -82,14 +86,76 @@ AdaptOpts::AdaptOpts(Int dim) {
   should_swap = true;
   should_coarsen_slivers = true;
   should_prevent_coarsen_flip = false;
+  should_fuse_refine_coarsen = false;
+  should_smooth = false;
+  nregion_layers = 1;
 }
 
-static Reals get_fixable_qualities(Mesh* mesh, AdaptOpts const&) {
+/* the region elements, grown by (nregion_layers) layers through
+   shared vertices */
+static Read<I8> grow_adapt_region(Mesh* mesh, AdaptOpts const& opts) {
+  auto dim = mesh->dim();
+  auto elems_in_region = mesh->get_array<I8>(dim, opts.region_name);
+  for (Int i = 0; i < opts.nregion_layers; ++i) {
+    auto verts_in_region = mark_down(mesh, dim, VERT, elems_in_region);
+    elems_in_region = mark_up(mesh, VERT, dim, verts_in_region);
+  }
+  return elems_in_region;
+}
+
+/* entities of (ent_dim) all of whose elements are in the grown region,
+   i.e. those whose cavities may be modified */
+static Read<I8> mark_inside_region(
+    Mesh* mesh, Int ent_dim, Read<I8> elems_in_region) {
+  auto dim = mesh->dim();
+  if (ent_dim == dim) return elems_in_region;
+  auto elems_outside = invert_marks(elems_in_region);
+  return invert_marks(mark_down(mesh, dim, ent_dim, elems_outside));
+}
+
+/* adapt() computes the region once and keeps it in the "adapt_region"
+   tag, which is inherited and stays exact because no cavity reaches
+   outside it. other callers compute it on the spot */
+static Read<I8> get_adapt_region(
+    Mesh* mesh, AdaptOpts const& opts, Int ent_dim) {
+  if (mesh->has_tag(ent_dim, "adapt_region")) {
+    return mesh->get_array<I8>(ent_dim, "adapt_region");
+  }
+  return mark_inside_region(mesh, ent_dim, grow_adapt_region(mesh, opts));
+}
+
+Read<I8> restrict_to_region(
+    Mesh* mesh, AdaptOpts const& opts, Int ent_dim, Read<I8> marks) {
+  if (opts.region_name.empty()) return marks;
+  return land_each(marks, get_adapt_region(mesh, opts, ent_dim));
+}
+
+/* owned entities of (ent_dim) in the adapt region */
+static LOs get_owned_region_ents(
+    Mesh* mesh, AdaptOpts const& opts, Int ent_dim) {
+  auto in_region = get_adapt_region(mesh, opts, ent_dim);
+  return collect_marked(land_each(in_region, mesh->owned(ent_dim)));
+}
+
+static Reals get_fixable_qualities(Mesh* mesh, AdaptOpts const& opts) {
   /* This used to be an attempt to continue adapting when certain
      elements were constrained to by geometry to have small dihedral angles.
      We'll leave it here as a placeholder for reimplementing such a system
-     in the future, but for now it just returns all qualities */
-  return mesh->ask_qualities();
+     in the future, but for now it just returns all qualities
+     of the owned elements in the adapt region */
+  auto dim = mesh->dim();
+  if (opts.region_name.empty()) {
+    return mesh->owned_array(dim, mesh->ask_qualities(), 1);
+  }
+  return measure_qualities(mesh, get_owned_region_ents(mesh, opts, dim));
+}
+
+/* lengths of the owned edges in the adapt region */
+static Reals get_region_lengths(Mesh* mesh, AdaptOpts const& opts) {
+  if (opts.region_name.empty()) {
+    return mesh->owned_array(EDGE, mesh->ask_lengths(), 1);
+  }
+  return measure_edges_metric(mesh, get_owned_region_ents(mesh, opts, EDGE));
 }
 
 Real min_fixable_quality(Mesh* mesh, AdaptOpts const& opts) {
@@ -99,20 +165,22 @@ Real min_fixable_quality(Mesh* mesh, AdaptOpts const& opts) {
 AdaptOpts::AdaptOpts(Mesh* mesh) : AdaptOpts(mesh->dim()) {}
 
 static void adapt_summary(Mesh* mesh, AdaptOpts const& opts,
-    MinMax<Real> qualstats, MinMax<Real> lenstats) {
-  print_goal_stats(mesh, "quality", mesh->dim(),
-      get_fixable_qualities(mesh, opts),
+    Reals qualities, Reals lengths, MinMax<Real> qualstats,
+    MinMax<Real> lenstats) {
+  print_goal_stats(mesh, "quality", mesh->dim(), qualities,
       {opts.min_quality_allowed, opts.min_quality_desired}, qualstats);
-  print_goal_stats(mesh, "length", EDGE, mesh->ask_lengths(),
+  print_goal_stats(mesh, "length", EDGE, lengths,
       {opts.min_length_desired, opts.max_length_desired}, lenstats);
 }
 
 bool print_adapt_status(Mesh* mesh, AdaptOpts const& opts) {
   OMEGA_H_TIME_FUNCTION;
-  auto qualstats = get_minmax(mesh->comm(), get_fixable_qualities(mesh, opts));
-  auto lenstats = get_minmax(mesh->comm(), mesh->ask_lengths());
+  auto qualities = get_fixable_qualities(mesh, opts);
+  auto lengths = get_region_lengths(mesh, opts);
+  auto qualstats = get_minmax(mesh->comm(), qualities);
+  auto lenstats = get_minmax(mesh->comm(), lengths);
   if (opts.verbosity > SILENT) {
-    adapt_summary(mesh, opts, qualstats, lenstats);
+    adapt_summary(mesh, opts, qualities, lengths, qualstats, lenstats);
   }
   return (qualstats.min >= opts.min_quality_desired &&
           lenstats.min >= opts.min_length_desired &&
@@ -120,16 +188,16 @@ bool print_adapt_status(Mesh* mesh, AdaptOpts const& opts) {
 }
 
 void print_adapt_histograms(Mesh* mesh, AdaptOpts const& opts) {
-  auto qh = get_histogram(mesh, mesh->dim(), opts.nquality_histogram_bins, 0.0,
-      1.0, mesh->ask_qualities());
-  auto lh = get_histogram(mesh, EDGE, opts.nlength_histogram_bins,
-      opts.length_histogram_min, opts.length_histogram_max,
-      mesh->ask_lengths());
-  auto owned_qualities =
-      mesh->owned_array(mesh->dim(), mesh->ask_qualities(), 1);
-  auto qual_sum = get_sum(mesh->comm(), owned_qualities);
-  auto global_nelems = mesh->nglobal_ents(mesh->dim());
-  auto avg_qual = qual_sum / global_nelems;
+  auto comm = mesh->comm();
+  auto owned_qualities = get_fixable_qualities(mesh, opts);
+  auto owned_lengths = get_region_lengths(mesh, opts);
+  auto qh = get_histogram(
+      comm, opts.nquality_histogram_bins, 0.0, 1.0, owned_qualities);
+  auto lh = get_histogram(comm, opts.nlength_histogram_bins,
+      opts.length_histogram_min, opts.length_histogram_max, owned_lengths);
+  auto qual_sum = get_sum(comm, owned_qualities);
+  auto nregion_elems = comm->allreduce(GO(owned_qualities.size()), OMEGA_H_SUM);
+  auto avg_qual = qual_sum / Real(nregion_elems);
   if (can_print(mesh)) {
     print_histogram(qh, "quality");
     print_histogram(lh, "length");
@@ -150,7 +218,40 @@ static void validate(Mesh* mesh, AdaptOpts const& opts) {
   }
 }
 
+/* inheritance needs the region tag on every dimension, which
+   for the lower ones holds the closure of the region elements.
+   the grown region is computed here once for the whole adapt pass */
+static void setup_region_tags(Mesh* mesh, AdaptOpts const& opts) {
+  if (opts.region_name.empty()) return;
+  OMEGA_H_CHECK(opts.nregion_layers >= 0);
+  auto dim = mesh->dim();
+  OMEGA_H_CHECK(mesh->has_tag(dim, opts.region_name));
+  OMEGA_H_CHECK(
+      mesh->get_tagbase(dim, opts.region_name)->type() == OMEGA_H_I8);
+  OMEGA_H_CHECK(is_transfer_required(
+      opts.xfer_opts, opts.region_name, OMEGA_H_INHERIT));
+  auto elems_in_region = mesh->get_array<I8>(dim, opts.region_name);
+  for (Int ent_dim = 0; ent_dim < dim; ++ent_dim) {
+    mesh->add_tag(ent_dim, opts.region_name, 1,
+        mark_down(mesh, dim, ent_dim, elems_in_region));
+  }
+  auto elems_in_adapt_region = grow_adapt_region(mesh, opts);
+  for (Int ent_dim = 0; ent_dim <= dim; ++ent_dim) {
+    mesh->add_tag(ent_dim, "adapt_region", 1,
+        mark_inside_region(mesh, ent_dim, elems_in_adapt_region));
+  }
+}
+
+static void remove_region_tags(Mesh* mesh) {
+  for (Int ent_dim = 0; ent_dim <= mesh->dim(); ++ent_dim) {
+    if (mesh->has_tag(ent_dim, "adapt_region")) {
+      mesh->remove_tag(ent_dim, "adapt_region");
+    }
+  }
+}
+
 static bool pre_adapt(Mesh* mesh, AdaptOpts const& opts) {
+  setup_region_tags(mesh, opts);
   validate(mesh, opts);
   opts.xfer_opts.validate(mesh);
   if (opts.verbosity >= EACH_ADAPT && !mesh->comm()->rank()) {
@@ -175,6 +276,11 @@ static void satisfy_lengths(Mesh* mesh, AdaptOpts const& opts) {
   bool did_anything;
   do {
     did_anything = false;
+    if (opts.should_fuse_refine_coarsen) {
+      did_anything = refine_coarsen_by_size(mesh, opts);
+      if (did_anything) post_rebuild(mesh, opts);
+      continue;
+    }
     if (opts.should_refine && refine_by_size(mesh, opts)) {
       post_rebuild(mesh, opts);
       did_anything = true;
@@ -193,10 +299,19 @@ static bool satisfy_quality(Mesh* mesh, AdaptOpts const& opts) {
     std::cout << "addressing element qualities\n";
   }
   do {
+    /* one smoothing pass per iteration, after which swapping still
+       gets its turn, so that a long run of small smoothing gains
+       cannot hold off the swaps that the worst elements may need */
+    bool did_smooth = false;
+    if (opts.should_smooth && smooth_verts(mesh, opts)) {
+      post_rebuild(mesh, opts);
+      did_smooth = true;
+    }
     if (opts.should_swap && swap_edges(mesh, opts)) {
       post_rebuild(mesh, opts);
       continue;
     }
+    if (did_smooth) continue;
     if (opts.should_coarsen_slivers && coarsen_slivers(mesh, opts)) {
       post_rebuild(mesh, opts);
       continue;
@@ -273,7 +388,10 @@ bool adapt(Mesh* mesh, AdaptOpts const& opts) {
   ScopedTimer adapt_timer("adapt");
   OMEGA_H_CHECK(mesh->family() == OMEGA_H_SIMPLEX);
   auto t0 = now();
-  if (!pre_adapt(mesh, opts)) return false;
+  if (!pre_adapt(mesh, opts)) {
+    remove_region_tags(mesh);
+    return false;
+  }
   setup_conservation_tags(mesh, opts);
   auto t1 = now();
   satisfy_lengths(mesh, opts);
@@ -284,6 +402,7 @@ bool adapt(Mesh* mesh, AdaptOpts const& opts) {
   auto t4 = now();
   mesh->set_parting(OMEGA_H_ELEM_BASED);
   post_adapt(mesh, opts, t0, t1, t2, t3, t4);
+  remove_region_tags(mesh);
   return true;
 }
 
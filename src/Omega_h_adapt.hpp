@@ -65,6 +65,8 @@ struct AdaptOpts {
 #ifdef OMEGA_H_USE_EGADS
   Egads* egads_model;
   bool should_smooth_snap;
+  /* relative residual reduction of the warp smoothing solve,
+     see solve_laplacian() */
   Real snap_smooth_tolerance;
   bool allow_snap_failure;
 #endif
@@ -73,11 +75,29 @@ struct AdaptOpts {
   bool should_swap;
   bool should_coarsen_slivers;
   bool should_prevent_coarsen_flip;
+  /* split and collapse in the same rebuild while satisfying lengths */
+  bool should_fuse_refine_coarsen;
+  /* relocate vertices to improve qualities, one pass before each
+     round of swapping */
+  bool should_smooth;
+  /* if not empty, the name of an I8 element tag marking the region to
+     adapt. adapt() grows it once by (nregion_layers) layers of elements
+     through shared vertices, and only modifies cavities inside the grown
+     set, so elements outside it keep their vertices. the status reports
+     cover its elements and the edges all of whose elements are in it.
+     the tag is transferred with OMEGA_H_INHERIT */
+  std::string region_name;
+  Int nregion_layers;
   TransferOpts xfer_opts;
 };
 
 Real min_fixable_quality(Mesh* mesh, AdaptOpts const& opts);
 
+/* (marks) on entities of (ent_dim), cleared on those with an element
+   outside the adapt region */
+Read<I8> restrict_to_region(
+    Mesh* mesh, AdaptOpts const& opts, Int ent_dim, Read<I8> marks);
+
 /* returns false if the mesh was not modified. */
 bool adapt(Mesh* mesh, AdaptOpts const& opts);
 
@@ -114,6 +134,7 @@ struct MetricInput {
   bool should_limit_gradation;
   Real max_gradation_rate;
   Real gradation_convergence_tolerance;
+  bool should_limit_gradation_by_front;
   bool should_limit_element_count;
   Real max_element_count;
   Real min_element_count;
@@ -3,6 +3,7 @@
 #include "Omega_h_align.hpp"
 #include "Omega_h_amr.hpp"
 #include "Omega_h_array_ops.hpp"
+#include "Omega_h_atomics.hpp"
 #include "Omega_h_element.hpp"
 #include "Omega_h_for.hpp"
 #include "Omega_h_int_scan.hpp"
@@ -10,6 +11,8 @@
 #include "Omega_h_sort.hpp"
 #include "Omega_h_timer.hpp"
 
+#include <cstdint>
+
 namespace Omega_h {
 
 Adj unmap_adjacency(LOs const a2b, Adj const b2c) {
@@ -130,28 +133,6 @@ Read<I8> find_canonical_jumps(
   return jumps;
 }
 
-static LOs find_unique_deg(Int const deg, LOs const uv2v) {
-  OMEGA_H_TIME_FUNCTION;
-  auto const codes = get_codes_to_canonical(deg, uv2v);
-  auto const uv2v_canon = align_ev2v(deg, uv2v, codes);
-  auto const sorted2u = sort_by_keys(uv2v_canon, deg);
-  auto const jumps = find_canonical_jumps(deg, uv2v_canon, sorted2u);
-  auto const e2sorted = collect_marked(jumps);
-  auto const e2u = compound_maps(e2sorted, sorted2u);
-  return unmap<LO>(e2u, uv2v, deg);
-}
-
-LOs find_unique(LOs const hv2v, Omega_h_Family const family, Int const high_dim,
-    Int const low_dim) {
-  OMEGA_H_TIME_FUNCTION;
-  OMEGA_H_CHECK(high_dim > low_dim);
-  OMEGA_H_CHECK(low_dim <= 2);
-  OMEGA_H_CHECK(hv2v.size() % element_degree(family, high_dim, VERT) == 0);
-  auto const uv2v = form_uses(hv2v, family, high_dim, low_dim);
-  auto const deg = element_degree(family, low_dim, VERT);
-  return find_unique_deg(deg, uv2v);
-}
-
 LOs form_uses(LOs const hv2v, Omega_h_Family const family, Int const high_dim,
     Int const low_dim) {
   OMEGA_H_TIME_FUNCTION;
@@ -262,6 +243,72 @@ Adj invert_adj(Adj const down, Int const nlows_per_high, LO const nlows,
   return Adj(l2lh, lh2h, codes);
 }
 
+Adj patch_up_adj(Adj const old_up, LOs const old_lows2new_lows,
+    LOs const old_highs2new_highs, Adj const prods2new_lows,
+    LOs const prods2new_highs, Int const nlows_per_high, LO const nnew_lows,
+    Int const high_dim, Int const low_dim) {
+  OMEGA_H_TIME_FUNCTION;
+  auto const prod_up =
+      invert_adj(prods2new_lows, nlows_per_high, nnew_lows, high_dim, low_dim);
+  auto const l2lp = prod_up.a2ab;
+  auto const lp2p = prod_up.ab2b;
+  auto const lp_codes = prod_up.codes;
+  auto const old_l2lh = old_up.a2ab;
+  auto const old_lh2h = old_up.ab2b;
+  auto const old_codes = old_up.codes;
+  Write<LO> new_lows2old_lows(nnew_lows, -1);
+  auto f = OMEGA_H_LAMBDA(LO old_low) {
+    auto const new_low = old_lows2new_lows[old_low];
+    if (new_low >= 0) new_lows2old_lows[new_low] = old_low;
+  };
+  parallel_for(old_lows2new_lows.size(), std::move(f));
+  Write<LO> degrees(nnew_lows);
+  auto g = OMEGA_H_LAMBDA(LO new_low) {
+    LO degree = l2lp[new_low + 1] - l2lp[new_low];
+    auto const old_low = new_lows2old_lows[new_low];
+    if (old_low >= 0) {
+      for (auto lh = old_l2lh[old_low]; lh < old_l2lh[old_low + 1]; ++lh) {
+        if (old_highs2new_highs[old_lh2h[lh]] >= 0) ++degree;
+      }
+    }
+    degrees[new_low] = degree;
+  };
+  parallel_for(nnew_lows, std::move(g));
+  auto const l2lh = offset_scan(LOs(degrees));
+  auto const nlh = l2lh.last();
+  Write<LO> lh2h(nlh);
+  Write<I8> codes(nlh);
+  /* surviving uses keep their relative order, since modification
+     numbers the entities that stay the same in their old order.
+     uses by products are inserted among them */
+  auto h = OMEGA_H_LAMBDA(LO new_low) {
+    auto const begin = l2lh[new_low];
+    auto end = begin;
+    auto const old_low = new_lows2old_lows[new_low];
+    if (old_low >= 0) {
+      for (auto lh = old_l2lh[old_low]; lh < old_l2lh[old_low + 1]; ++lh) {
+        auto const new_high = old_highs2new_highs[old_lh2h[lh]];
+        if (new_high < 0) continue;
+        lh2h[end] = new_high;
+        codes[end] = old_codes[lh];
+        ++end;
+      }
+    }
+    for (auto lp = l2lp[new_low]; lp < l2lp[new_low + 1]; ++lp) {
+      auto const new_high = prods2new_highs[lp2p[lp]];
+      auto lh = end++;
+      for (; lh > begin && lh2h[lh - 1] > new_high; --lh) {
+        lh2h[lh] = lh2h[lh - 1];
+        codes[lh] = codes[lh - 1];
+      }
+      lh2h[lh] = new_high;
+      codes[lh] = lp_codes[lp];
+    }
+  };
+  parallel_for(nnew_lows, std::move(h));
+  return Adj(l2lh, lh2h, codes);
+}
+
 Bytes filter_parents(Parents const c2p, Int const parent_dim) {
   OMEGA_H_TIME_FUNCTION;
   Write<Byte> filter(c2p.parent_idx.size());
@@ -421,6 +468,191 @@ void find_matches(Omega_h_Family const family, Int const dim, LOs const av2v,
   find_matches_ex(deg, a2fv, av2v, bv2v, v2b, a2b_out, codes_out);
 }
 
+/* given uses and the unique entities they were matched to,
+   derive the alignment codes of the uses, exactly as
+   find_matches would */
+template <Int deg>
+static Read<I8> get_use_codes_deg(LOs const uv2v, LOs const u2e,
+    LOs const ev2v) {
+  auto const nuses = u2e.size();
+  Write<I8> codes(nuses);
+  auto f = OMEGA_H_LAMBDA(LO u) {
+    auto const e = u2e[u];
+    auto const u_begin = u * deg;
+    auto const e_begin = e * deg;
+    Int which_down = 0;
+    while (ev2v[e_begin + which_down] != uv2v[u_begin]) ++which_down;
+    I8 match_code = -1;
+    auto const found = IsMatch<deg>::eval(
+        uv2v, u_begin, ev2v, e_begin, which_down, &match_code);
+    (void)found;
+    OMEGA_H_CHECK(found);
+    codes[u] = match_code;
+  };
+  parallel_for(nuses, std::move(f));
+  return codes;
+}
+
+static Read<I8> get_use_codes(
+    Int const deg, LOs const uv2v, LOs const u2e, LOs const ev2v) {
+  OMEGA_H_TIME_FUNCTION;
+  if (deg == 4) return get_use_codes_deg<4>(uv2v, u2e, ev2v);
+  if (deg == 3) return get_use_codes_deg<3>(uv2v, u2e, ev2v);
+  if (deg == 2) return get_use_codes_deg<2>(uv2v, u2e, ev2v);
+  OMEGA_H_NORETURN(Read<I8>());
+}
+
+/* sort all uses by their canonical vertex lists, and let
+   the last use in each run of equal lists define the entity */
+static void find_unique_by_sorting(
+    Int const deg, LOs const canon, LOs* e2u_out, LOs* u2e_out) {
+  OMEGA_H_TIME_FUNCTION;
+  auto const sorted2u = sort_by_keys(canon, deg);
+  auto const jumps = find_canonical_jumps(deg, canon, sorted2u);
+  auto const e2sorted = collect_marked(jumps);
+  *e2u_out = compound_maps(e2sorted, sorted2u);
+  if (!u2e_out) return;
+  auto const sorted2e = offset_scan(jumps);
+  auto const nuses = sorted2u.size();
+  Write<LO> u2e(nuses);
+  auto f = OMEGA_H_LAMBDA(LO sorted) {
+    u2e[sorted2u[sorted]] = sorted2e[sorted];
+  };
+  parallel_for(nuses, std::move(f));
+  *u2e_out = u2e;
+}
+
+OMEGA_H_DEVICE static std::uint32_t hash_canonical(
+    Int const deg, LOs const& canon, LO const u) {
+  std::uint32_t h = 2166136261u;
+  for (Int j = 0; j < deg; ++j) {
+    h ^= std::uint32_t(canon[u * deg + j]);
+    h *= 16777619u;
+  }
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  return h;
+}
+
+/* a power of two with room for every use at a load factor
+   of at most 2/3, in case all of them are unique */
+static LO get_unique_table_size(LO const nuses) {
+  LO size = 1;
+  while (size < nuses + nuses / 2) {
+    OMEGA_H_CHECK(size <= ArithTraits<LO>::max() / 2);
+    size *= 2;
+  }
+  return size;
+}
+
+/* insert all uses into an open-addressing hash table keyed
+   on their canonical vertex lists, using linear probing.
+   each slot ends up holding the largest index of the uses
+   that share its vertex list, which is the same use the
+   sorting path picks, regardless of thread scheduling */
+static void hash_uses(
+    Int const deg, LOs const canon, Write<LO>* table_out, LOs* u2slot_out) {
+  OMEGA_H_TIME_FUNCTION;
+  auto const nuses = divide_no_remainder(canon.size(), deg);
+  auto const size = get_unique_table_size(nuses);
+  auto const mask = std::uint32_t(size - 1);
+  Write<LO> table(size, -1);
+  Write<LO> u2slot(nuses);
+  auto f = OMEGA_H_LAMBDA(LO u) {
+    auto slot = LO(hash_canonical(deg, canon, u) & mask);
+    while (true) {
+      auto stored = atomic_compare_exchange(&table[slot], -1, u);
+      if (stored == -1) break;
+      if (are_equal(deg, canon, stored, u)) {
+        while (stored < u) {
+          auto const prev = atomic_compare_exchange(&table[slot], stored, u);
+          if (prev == stored) break;
+          stored = prev;
+        }
+        break;
+      }
+      slot = LO((std::uint32_t(slot) + 1) & mask);
+    }
+    u2slot[u] = slot;
+  };
+  parallel_for(nuses, std::move(f));
+  *table_out = table;
+  *u2slot_out = u2slot;
+}
+
+static void find_unique_by_hashing(Int const deg, LOs const canon,
+    bool const sort_unique, LOs* e2u_out, LOs* u2e_out) {
+  OMEGA_H_TIME_FUNCTION;
+  Write<LO> table;
+  LOs u2slot;
+  hash_uses(deg, canon, &table, &u2slot);
+  auto const nuses = u2slot.size();
+  Write<I8> is_rep(nuses);
+  auto mark_reps = OMEGA_H_LAMBDA(LO u) {
+    is_rep[u] = (table[u2slot[u]] == u);
+  };
+  parallel_for(nuses, std::move(mark_reps));
+  auto e2u = collect_marked(is_rep);
+  if (sort_unique) {
+    /* only the unique entities need sorting, not all their uses */
+    auto const e_canon = read(unmap(e2u, canon, deg));
+    auto const sorted2e = sort_by_keys(e_canon, deg);
+    e2u = compound_maps(sorted2e, e2u);
+  }
+  *e2u_out = e2u;
+  if (!u2e_out) return;
+  /* the table is no longer needed, reuse it to map slots to entities */
+  auto const ne = e2u.size();
+  auto number_slots = OMEGA_H_LAMBDA(LO e) { table[u2slot[e2u[e]]] = e; };
+  parallel_for(ne, std::move(number_slots));
+  Write<LO> u2e(nuses);
+  auto map_uses = OMEGA_H_LAMBDA(LO u) { u2e[u] = table[u2slot[u]]; };
+  parallel_for(nuses, std::move(map_uses));
+  *u2e_out = u2e;
+}
+
+static LOs find_unique_deg(Int const deg, LOs const uv2v,
+    UniqueMethod const method, LOs* u2e_out) {
+  OMEGA_H_TIME_FUNCTION;
+  auto const codes = get_codes_to_canonical(deg, uv2v);
+  auto const uv2v_canon = align_ev2v(deg, uv2v, codes);
+  LOs e2u;
+  if (method == UNIQUE_BY_SORTING) {
+    find_unique_by_sorting(deg, uv2v_canon, &e2u, u2e_out);
+  } else {
+    auto const sort_unique = (method == UNIQUE_BY_HASHING);
+    find_unique_by_hashing(deg, uv2v_canon, sort_unique, &e2u, u2e_out);
+  }
+  return unmap<LO>(e2u, uv2v, deg);
+}
+
+LOs find_unique(LOs const hv2v, Omega_h_Family const family, Int const high_dim,
+    Int const low_dim, UniqueMethod const method) {
+  OMEGA_H_TIME_FUNCTION;
+  OMEGA_H_CHECK(high_dim > low_dim);
+  OMEGA_H_CHECK(low_dim <= 2);
+  OMEGA_H_CHECK(hv2v.size() % element_degree(family, high_dim, VERT) == 0);
+  auto const uv2v = form_uses(hv2v, family, high_dim, low_dim);
+  auto const deg = element_degree(family, low_dim, VERT);
+  return find_unique_deg(deg, uv2v, method, nullptr);
+}
+
+LOs find_unique(LOs const hv2v, Omega_h_Family const family, Int const high_dim,
+    Int const low_dim, Adj* h2l_out, UniqueMethod const method) {
+  OMEGA_H_TIME_FUNCTION;
+  OMEGA_H_CHECK(high_dim > low_dim);
+  OMEGA_H_CHECK(low_dim <= 2);
+  OMEGA_H_CHECK(hv2v.size() % element_degree(family, high_dim, VERT) == 0);
+  auto const uv2v = form_uses(hv2v, family, high_dim, low_dim);
+  auto const deg = element_degree(family, low_dim, VERT);
+  LOs u2e;
+  auto const lv2v = find_unique_deg(deg, uv2v, method, &u2e);
+  auto const codes = get_use_codes(deg, uv2v, u2e, lv2v);
+  *h2l_out = Adj(u2e, codes);
+  return lv2v;
+}
+
 Adj reflect_down(LOs const hv2v, LOs const lv2v, Adj const v2l,
     Omega_h_Family const family, Int const high_dim, Int const low_dim) {
   ScopedTimer timer("reflect_down(v2l)");
@@ -48,6 +48,16 @@ Adj unmap_adjacency(LOs const a2b, Adj const b2c);
 Adj invert_adj(Adj const down, Int const nlows_per_high, LO const nlows,
     Int const high_dim, Int const low_dim);
 
+/* Given the upward adjacency of a mesh that was modified into a new one,
+   derive the upward adjacency of the new mesh. Surviving uses are carried
+   over through the old to new maps (-1 for removed entities) and the uses
+   by product entities are inverted from their downward adjacency.
+   The result equals that of invert_adj() on the new mesh */
+Adj patch_up_adj(Adj const old_up, LOs const old_lows2new_lows,
+    LOs const old_highs2new_highs, Adj const prods2new_lows,
+    LOs const prods2new_highs, Int const nlows_per_high, LO const nnew_lows,
+    Int const high_dim, Int const low_dim);
+
 Children invert_parents(Parents const children2parents, Int const parent_dim,
     Int const nparent_dim_ents);
 
@@ -57,8 +67,29 @@ Children invert_parents(Parents const children2parents, Int const parent_dim,
 LOs form_uses(LOs const hv2v, Omega_h_Family const family, Int const high_dim,
     Int const low_dim);
 
+/* how find_unique identifies uses of the same low entity:
+   UNIQUE_BY_SORTING sorts all uses by their canonical vertex lists.
+   UNIQUE_BY_HASHING inserts all uses into a concurrent hash table
+     and only sorts the unique entities, giving the same result
+     as UNIQUE_BY_SORTING.
+   UNIQUE_BY_HASHING_IN_USE_ORDER skips that final sort and numbers
+     the unique entities in the order of the uses that define them.
+   none of the results depend on the number of threads used */
+enum UniqueMethod {
+  UNIQUE_BY_SORTING,
+  UNIQUE_BY_HASHING,
+  UNIQUE_BY_HASHING_IN_USE_ORDER
+};
+
 LOs find_unique(LOs const hv2v, Omega_h_Family const family, Int const high_dim,
-    Int const low_dim);
+    Int const low_dim, UniqueMethod const method = UNIQUE_BY_HASHING);
+
+/* same as above, but also outputs the downward adjacency from
+   high entities to the new low entities, identical to what
+   reflect_down would derive from the returned vertex lists */
+LOs find_unique(LOs const hv2v, Omega_h_Family const family, Int const high_dim,
+    Int const low_dim, Adj* h2l_out,
+    UniqueMethod const method = UNIQUE_BY_HASHING);
 
 /* for each entity (or entity use), sort its vertex list
    and express the sorting transformation as an alignment code */
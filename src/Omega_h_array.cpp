@@ -43,6 +43,14 @@ Write<T>::Write(LO size_in, std::string const& name_in) {
   end_code();
 }
 
+#ifndef OMEGA_H_USE_KOKKOS
+template <typename T>
+Write<T>::Write(LO size_in, T* data_in, std::shared_ptr<void> owner,
+    std::string const& name_in)
+    : shared_alloc_(sizeof(T) * static_cast<std::size_t>(size_in), name_in,
+          data_in, std::move(owner)) {}
+#endif
+
 template <typename T>
 void fill(Write<T> a, T val) {
   auto f = OMEGA_H_LAMBDA(LO i) { a[i] = val; };
@@ -47,6 +47,13 @@ class Write {
   Write(LO size_in, T offset, T stride, std::string const& name = "");
   Write(std::initializer_list<T> l, std::string const& name = "");
   Write(HostWrite<T> host_write);
+#ifndef OMEGA_H_USE_KOKKOS
+  /* wrap (size_in) items of existing memory at (data_in) without copying.
+     (owner) is kept alive for as long as any array refers to this memory,
+     which must be accessible wherever the array will be used */
+  Write(LO size_in, T* data_in, std::shared_ptr<void> owner,
+      std::string const& name = "");
+#endif
   OMEGA_H_INLINE LO size() const OMEGA_H_NOEXCEPT {
 #ifdef OMEGA_H_CHECK_BOUNDS
     OMEGA_H_CHECK(exists());
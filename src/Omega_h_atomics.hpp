@@ -52,6 +52,26 @@ OMEGA_H_DEVICE void atomic_add(int* const dest, const int val) {
 #endif
 }
 
+/* if (*dest == expected), sets (*dest = desired).
+   always returns the value (*dest) had before the call */
+OMEGA_H_DEVICE int atomic_compare_exchange(
+    int* const dest, const int expected, const int desired) {
+#if defined(OMEGA_H_USE_KOKKOS)
+  return Kokkos::atomic_compare_exchange(dest, expected, desired);
+#elif defined(OMEGA_H_USE_OPENMP)
+  int oldval = expected;
+  __atomic_compare_exchange_n(dest, &oldval, desired, false, __ATOMIC_ACQ_REL,
+      __ATOMIC_ACQUIRE);
+  return oldval;
+#elif defined(OMEGA_H_USE_CUDA)
+  return atomicCAS(dest, expected, desired);
+#else
+  int oldval = *dest;
+  if (oldval == expected) *dest = desired;
+  return oldval;
+#endif
+}
+
 }  // end namespace Omega_h
 
 #endif
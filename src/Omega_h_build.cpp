@@ -16,8 +16,10 @@
 
 namespace Omega_h {
 
-void add_ents2verts(
-    Mesh* mesh, Int ent_dim, LOs ev2v, GOs vert_globals, GOs elem_globals) {
+/* (down), if given, is the already known downward adjacency
+   from these entities to the mesh's entities one dimension lower */
+static void add_ents2verts_down(Mesh* mesh, Int ent_dim, LOs ev2v,
+    GOs vert_globals, GOs elem_globals, Adj const* down_in) {
   auto comm = mesh->comm();
   auto nverts_per_ent = element_degree(mesh->family(), ent_dim, VERT);
   auto ne = divide_no_remainder(ev2v.size(), nverts_per_ent);
@@ -36,6 +38,8 @@ void add_ents2verts(
   }
   if (ent_dim == 1) {
     mesh->set_ents(ent_dim, Adj(ev2v));
+  } else if (down_in) {
+    mesh->set_ents(ent_dim, *down_in);
   } else {
     auto ldim = ent_dim - 1;
     auto lv2v = mesh->ask_verts_of(ldim);
@@ -55,6 +59,12 @@ void add_ents2verts(
   }
 }
 
+void add_ents2verts(
+    Mesh* mesh, Int ent_dim, LOs ev2v, GOs vert_globals, GOs elem_globals) {
+  add_ents2verts_down(
+      mesh, ent_dim, ev2v, vert_globals, elem_globals, nullptr);
+}
+
 void build_verts_from_globals(Mesh* mesh, GOs vert_globals) {
   auto comm = mesh->comm();
   auto nverts = vert_globals.size();
@@ -70,11 +80,21 @@ void build_ents_from_elems2verts(
     Mesh* mesh, LOs ev2v, GOs vert_globals, GOs elem_globals) {
   auto comm = mesh->comm();
   auto elem_dim = mesh->dim();
+  /* in serial the sides are not renumbered after find_unique,
+     so the element-to-side adjacency it derives can be kept */
+  auto const keep_elems2sides = (comm->size() == 1);
+  Adj elems2sides;
   for (Int mdim = 1; mdim < elem_dim; ++mdim) {
-    auto mv2v = find_unique(ev2v, mesh->family(), elem_dim, mdim);
+    LOs mv2v;
+    if (keep_elems2sides && mdim == elem_dim - 1) {
+      mv2v = find_unique(ev2v, mesh->family(), elem_dim, mdim, &elems2sides);
+    } else {
+      mv2v = find_unique(ev2v, mesh->family(), elem_dim, mdim);
+    }
     add_ents2verts(mesh, mdim, mv2v, vert_globals, elem_globals);
   }
-  add_ents2verts(mesh, elem_dim, ev2v, vert_globals, elem_globals);
+  add_ents2verts_down(mesh, elem_dim, ev2v, vert_globals, elem_globals,
+      elems2sides.ab2b.exists() ? &elems2sides : nullptr);
   if (!comm->reduce_and(is_sorted(vert_globals))) {
     reorder_by_globals(mesh);
   }
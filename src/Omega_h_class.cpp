@@ -157,10 +157,9 @@ void finalize_classification(Mesh* mesh) {
     if (ent_dim < mesh->dim()) {
       project_classification(mesh, ent_dim, class_dim_w, class_id_w);
     }
-    auto class_dim = mesh->sync_array(ent_dim, read(class_dim_w), 1);
-    auto class_id = mesh->sync_array(ent_dim, read(class_id_w), 1);
-    mesh->add_tag<I8>(ent_dim, "class_dim", 1, class_dim);
-    mesh->add_tag<ClassId>(ent_dim, "class_id", 1, class_id);
+    mesh->add_tag<I8>(ent_dim, "class_dim", 1, read(class_dim_w));
+    mesh->add_tag<ClassId>(ent_dim, "class_id", 1, read(class_id_w));
+    mesh->sync_tags(ent_dim, {"class_dim", "class_id"});
   }
   if (!had_ids) remove_all_ids(mesh);
 }
@@ -53,7 +53,8 @@ enum OvershootLimit { DESIRED, ALLOWED };
 enum Improve { DONT_IMPROVE, IMPROVE_LOCALLY };
 
 static bool coarsen_ghosted(Mesh* mesh, AdaptOpts const& opts,
-    OvershootLimit overshoot, Improve improve) {
+    OvershootLimit overshoot, Improve improve,
+    Read<I8> verts_are_blocked = Read<I8>()) {
   auto comm = mesh->comm();
   auto edge_cand_codes = get_edge_codes(mesh);
   auto edges_are_cands = each_neq_to(edge_cand_codes, I8(DONT_COLLAPSE));
@@ -92,6 +93,10 @@ static bool coarsen_ghosted(Mesh* mesh, AdaptOpts const& opts,
   auto vert_rails = Read<GO>();
   choose_rails(mesh, cands2edges, cand_edge_codes, cand_edge_quals,
       &verts_are_cands, &vert_quals, &vert_rails);
+  if (verts_are_blocked.exists()) {
+    verts_are_cands =
+        land_each(verts_are_cands, invert_marks(verts_are_blocked));
+  }
   auto verts_are_keys = find_indset(mesh, VERT, vert_quals, verts_are_cands);
   Graph verts2cav_elems;
   verts2cav_elems = mesh->ask_up(VERT, mesh->dim());
@@ -125,6 +130,7 @@ static void coarsen_element_based2(Mesh* mesh, AdaptOpts const& opts) {
   auto new_mesh = mesh->copy_meta();
   auto old_verts2new_verts = LOs();
   auto old_lows2new_lows = LOs();
+  Few<LOs, 4> old_ents2new_ents_by_dim;
   for (Int ent_dim = 0; ent_dim <= mesh->dim(); ++ent_dim) {
     auto keys2prods = LOs();
     auto prod_verts2verts = LOs();
@@ -145,6 +151,9 @@ static void coarsen_element_based2(Mesh* mesh, AdaptOpts const& opts) {
     modify_ents_adapt(mesh, &new_mesh, ent_dim, VERT, keys2verts, keys2prods,
         prod_verts2verts, old_lows2new_lows, &prods2new_ents,
         &same_ents2old_ents, &same_ents2new_ents, &old_ents2new_ents);
+    old_ents2new_ents_by_dim[ent_dim] = old_ents2new_ents;
+    modify_adjs(mesh, &new_mesh, ent_dim, old_ents2new_ents_by_dim,
+        prods2new_ents);
     if (ent_dim == VERT) {
       old_verts2new_verts = old_ents2new_ents;
     }
@@ -171,8 +180,7 @@ static bool coarsen(Mesh* mesh, AdaptOpts const& opts, OvershootLimit overshoot,
   return ret;
 }
 
-bool coarsen_verts(Mesh* mesh, AdaptOpts const& opts,
-    Read<I8> vert_marks, OvershootLimit overshoot, Improve improve) {
+static void put_vert_codes(Mesh* mesh, Read<I8> vert_marks) {
   auto ev2v = mesh->ask_verts_of(EDGE);
   Write<I8> edge_codes_w(mesh->nedges(), DONT_COLLAPSE);
   auto f = OMEGA_H_LAMBDA(LO e) {
@@ -186,12 +194,20 @@ bool coarsen_verts(Mesh* mesh, AdaptOpts const& opts,
   };
   parallel_for(mesh->nedges(), f, "coarsen_verts(edge_codes)");
   mesh->add_tag(EDGE, "collapse_code", 1, Read<I8>(edge_codes_w));
+}
+
+bool coarsen_verts(Mesh* mesh, AdaptOpts const& opts,
+    Read<I8> vert_marks, OvershootLimit overshoot, Improve improve) {
+  put_vert_codes(mesh, vert_marks);
   return coarsen(mesh, opts, overshoot, improve);
 }
 
+/* collapsing a vertex modifies its star, so only vertices whose
+   star is in the adapt region may collapse */
 static bool coarsen_ents(Mesh* mesh, AdaptOpts const& opts, Int ent_dim,
     Read<I8> marks, OvershootLimit overshoot, Improve improve) {
-  auto vert_marks = mark_down(mesh, ent_dim, VERT, marks);
+  auto vert_marks = restrict_to_region(
+      mesh, opts, VERT, mark_down(mesh, ent_dim, VERT, marks));
   return coarsen_verts(mesh, opts, vert_marks, overshoot, improve);
 }
 
@@ -207,6 +223,22 @@ bool coarsen_by_size(Mesh* mesh, AdaptOpts const& opts) {
   return ret;
 }
 
+bool mark_coarsen_by_size(Mesh* mesh, AdaptOpts const& opts) {
+  auto comm = mesh->comm();
+  auto lengths = mesh->ask_lengths();
+  auto edge_is_cand = each_lt(lengths, opts.min_length_desired);
+  if (get_max(comm, edge_is_cand) != 1) return false;
+  auto vert_is_cand = restrict_to_region(
+      mesh, opts, VERT, mark_down(mesh, EDGE, VERT, edge_is_cand));
+  put_vert_codes(mesh, vert_is_cand);
+  return coarsen_element_based1(mesh);
+}
+
+bool coarsen_by_size_ghosted(
+    Mesh* mesh, AdaptOpts const& opts, Read<I8> verts_are_blocked) {
+  return coarsen_ghosted(mesh, opts, DESIRED, DONT_IMPROVE, verts_are_blocked);
+}
+
 bool coarsen_slivers(Mesh* mesh, AdaptOpts const& opts) {
   OMEGA_H_TIME_FUNCTION;
   mesh->set_parting(OMEGA_H_GHOSTED);
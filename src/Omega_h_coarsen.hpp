@@ -43,6 +43,14 @@ LOs coarsen_topology(Mesh* mesh, LOs keys2verts_onto, Int dom_dim,
 
 bool coarsen_by_size(Mesh* mesh, AdaptOpts const& opts);
 
+/* the halves of coarsen_by_size before and after ghosting, for
+   refine_coarsen_by_size. the first tags the "collapse_code" of
+   the candidate edges, the second chooses the vertices to collapse
+   and tags them, leaving out any marked in (verts_are_blocked) */
+bool mark_coarsen_by_size(Mesh* mesh, AdaptOpts const& opts);
+bool coarsen_by_size_ghosted(
+    Mesh* mesh, AdaptOpts const& opts, Read<I8> verts_are_blocked);
+
 bool coarsen_slivers(Mesh* mesh, AdaptOpts const& opts);
 
 }  // end namespace Omega_h
@@ -4,13 +4,14 @@
 #include <string>
 
 #include "Omega_h_array_ops.hpp"
+#include "Omega_h_comm_stats.hpp"
 #include "Omega_h_int_scan.hpp"
+#include "Omega_h_library.hpp"
 #include "Omega_h_map.hpp"
 #include "Omega_h_profile.hpp"
 
 #if defined(OMEGA_H_USE_CUDA) && !defined(OMEGA_H_USE_CUDA_AWARE_MPI)
 #include "Omega_h_for.hpp"
-#include "Omega_h_library.hpp"
 #endif
 
 namespace Omega_h {
@@ -198,17 +199,91 @@ Read<I32> Comm::sources() const { return srcs_; }
 
 Read<I32> Comm::destinations() const { return dsts_; }
 
+std::vector<I32> const& Comm::world_destinations(CommPtr world) const {
+  auto ndsts = std::size_t(host_dsts_.size());
+  if (world_dsts_.size() == ndsts) return world_dsts_;
+  world_dsts_.resize(ndsts);
+#ifdef OMEGA_H_USE_MPI
+  MPI_Group group;
+  MPI_Group world_group;
+  CALL(MPI_Comm_group(impl_, &group));
+  CALL(MPI_Comm_group(world->impl_, &world_group));
+  CALL(MPI_Group_translate_ranks(group, host_dsts_.size(), host_dsts_.data(),
+      world_group, world_dsts_.data()));
+  CALL(MPI_Group_free(&group));
+  CALL(MPI_Group_free(&world_group));
+#else
+  (void)world;
+  for (std::size_t i = 0; i < ndsts; ++i) world_dsts_[i] = host_dsts_[LO(i)];
+#endif
+  return world_dsts_;
+}
+
 template <typename T>
 T Comm::allreduce(T x, Omega_h_Op op) const {
 #ifdef OMEGA_H_USE_MPI
+  auto const t0 = comm_stats::start();
   CALL(MPI_Allreduce(
       MPI_IN_PLACE, &x, 1, MpiTraits<T>::datatype(), mpi_op(op), impl_));
+  comm_stats::record_collective(
+      "Comm::allreduce", sizeof(T), comm_stats::since(t0));
 #else
   (void)op;
 #endif
   return x;
 }
 
+template <typename T>
+Read<T> Comm::allreduce(Read<T> x, Omega_h_Op op) const {
+#ifdef OMEGA_H_USE_MPI
+  HostRead<T> sendbuf(x);
+  HostWrite<T> recvbuf(x.size());
+  auto const t0 = comm_stats::start();
+  CALL(MPI_Allreduce(nonnull(sendbuf.data()), nonnull(recvbuf.data()),
+      x.size(), MpiTraits<T>::datatype(), mpi_op(op), impl_));
+  comm_stats::record_collective(
+      "Comm::allreduce", std::size_t(x.size()) * sizeof(T),
+      comm_stats::since(t0));
+  return recvbuf.write();
+#else
+  (void)op;
+  return x;
+#endif
+}
+
+/* a nonblocking allreduce whose result is read through
+   Future::get(), leaving the caller free to do other work
+   (including other communication) while it completes */
+template <typename T>
+Future<T> Comm::iallreduce(T x, Omega_h_Op op) const {
+#ifdef OMEGA_H_USE_MPI
+  /* the wait happens in Future::get() */
+  comm_stats::record_collective("Comm::iallreduce", sizeof(T), 0.0);
+  typename Future<T>::requests_type reqs(1);
+#if defined(OMEGA_H_USE_CUDA) && !defined(OMEGA_H_USE_CUDA_AWARE_MPI)
+  HostWrite<T> sendbuf_w(1);
+  sendbuf_w[0] = x;
+  HostRead<T> sendbuf(sendbuf_w.write());
+  HostWrite<T> recvbuf(1);
+  CALL(MPI_Iallreduce(sendbuf.data(), recvbuf.data(), 1,
+      MpiTraits<T>::datatype(), mpi_op(op), impl_, reqs.data()));
+  auto callback = [](HostWrite<T> buf) -> Read<T> {
+    return Read<T>(buf.write());
+  };
+  return {sendbuf, recvbuf, std::move(reqs), callback};
+#else
+  Read<T> sendbuf({x});
+  Write<T> recvbuf(1);
+  CALL(MPI_Iallreduce(sendbuf.data(), recvbuf.data(), 1,
+      MpiTraits<T>::datatype(), mpi_op(op), impl_, reqs.data()));
+  return {sendbuf, recvbuf, std::move(reqs)};
+#endif
+#else
+  (void)op;
+  return Future<T>(Read<T>({x}));
+#endif
+}
+
 bool Comm::reduce_or(bool x) const {
   I8 y = x;
   y = allreduce(y, OMEGA_H_MAX);
@@ -490,6 +565,9 @@ Future<T> Comm::ialltoallv(Read<T> sendbuf_dev, Read<LO> sdispls_dev,
   HostRead<LO> rdispls(rdispls_dev);
   OMEGA_H_CHECK(sendbuf_dev.size() == sdispls.last() * width);
   int nrecvd = rdispls.last() * width;
+  /* the wait happens in Future::get() */
+  comm_stats::record_exchange(this, "Comm::ialltoallv", sdispls,
+      rdispls.last(), sizeof(T) * std::size_t(width), 0.0);
 #if defined(OMEGA_H_USE_CUDA) && !defined(OMEGA_H_USE_CUDA_AWARE_MPI)
   HostWrite<T> recvbuf(nrecvd);
   HostRead<T> sendbuf(sendbuf_dev);
@@ -535,6 +613,7 @@ Read<T> Comm::alltoallv(Read<T> sendbuf_dev, Read<LO> sdispls_dev,
   HostRead<LO> rdispls(rdispls_dev);
   OMEGA_H_CHECK(sendbuf_dev.size() == sdispls.last() * width);
   int nrecvd = rdispls.last() * width;
+  auto const t0 = comm_stats::start();
 #if defined(OMEGA_H_USE_CUDA) && !defined(OMEGA_H_USE_CUDA_AWARE_MPI)
   HostWrite<T> recvbuf(nrecvd);
   HostRead<T> sendbuf(sendbuf_dev);
@@ -557,6 +636,8 @@ Read<T> Comm::alltoallv(Read<T> sendbuf_dev, Read<LO> sdispls_dev,
   CALL(MPI_Waitall(static_cast<int>(reqs.size()), reqs.data(), MPI_STATUSES_IGNORE));
   Read<T> recvbuf_dev = recvbuf_dev_w;
 #endif  // !defined(OMEGA_H_USE_CUDA) || defined(OMEGA_H_USE_CUDA_AWARE_MPI)
+  comm_stats::record_exchange(this, "Comm::alltoallv", sdispls,
+      rdispls.last(), sizeof(T) * std::size_t(width), comm_stats::since(t0));
 #else   // !defined(OMEGA_H_USE_MPI)
   (void)sdispls_dev;
   (void)rdispls_dev;
@@ -566,6 +647,162 @@ Read<T> Comm::alltoallv(Read<T> sendbuf_dev, Read<LO> sdispls_dev,
   return recvbuf_dev;
 }
 
+template <typename T>
+AlltoallvPlan<T>::AlltoallvPlan(
+    CommPtr comm, Read<LO> sdispls_dev, Read<LO> rdispls_dev, Int width)
+    : comm_(comm) {
+  HostRead<LO> sdispls(sdispls_dev);
+  HostRead<LO> rdispls(rdispls_dev);
+  sendbuf_ = Write<T>(sdispls.last() * width, "AlltoallvPlan::sendbuf");
+#ifdef OMEGA_H_USE_MPI
+  recvbuf_ = Write<T>(rdispls.last() * width, "AlltoallvPlan::recvbuf");
+  sdispls_ = sdispls;
+  nrecvd_ = rdispls.last();
+  width_ = width;
+  auto const& srcs = comm_->host_srcs_;
+  auto const& dsts = comm_->host_dsts_;
+  int const indegree = srcs.size();
+  int const outdegree = dsts.size();
+  /* the rank of each neighbor within this node, if it is on this node */
+  std::vector<int> dst_node_ranks(std::size_t(outdegree), MPI_UNDEFINED);
+  std::vector<int> src_node_ranks(std::size_t(indegree), MPI_UNDEFINED);
+  node_impl_ = MPI_COMM_NULL;
+  win_ = MPI_WIN_NULL;
+  window_ = nullptr;
+  parity_ = 0;
+#ifndef OMEGA_H_USE_CUDA
+  auto library = comm_->library();
+  if (library && library->shared_memory_exchange_) {
+    CALL(MPI_Comm_split_type(comm_->impl_, MPI_COMM_TYPE_SHARED, 0,
+        MPI_INFO_NULL, &node_impl_));
+    MPI_Group group;
+    MPI_Group node_group;
+    CALL(MPI_Comm_group(comm_->impl_, &group));
+    CALL(MPI_Comm_group(node_impl_, &node_group));
+    CALL(MPI_Group_translate_ranks(group, outdegree, nonnull(dsts.data()),
+        node_group, dst_node_ranks.data()));
+    CALL(MPI_Group_translate_ranks(group, indegree, nonnull(srcs.data()),
+        node_group, src_node_ranks.data()));
+    CALL(MPI_Group_free(&group));
+    CALL(MPI_Group_free(&node_group));
+    /* the window holds two copies of the send buffer layout,
+       used by alternate exchanges so that a reader of one
+       exchange is always done before the next write there */
+    LO const half = sdispls.last() * width;
+    CALL(MPI_Win_allocate_shared(MPI_Aint(2 * half) * MPI_Aint(sizeof(T)),
+        int(sizeof(T)), MPI_INFO_NULL, node_impl_, &window_, &win_));
+    CALL(MPI_Win_lock_all(MPI_MODE_NOCHECK, win_));
+    for (int i = 0; i < outdegree; ++i) {
+      if (dst_node_ranks[std::size_t(i)] == MPI_UNDEFINED) continue;
+      auto const offset = sdispls[i] * width;
+      auto const count = (sdispls[i + 1] - sdispls[i]) * width;
+      node_sends_.push_back({window_ + offset, half, offset, count});
+    }
+    /* where in its window each source keeps what it sends here */
+    HostWrite<LO> send_offsets(outdegree);
+    for (int i = 0; i < outdegree; ++i) send_offsets[i] = sdispls[i] * width;
+    HostRead<LO> recv_offsets(comm_->alltoall(Read<LO>(send_offsets.write())));
+    for (int i = 0; i < indegree; ++i) {
+      auto const node_rank = src_node_ranks[std::size_t(i)];
+      if (node_rank == MPI_UNDEFINED) continue;
+      MPI_Aint size;
+      int disp_unit;
+      T* base;
+      CALL(MPI_Win_shared_query(win_, node_rank, &size, &disp_unit, &base));
+      auto const peer_half = LO(size / MPI_Aint(sizeof(T)) / 2);
+      auto const offset = rdispls[i] * width;
+      auto const count = (rdispls[i + 1] - rdispls[i]) * width;
+      node_recvs_.push_back(
+          {base + recv_offsets[i], peer_half, offset, count});
+    }
+  }
+#endif
+  /* the rest goes through MPI, sends first, then receives */
+  std::vector<int> off_srcs;
+  std::vector<int> off_dsts;
+  for (int i = 0; i < outdegree; ++i) {
+    if (dst_node_ranks[std::size_t(i)] != MPI_UNDEFINED) continue;
+    off_dsts.push_back(dsts[i]);
+    counts_.push_back((sdispls[i + 1] - sdispls[i]) * width);
+    displs_.push_back(sdispls[i] * width);
+  }
+  for (int i = 0; i < indegree; ++i) {
+    if (src_node_ranks[std::size_t(i)] != MPI_UNDEFINED) continue;
+    off_srcs.push_back(srcs[i]);
+    counts_.push_back((rdispls[i + 1] - rdispls[i]) * width);
+    displs_.push_back(rdispls[i] * width);
+  }
+  int const off_outdegree = int(off_dsts.size());
+  int const off_indegree = int(off_srcs.size());
+  auto const datatype = MpiTraits<T>::datatype();
+  int const tag = 43;
+  reqs_.resize(std::size_t(off_outdegree + off_indegree));
+  for (int i = 0; i < off_outdegree; ++i) {
+    auto const j = std::size_t(i);
+    CALL(MPI_Send_init(nonnull(sendbuf_.data()) + displs_[j], counts_[j],
+        datatype, off_dsts[j], tag, comm_->impl_, &reqs_[j]));
+  }
+  for (int i = 0; i < off_indegree; ++i) {
+    auto const j = std::size_t(off_outdegree + i);
+    CALL(MPI_Recv_init(nonnull(recvbuf_.data()) + displs_[j], counts_[j],
+        datatype, off_srcs[std::size_t(i)], tag, comm_->impl_, &reqs_[j]));
+  }
+#else
+  OMEGA_H_CHECK(sdispls.last() == rdispls.last());
+  recvbuf_ = sendbuf_;
+#endif
+}
+
+template <typename T>
+AlltoallvPlan<T>::~AlltoallvPlan() {
+#ifdef OMEGA_H_USE_MPI
+  for (auto& req : reqs_) CALL(MPI_Request_free(&req));
+  if (win_ != MPI_WIN_NULL) {
+    CALL(MPI_Win_unlock_all(win_));
+    CALL(MPI_Win_free(&win_));
+  }
+  if (node_impl_ != MPI_COMM_NULL) CALL(MPI_Comm_free(&node_impl_));
+#endif
+}
+
+template <typename T>
+Write<T> AlltoallvPlan<T>::sendbuf() const {
+  return sendbuf_;
+}
+
+template <typename T>
+Read<T> AlltoallvPlan<T>::exch() {
+  ScopedTimer timer("AlltoallvPlan::exch");
+#ifdef OMEGA_H_USE_MPI
+  auto const t0 = comm_stats::start();
+  /* some MPIs reject an empty request array */
+  if (!reqs_.empty()) {
+    CALL(MPI_Startall(static_cast<int>(reqs_.size()), reqs_.data()));
+  }
+  if (win_ != MPI_WIN_NULL) {
+    for (auto const& msg : node_sends_) {
+      std::copy_n(sendbuf_.data() + msg.offset, msg.count,
+          msg.window + parity_ * msg.half);
+    }
+    CALL(MPI_Win_sync(win_));
+    CALL(MPI_Barrier(node_impl_));
+    CALL(MPI_Win_sync(win_));
+    for (auto const& msg : node_recvs_) {
+      std::copy_n(msg.window + parity_ * msg.half, msg.count,
+          recvbuf_.data() + msg.offset);
+    }
+    parity_ = 1 - parity_;
+  }
+  if (!reqs_.empty()) {
+    CALL(MPI_Waitall(
+        static_cast<int>(reqs_.size()), reqs_.data(), MPI_STATUSES_IGNORE));
+  }
+  comm_stats::record_exchange(comm_.get(), "AlltoallvPlan::exch", sdispls_,
+      nrecvd_, sizeof(T) * std::size_t(width_), comm_stats::since(t0));
+#endif
+  return recvbuf_;
+}
+
 void Comm::barrier() const {
 #ifdef OMEGA_H_USE_MPI
   CALL(MPI_Barrier(impl_));
@@ -576,6 +813,8 @@ void Comm::barrier() const {
 
 #define INST(T)                                                                \
   template T Comm::allreduce(T x, Omega_h_Op op) const;                        \
+  template Read<T> Comm::allreduce(Read<T> x, Omega_h_Op op) const;            \
+  template Future<T> Comm::iallreduce(T x, Omega_h_Op op) const;               \
   template T Comm::exscan(T x, Omega_h_Op op) const;                           \
   template void Comm::bcast(T& x, int root_rank) const;                        \
   template Read<T> Comm::allgather(T x) const;                                 \
@@ -583,7 +822,8 @@ void Comm::barrier() const {
   template Read<T> Comm::alltoallv(                                            \
       Read<T> sendbuf, Read<LO> sdispls, Read<LO> rdispls, Int width) const;   \
   template Future<T> Comm::ialltoallv(                                       \
-      Read<T> sendbuf, Read<LO> sdispls, Read<LO> rdispls, Int width) const;
+      Read<T> sendbuf, Read<LO> sdispls, Read<LO> rdispls, Int width) const;   \
+  template class AlltoallvPlan<T>;
 
 INST(I8)
 INST(I32)
@@ -2,6 +2,7 @@
 #define OMEGA_H_COMM_HPP
 
 #include <memory>
+#include <vector>
 
 #include <Omega_h_mpi.h>
 #include <Omega_h_array.hpp>
@@ -22,6 +23,8 @@ static_assert(sizeof(int) == 4, "Omega_h::Comm assumes 32-bit int");
 
 class Library;
 class Comm;
+template <typename T>
+class AlltoallvPlan;
 
 typedef std::shared_ptr<Comm> CommPtr;
 
@@ -36,6 +39,10 @@ class Comm {
   HostRead<I32> host_dsts_;
   LO self_src_;
   LO self_dst_;
+  /* filled in by world_destinations() */
+  mutable std::vector<I32> world_dsts_;
+  template <typename T>
+  friend class AlltoallvPlan;
 
  public:
   Comm();
@@ -61,8 +68,16 @@ class Comm {
   CommPtr graph_inverse() const;
   Read<I32> sources() const;
   Read<I32> destinations() const;
+  /* the ranks in (world) of destinations(), translated on the first
+     call and kept for the life of this Comm */
+  std::vector<I32> const& world_destinations(CommPtr world) const;
   template <typename T>
   T allreduce(T x, Omega_h_Op op) const;
+  /* reduces each entry of (x) over all ranks */
+  template <typename T>
+  Read<T> allreduce(Read<T> x, Omega_h_Op op) const;
+  template <typename T>
+  Future<T> iallreduce(T x, Omega_h_Op op) const;
   bool reduce_or(bool x) const;
   bool reduce_and(bool x) const;
   Int128 add_int128(Int128 x) const;
@@ -88,6 +103,57 @@ class Comm {
   void recv(int rank, T& x);
 };
 
+/* a persistent form of Comm::alltoallv() for a fixed set of message
+   sizes. the buffers and MPI requests are set up once, after which
+   each exchange only starts and completes persistent point-to-point
+   requests.
+   with Library::shared_memory_exchange_, messages between ranks on
+   the same node are instead copied through an MPI shared memory
+   window, and only messages leaving the node go through MPI.
+   these plans are the only node-aware path: Dist::exch() uses them
+   only for Dists that called keep_plans(), and one-off alltoallv()
+   and ialltoallv() calls always go through MPI. */
+template <typename T>
+class AlltoallvPlan {
+  CommPtr comm_;
+  Write<T> sendbuf_;
+  Write<T> recvbuf_;
+#ifdef OMEGA_H_USE_MPI
+  /* a message to or from a rank on this node */
+  struct NodeMessage {
+    /* where the message is in the first half of the sender's window */
+    T* window;
+    /* the size of one half of the sender's window */
+    LO half;
+    /* where the message is in sendbuf_ or recvbuf_ */
+    LO offset;
+    LO count;
+  };
+  MPI_Comm node_impl_;
+  MPI_Win win_;
+  T* window_;
+  int parity_;
+  std::vector<NodeMessage> node_sends_;
+  std::vector<NodeMessage> node_recvs_;
+  HostRead<LO> sdispls_;
+  LO nrecvd_;
+  Int width_;
+  std::vector<int> counts_;
+  std::vector<int> displs_;
+  std::vector<MPI_Request> reqs_;
+#endif
+
+ public:
+  AlltoallvPlan(CommPtr comm, Read<LO> sdispls, Read<LO> rdispls, Int width);
+  AlltoallvPlan(AlltoallvPlan const&) = delete;
+  AlltoallvPlan& operator=(AlltoallvPlan const&) = delete;
+  ~AlltoallvPlan();
+  /* the content to send is packed into this array before exch() */
+  Write<T> sendbuf() const;
+  /* the returned content is overwritten by the next exch() */
+  Read<T> exch();
+};
+
 #ifdef OMEGA_H_USE_MPI
 
 #ifdef OMPI_MPI_H
@@ -215,6 +281,8 @@ void Comm::recv(int rank, T& x) {
 
 #define OMEGA_H_EXPL_INST_DECL(T)                                              \
   extern template T Comm::allreduce(T x, Omega_h_Op op) const;                 \
+  extern template Read<T> Comm::allreduce(Read<T> x, Omega_h_Op op) const;     \
+  extern template Future<T> Comm::iallreduce(T x, Omega_h_Op op) const;        \
   extern template T Comm::exscan(T x, Omega_h_Op op) const;                    \
   extern template void Comm::bcast(T& x, int root_rank) const;                 \
   extern template Read<T> Comm::allgather(T x) const;                          \
@@ -222,7 +290,8 @@ void Comm::recv(int rank, T& x) {
   extern template Read<T> Comm::alltoallv(                                     \
       Read<T> sendbuf, Read<LO> sdispls, Read<LO> rdispls, Int width) const;   \
   extern template Future<T> Comm::ialltoallv(                                  \
-      Read<T> sendbuf, Read<LO> sdispls, Read<LO> rdispls, Int width) const;
+      Read<T> sendbuf, Read<LO> sdispls, Read<LO> rdispls, Int width) const;   \
+  extern template class AlltoallvPlan<T>;
 OMEGA_H_EXPL_INST_DECL(I8)
 OMEGA_H_EXPL_INST_DECL(I32)
 OMEGA_H_EXPL_INST_DECL(I64)
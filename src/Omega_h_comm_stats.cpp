@@ -0,0 +1,194 @@
+#include "Omega_h_comm_stats.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Omega_h_profile.hpp"
+#include "Omega_h_scalar.hpp"
+
+namespace Omega_h {
+
+namespace comm_stats {
+
+OMEGA_H_DLL Stats* global_singleton_stats = nullptr;
+
+Stats::Stats(CommPtr world_in) : world(world_in) {}
+
+/* frames of the communication layer itself, which say nothing
+   about who asked for the communication. unqualified names are
+   those of OMEGA_H_TIME_FUNCTION in Omega_h_comm.cpp and
+   Omega_h_dist.cpp */
+static bool is_comm_frame(char const* name) {
+  static char const* const names[] = {"Comm::alltoallv", "Comm::ialltoallv",
+      "AlltoallvPlan::exch", "Dist::exch", "Dist::iexch",
+      "Dist::set_dest_globals", "sources_from_destinations", "first barrier",
+      "Neighbor_allgather", "Neighbor_alltoall", "Neighbor_ialltoallv",
+      "set_dest_ranks", "set_dest_idxs", "exch", "exch_subset"};
+  for (auto comm_name : names) {
+    if (!std::strcmp(name, comm_name)) return true;
+  }
+  return false;
+}
+
+static std::string get_site(char const* op) {
+  auto history = profile::global_singleton_history;
+  if (!history) return op;
+  for (auto frame = history->current_frame; frame != profile::invalid;
+       frame = history->parent(frame)) {
+    auto name = history->get_name(frame);
+    if (!is_comm_frame(name)) return std::string(name) + ": " + op;
+  }
+  return op;
+}
+
+Now start() { return global_singleton_stats ? now() : Now(); }
+
+double since(Now t0) { return global_singleton_stats ? (now() - t0) : 0.0; }
+
+void record_exchange(Comm const* comm, char const* op, HostRead<LO> sdispls,
+    LO nrecvd, std::size_t item_bytes, double wait_time) {
+  auto stats = global_singleton_stats;
+  if (!stats) return;
+  auto& site = stats->sites[get_site(op)];
+  ++site.calls;
+  auto const& world_ranks = comm->world_destinations(stats->world);
+  auto ndests = LO(world_ranks.size());
+  site.neighbors += std::size_t(ndests);
+  for (LO i = 0; i < ndests; ++i) {
+    auto bytes = double(sdispls[i + 1] - sdispls[i]) * double(item_bytes);
+    if (bytes == 0.0) continue;
+    ++site.messages;
+    site.bytes_sent += bytes;
+    stats->traffic[world_ranks[std::size_t(i)]] += bytes;
+  }
+  site.bytes_received += double(nrecvd) * double(item_bytes);
+  site.wait_time += wait_time;
+}
+
+void record_collective(char const* op, std::size_t bytes, double wait_time) {
+  auto stats = global_singleton_stats;
+  if (!stats) return;
+  auto& site = stats->sites[get_site(op)];
+  ++site.calls;
+  site.bytes_sent += double(bytes);
+  site.bytes_received += double(bytes);
+  site.wait_time += wait_time;
+}
+
+enum {
+  CALLS,
+  MESSAGES,
+  NEIGHBORS,
+  BYTES_SENT,
+  BYTES_RECEIVED,
+  WAIT_TIME,
+  NVALUES
+};
+
+static char const* const value_names[NVALUES] = {"calls", "messages",
+    "neighbors", "bytes sent", "bytes received", "wait time [s]"};
+
+static void append(std::vector<char>* chars, std::string const& s) {
+  chars->insert(chars->end(), s.c_str(), s.c_str() + s.length() + 1);
+}
+
+static std::vector<std::string> split(std::vector<char> const& chars) {
+  std::vector<std::string> strings;
+  for (std::size_t i = 0; i < chars.size(); i += strings.back().length() + 1) {
+    strings.push_back(std::string(&chars[i]));
+  }
+  return strings;
+}
+
+void print(Stats const& stats) {
+  auto comm = stats.world;
+  auto nranks = std::size_t(comm->size());
+  std::vector<char> names;
+  std::vector<double> values;
+  for (auto& name_site : stats.sites) {
+    auto& site = name_site.second;
+    append(&names, name_site.first);
+    values.push_back(double(site.calls));
+    values.push_back(double(site.messages));
+    values.push_back(double(site.neighbors));
+    values.push_back(site.bytes_sent);
+    values.push_back(site.bytes_received);
+    values.push_back(site.wait_time);
+  }
+  if (comm->rank() != 0) {
+    comm->send(0, names);
+    comm->send(0, values);
+    return;
+  }
+  /* the values of each rank at each site, zero where a rank
+     never communicated from that site */
+  std::map<std::string, std::vector<double>> all;
+  for (std::size_t rank = 0; rank < nranks; ++rank) {
+    if (rank != 0) {
+      comm->recv(I32(rank), names);
+      comm->recv(I32(rank), values);
+    }
+    auto rank_names = split(names);
+    OMEGA_H_CHECK(rank_names.size() * NVALUES == values.size());
+    for (std::size_t i = 0; i < rank_names.size(); ++i) {
+      auto& site_values = all[rank_names[i]];
+      site_values.resize(nranks * NVALUES, 0.0);
+      for (std::size_t j = 0; j < NVALUES; ++j) {
+        site_values[rank * NVALUES + j] = values[i * NVALUES + j];
+      }
+    }
+  }
+  auto flags = std::cout.flags();
+  std::cout << "\nCOMMUNICATION (over " << nranks << " ranks):\n";
+  std::cout << "==============\n";
+  for (auto& name_values : all) {
+    std::cout << name_values.first << '\n';
+    std::cout << std::setw(18) << "" << std::setw(14) << "Min"
+              << std::setw(14) << "Ave" << std::setw(14) << "Max" << '\n';
+    for (std::size_t j = 0; j < NVALUES; ++j) {
+      double lo = ArithTraits<double>::max();
+      double hi = ArithTraits<double>::min();
+      double sum = 0.0;
+      for (std::size_t rank = 0; rank < nranks; ++rank) {
+        auto value = name_values.second[rank * NVALUES + j];
+        lo = std::min(lo, value);
+        hi = std::max(hi, value);
+        sum += value;
+      }
+      std::cout << "  " << std::left << std::setw(16) << value_names[j]
+                << std::right << std::setw(14) << lo << std::setw(14)
+                << sum / double(nranks) << std::setw(14) << hi << '\n';
+    }
+  }
+  std::cout.flags(flags);
+}
+
+void write_traffic(Stats const& stats, std::string const& path) {
+  auto comm = stats.world;
+  std::vector<double> pairs;
+  for (auto& rank_bytes : stats.traffic) {
+    pairs.push_back(double(rank_bytes.first));
+    pairs.push_back(rank_bytes.second);
+  }
+  if (comm->rank() != 0) {
+    comm->send(0, pairs);
+    return;
+  }
+  std::ofstream file(path.c_str());
+  OMEGA_H_CHECK(file.is_open());
+  file << "source,destination,bytes\n";
+  for (I32 rank = 0; rank < comm->size(); ++rank) {
+    if (rank != 0) comm->recv(rank, pairs);
+    for (std::size_t i = 0; i < pairs.size(); i += 2) {
+      file << rank << ',' << I32(pairs[i]) << ',' << GO(pairs[i + 1]) << '\n';
+    }
+  }
+}
+
+}  // end namespace comm_stats
+
+}  // end namespace Omega_h
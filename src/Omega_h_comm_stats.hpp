@@ -0,0 +1,68 @@
+#ifndef OMEGA_H_COMM_STATS_HPP
+#define OMEGA_H_COMM_STATS_HPP
+
+#include <map>
+#include <string>
+
+#include <Omega_h_comm.hpp>
+#include <Omega_h_timer.hpp>
+
+namespace Omega_h {
+
+namespace comm_stats {
+
+/* what the communication from one call site added up to on
+   this rank */
+struct Site {
+  std::size_t calls = 0;
+  /* nonempty point-to-point messages sent */
+  std::size_t messages = 0;
+  /* ranks in the send pattern, summed over the calls */
+  std::size_t neighbors = 0;
+  double bytes_sent = 0.0;
+  double bytes_received = 0.0;
+  /* time spent waiting for the communication to complete */
+  double wait_time = 0.0;
+};
+
+struct Stats {
+  CommPtr world;
+  /* keyed by the operation and, when the profiler is on,
+     the innermost profiled function outside Comm and Dist */
+  std::map<std::string, Site> sites;
+  /* bytes sent from this rank to each rank of (world) */
+  std::map<I32, double> traffic;
+  Stats(CommPtr world_in);
+};
+
+OMEGA_H_DLL extern Stats* global_singleton_stats;
+
+/* the start of a timed communication. the clock is only read
+   while statistics are being gathered */
+Now start();
+
+/* the seconds since (t0), or zero when no statistics are gathered */
+double since(Now t0);
+
+/* records one exchange (op) by (comm): (sdispls[i + 1] - sdispls[i])
+   items went to the (i)th destination of (comm), (nrecvd) items
+   arrived, and every item is (item_bytes) bytes */
+void record_exchange(Comm const* comm, char const* op, HostRead<LO> sdispls,
+    LO nrecvd, std::size_t item_bytes, double wait_time);
+
+/* records one collective (op) contributing (bytes) bytes */
+void record_collective(char const* op, std::size_t bytes, double wait_time);
+
+/* prints the minimum, average and maximum over the ranks of
+   every statistic of every call site, from rank zero */
+void print(Stats const& stats);
+
+/* writes the bytes sent between each pair of ranks to a CSV file
+   at (path) with one "source,destination,bytes" line per pair */
+void write_traffic(Stats const& stats, std::string const& path);
+
+}  // end namespace comm_stats
+
+}  // end namespace Omega_h
+
+#endif
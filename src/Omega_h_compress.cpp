@@ -0,0 +1,148 @@
+#include "Omega_h_compress.hpp"
+
+#include "Omega_h_fail.hpp"
+#include "Omega_h_profile.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef OMEGA_H_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace Omega_h {
+
+#ifdef OMEGA_H_USE_ZLIB
+
+static bool codec_shuffles(Codec codec, std::size_t item_size) {
+  return codec == CODEC_SHUFFLE_ZLIB && item_size > 1;
+}
+
+/* byte j of item i goes to position (j * nitems + i) */
+static void shuffle_bytes(unsigned char const* in, unsigned char* out,
+    std::size_t nbytes, std::size_t item_size) {
+  auto const nitems = nbytes / item_size;
+  for (std::size_t i = 0; i < nitems; ++i) {
+    for (std::size_t j = 0; j < item_size; ++j) {
+      out[j * nitems + i] = in[i * item_size + j];
+    }
+  }
+}
+
+static void unshuffle_bytes(unsigned char const* in, unsigned char* out,
+    std::size_t nbytes, std::size_t item_size) {
+  auto const nitems = nbytes / item_size;
+  for (std::size_t i = 0; i < nitems; ++i) {
+    for (std::size_t j = 0; j < item_size; ++j) {
+      out[i * item_size + j] = in[j * nitems + i];
+    }
+  }
+}
+
+static std::vector<unsigned char> deflate_block(
+    unsigned char const* in, std::size_t nbytes, Codec codec) {
+  ::z_stream strm;
+  std::memset(&strm, 0, sizeof(strm));
+  auto const strategy =
+      (codec == CODEC_ZLIB_HUFFMAN) ? Z_HUFFMAN_ONLY : Z_DEFAULT_STRATEGY;
+  auto ret = ::deflateInit2(
+      &strm, Z_BEST_SPEED, Z_DEFLATED, MAX_WBITS, 8, strategy);
+  OMEGA_H_CHECK(ret == Z_OK);
+  std::vector<unsigned char> out(::deflateBound(&strm, uLong(nbytes)));
+  strm.next_in = const_cast<::Bytef*>(in);
+  strm.avail_in = uInt(nbytes);
+  strm.next_out = out.data();
+  strm.avail_out = uInt(out.size());
+  ret = ::deflate(&strm, Z_FINISH);
+  OMEGA_H_CHECK(ret == Z_STREAM_END);
+  out.resize(strm.total_out);
+  ::deflateEnd(&strm);
+  return out;
+}
+
+static std::uint64_t count_blocks(
+    std::uint64_t nbytes, std::uint64_t block_bytes) {
+  if (nbytes == 0) return 1;
+  return (nbytes + block_bytes - 1) / block_bytes;
+}
+
+CompressedBlocks compress_blocks(void const* data, std::uint64_t nbytes,
+    std::size_t item_size, Codec codec, std::uint64_t block_bytes) {
+  OMEGA_H_TIME_FUNCTION;
+  OMEGA_H_CHECK(block_bytes % item_size == 0);
+  OMEGA_H_CHECK(nbytes % item_size == 0);
+  CompressedBlocks blocks;
+  blocks.block_bytes = std::min(block_bytes, nbytes);
+  auto const nblocks = count_blocks(nbytes, blocks.block_bytes);
+  std::vector<std::vector<unsigned char>> compressed(nblocks);
+  auto const in = static_cast<unsigned char const*>(data);
+  auto const shuffles = codec_shuffles(codec, item_size);
+#ifdef OMEGA_H_USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (std::int64_t b = 0; b < std::int64_t(nblocks); ++b) {
+    auto const begin = std::uint64_t(b) * blocks.block_bytes;
+    auto const size = std::min(blocks.block_bytes, nbytes - begin);
+    if (shuffles) {
+      std::vector<unsigned char> shuffled(size);
+      shuffle_bytes(in + begin, shuffled.data(), size, item_size);
+      compressed[std::size_t(b)] = deflate_block(shuffled.data(), size, codec);
+    } else {
+      compressed[std::size_t(b)] = deflate_block(in + begin, size, codec);
+    }
+  }
+  blocks.sizes.resize(nblocks);
+  std::vector<std::uint64_t> offsets(nblocks + 1, 0);
+  for (std::uint64_t b = 0; b < nblocks; ++b) {
+    blocks.sizes[b] = compressed[b].size();
+    offsets[b + 1] = offsets[b] + blocks.sizes[b];
+  }
+  blocks.data.resize(offsets[nblocks]);
+#ifdef OMEGA_H_USE_OPENMP
+#pragma omp parallel for
+#endif
+  for (std::int64_t b = 0; b < std::int64_t(nblocks); ++b) {
+    auto const& block = compressed[std::size_t(b)];
+    std::copy(block.begin(), block.end(), blocks.data.begin() + offsets[b]);
+  }
+  return blocks;
+}
+
+void decompress_blocks(CompressedBlocks const& blocks, std::size_t item_size,
+    Codec codec, void* data, std::uint64_t nbytes) {
+  OMEGA_H_TIME_FUNCTION;
+  OMEGA_H_CHECK(nbytes == 0 || blocks.block_bytes > 0);
+  OMEGA_H_CHECK(nbytes == 0 || blocks.block_bytes % item_size == 0);
+  auto const nblocks = std::uint64_t(blocks.sizes.size());
+  OMEGA_H_CHECK(nblocks == count_blocks(nbytes, blocks.block_bytes));
+  std::vector<std::uint64_t> offsets(nblocks + 1, 0);
+  for (std::uint64_t b = 0; b < nblocks; ++b) {
+    offsets[b + 1] = offsets[b] + blocks.sizes[b];
+  }
+  OMEGA_H_CHECK(offsets[nblocks] <= blocks.data.size());
+  auto const out = static_cast<unsigned char*>(data);
+  auto const shuffles = codec_shuffles(codec, item_size);
+  bool ok = true;
+#ifdef OMEGA_H_USE_OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(&& : ok)
+#endif
+  for (std::int64_t b = 0; b < std::int64_t(nblocks); ++b) {
+    auto const begin = std::uint64_t(b) * blocks.block_bytes;
+    auto const size = std::min(blocks.block_bytes, nbytes - begin);
+    std::vector<unsigned char> shuffled(shuffles ? size : 0);
+    auto const dest = shuffles ? shuffled.data() : out + begin;
+    uLong dest_bytes = uLong(size);
+    auto const ret = ::uncompress(dest, &dest_bytes,
+        blocks.data.data() + offsets[std::size_t(b)],
+        uLong(blocks.sizes[std::size_t(b)]));
+    ok = ok && (ret == Z_OK) && (dest_bytes == uLong(size));
+    if (shuffles) {
+      unshuffle_bytes(shuffled.data(), out + begin, size, item_size);
+    }
+  }
+  if (!ok) Omega_h_fail("failed to decompress a block of compressed data\n");
+}
+
+#endif
+
+}  // end namespace Omega_h
@@ -0,0 +1,50 @@
+#ifndef OMEGA_H_COMPRESS_HPP
+#define OMEGA_H_COMPRESS_HPP
+
+#include <Omega_h_config.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Omega_h {
+
+/* how compressed arrays are encoded in .osh and .vtu files.
+   all of them split arrays into independent blocks, which are
+   compressed and decompressed in parallel when OpenMP is enabled */
+enum Codec {
+  /* zlib at its fastest level */
+  CODEC_ZLIB,
+  /* zlib after grouping the bytes of multi-byte items by significance,
+     which usually compresses Reals much better.
+     VTK readers can't undo the shuffle, so VTK files use CODEC_ZLIB */
+  CODEC_SHUFFLE_ZLIB,
+  /* zlib using only Huffman coding, which is several times faster
+     but compresses less. the result is still a standard zlib stream */
+  CODEC_ZLIB_HUFFMAN
+};
+
+/* uncompressed size of all but the last block */
+constexpr std::uint64_t compression_block_bytes = std::uint64_t(1) << 18;
+
+struct CompressedBlocks {
+  /* uncompressed bytes in each block but the last */
+  std::uint64_t block_bytes;
+  /* compressed bytes of each block */
+  std::vector<std::uint64_t> sizes;
+  /* all compressed blocks, one after the other */
+  std::vector<unsigned char> data;
+};
+
+#ifdef OMEGA_H_USE_ZLIB
+/* (item_size) is the size of the array's items in bytes,
+   which the shuffle codec needs */
+CompressedBlocks compress_blocks(void const* data, std::uint64_t nbytes,
+    std::size_t item_size, Codec codec,
+    std::uint64_t block_bytes = compression_block_bytes);
+void decompress_blocks(CompressedBlocks const& blocks, std::size_t item_size,
+    Codec codec, void* data, std::uint64_t nbytes);
+#endif
+
+}  // end namespace Omega_h
+
+#endif
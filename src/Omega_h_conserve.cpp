@@ -734,7 +734,9 @@ static void correct_density_error(Mesh* mesh, TransferOpts const& xfer_opts,
   mesh->remove_tag(dim, error_name);
 }
 
-void correct_momentum_error(Mesh* mesh, TransferOpts const& xfer_opts,
+/* returns the corrected velocities, which the caller still
+   has to synchronize */
+Reals correct_momentum_error(Mesh* mesh, TransferOpts const& xfer_opts,
     Graph diffusion_graph, TagBase const* tagbase, bool verbose) {
   auto dim = mesh->dim();
   auto ncomps = tagbase->ncomps();
@@ -790,10 +792,8 @@ void correct_momentum_error(Mesh* mesh, TransferOpts const& xfer_opts,
     }
   };
   parallel_for(mesh->nverts(), f, "correct_momentum_error");
-  auto new_velocities = Reals(out);
-  new_velocities = mesh->sync_array(VERT, new_velocities, ncomps);
-  mesh->set_tag(VERT, velocity_name, new_velocities);
   mesh->remove_tag(dim, error_name);
+  return out;
 }
 
 void correct_integral_errors(Mesh* mesh, AdaptOpts const& opts) {
@@ -811,13 +811,23 @@ void correct_integral_errors(Mesh* mesh, AdaptOpts const& opts) {
       correct_density_error(mesh, xfer_opts, diffusion_graph, tagbase, verbose);
     }
   }
+  /* the corrected velocities are synchronized together */
+  std::vector<std::string> velocity_names;
+  std::vector<Read<Real>> velocities;
+  std::vector<Int> widths;
   for (Int tagi = 0; tagi < mesh->ntags(VERT); ++tagi) {
     auto tagbase = mesh->get_tag(VERT, tagi);
     if (is_momentum_velocity(mesh, xfer_opts, VERT, tagbase)) {
-      correct_momentum_error(
-          mesh, xfer_opts, diffusion_graph, tagbase, verbose);
+      velocity_names.push_back(tagbase->name());
+      velocities.push_back(correct_momentum_error(
+          mesh, xfer_opts, diffusion_graph, tagbase, verbose));
+      widths.push_back(tagbase->ncomps());
     }
   }
+  velocities = mesh->sync_arrays(VERT, velocities, widths);
+  for (std::size_t i = 0; i < velocity_names.size(); ++i) {
+    mesh->set_tag(VERT, velocity_names[i], velocities[i]);
+  }
   for (Int tagi = 0; tagi < mesh->ntags(dim); ++tagi) {
     auto tagbase = mesh->get_tag(dim, tagi);
     if (should_conserve(mesh, xfer_opts, dim, tagbase)) {
@@ -42,6 +42,13 @@ enum Omega_h_Parting {
   OMEGA_H_VERT_BASED,
 };
 
+// the partitioner used by Mesh::balance()
+enum Omega_h_Balancer {
+  OMEGA_H_RIB,         // recursive inertial bisection of element centroids
+  OMEGA_H_MULTILEVEL,  // multilevel partitioning of the dual graph
+  OMEGA_H_HILBERT,     // cuts along a Hilbert curve through the centroids
+};
+
 enum Omega_h_Source {
   OMEGA_H_CONSTANT,
   OMEGA_H_VARIATION,
@@ -1,5 +1,7 @@
 #include "Omega_h_dist.hpp"
 
+#include <map>
+
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_for.hpp"
 #include "Omega_h_int_scan.hpp"
@@ -8,6 +10,32 @@
 
 namespace Omega_h {
 
+template <typename T>
+struct ExchPlansOf {
+  std::map<Int, Int> nexchs;
+  std::map<Int, std::unique_ptr<AlltoallvPlan<T>>> plans;
+};
+
+struct ExchPlans {
+  ExchPlansOf<I8> i8;
+  ExchPlansOf<I32> i32;
+  ExchPlansOf<I64> i64;
+  ExchPlansOf<Real> real;
+  /* the reverse root each reverse content belongs to,
+     built by the first exch_subset() in this direction */
+  LOs rcontent2rroots;
+};
+
+#if defined(OMEGA_H_USE_MPI) &&                                                \
+    (!defined(OMEGA_H_USE_CUDA) || defined(OMEGA_H_USE_CUDA_AWARE_MPI))
+static ExchPlansOf<I8>& plans_of(ExchPlans& plans, I8) { return plans.i8; }
+static ExchPlansOf<I32>& plans_of(ExchPlans& plans, I32) { return plans.i32; }
+static ExchPlansOf<I64>& plans_of(ExchPlans& plans, I64) { return plans.i64; }
+static ExchPlansOf<Real>& plans_of(ExchPlans& plans, Real) {
+  return plans.real;
+}
+#endif
+
 Dist::Dist() {}
 
 Dist::Dist(Dist const& other) { copy(other); }
@@ -71,6 +99,7 @@ void Dist::set_dest_ranks(Read<I32> items2ranks_in) {
   auto fdegrees = get_degrees(msgs2content_[F]);
   auto rdegrees = comm_[F]->alltoall(fdegrees);
   msgs2content_[R] = offset_scan(rdegrees);
+  reset_plans();
 }
 
 void Dist::set_dest_idxs(LOs fitems2rroots, LO nrroots) {
@@ -101,10 +130,46 @@ Dist Dist::invert() const {
     out.items2content_[i] = items2content_[1 - i];
     out.msgs2content_[i] = msgs2content_[1 - i];
     out.comm_[i] = comm_[1 - i];
+    out.plans_[i] = plans_[1 - i];
   }
   return out;
 }
 
+void Dist::keep_plans() {
+  if (plans_[F]) return;
+  for (Int i = 0; i < 2; ++i) plans_[i] = std::make_shared<ExchPlans>();
+}
+
+/* a new pattern needs new plans, if this Dist keeps any */
+void Dist::reset_plans() {
+  for (Int i = 0; i < 2; ++i) {
+    if (plans_[i]) plans_[i] = std::make_shared<ExchPlans>();
+  }
+}
+
+/* Dists that do not keep plans, such as those formed during
+   migration, always go through Comm::alltoallv().
+   the others only build a plan the second time the same type and
+   width go through this pattern, since building one takes several
+   collective calls */
+template <typename T>
+AlltoallvPlan<T>* Dist::ask_plan(Int width) const {
+#if defined(OMEGA_H_USE_MPI) &&                                                \
+    (!defined(OMEGA_H_USE_CUDA) || defined(OMEGA_H_USE_CUDA_AWARE_MPI))
+  if (!plans_[F]) return nullptr;
+  auto& of = plans_of(*plans_[F], T());
+  auto& plan = of.plans[width];
+  if (!plan && ++of.nexchs[width] > 1) {
+    plan.reset(new AlltoallvPlan<T>(
+        comm_[F], msgs2content_[F], msgs2content_[R], width));
+  }
+  return plan.get();
+#else
+  (void)width;
+  return nullptr;
+#endif
+}
+
 template <typename T>
 Read<T> Dist::exch(Read<T> data, Int width) const {
   OMEGA_H_TIME_FUNCTION;
@@ -112,6 +177,20 @@ Read<T> Dist::exch(Read<T> data, Int width) const {
   if (roots2items_[F].exists()) {
     data = expand(data, roots2items_[F], width);
   }
+  auto plan = ask_plan<T>(width);
+  if (plan) {
+    auto sendbuf = plan->sendbuf();
+    if (items2content_[F].exists()) {
+      map_into(data, items2content_[F], sendbuf, width);
+    } else {
+      copy_into(data, sendbuf);
+    }
+    auto recvbuf = plan->exch();
+    if (items2content_[R].exists()) {
+      return unmap(items2content_[R], recvbuf, width);
+    }
+    return deep_copy(recvbuf);
+  }
   if (items2content_[F].exists()) {
     data = permute(data, items2content_[F], width);
   }
@@ -148,6 +227,119 @@ Read<T> Dist::exch_reduce(Read<T> data, Int width, Omega_h_Op op) const {
   return fan_reduce(roots2items_[R], item_data, width, op);
 }
 
+/* the number of entries of the ascending (a) of size (n) below (v) */
+OMEGA_H_INLINE LO count_below(LOs const& a, LO n, LO v) {
+  LO l = 0;
+  LO r = n;
+  while (l < r) {
+    auto m = (l + r) / 2;
+    if (a[m] < v) {
+      l = m + 1;
+    } else {
+      r = m;
+    }
+  }
+  return l;
+}
+
+/* kept with the plans since, unlike them, it does not depend on
+   the type or width being exchanged */
+LOs Dist::ask_rcontent2rroots() const {
+  if (plans_[F] && plans_[F]->rcontent2rroots.exists()) {
+    return plans_[F]->rcontent2rroots;
+  }
+  auto ncontent = msgs2content_[R].last();
+  LOs rcontent2rroots(ncontent, 0, 1);
+  if (items2content_[R].exists()) {
+    rcontent2rroots = invert_permutation(items2content_[R]);
+  }
+  if (roots2items_[R].exists()) {
+    rcontent2rroots =
+        unmap(rcontent2rroots, invert_fan(roots2items_[R]), 1);
+  }
+  if (plans_[F]) plans_[F]->rcontent2rroots = rcontent2rroots;
+  return rcontent2rroots;
+}
+
+/* the listed roots are expanded to their items and sorted into
+   content order, which groups them by message. an alltoall tells the
+   receivers how many arrive in each message, then two alltoallv
+   calls carry the packets and their positions in the content of the
+   full pattern, which the receiver turns back into roots.
+   every message starts with a placeholder at position -1, which the
+   receiver drops, since point-to-point messages may not be empty */
+template <typename T>
+Read<T> Dist::exch_subset(
+    LOs roots, Read<T> data, Int width, LOs* recvd_roots) const {
+  OMEGA_H_TIME_FUNCTION;
+  LOs items = roots;
+  if (roots2items_[F].exists()) {
+    auto froots2items = roots2items_[F];
+    Write<LO> degrees(roots.size());
+    auto count = OMEGA_H_LAMBDA(LO i) {
+      degrees[i] = froots2items[roots[i] + 1] - froots2items[roots[i]];
+    };
+    parallel_for(roots.size(), count, "exch_subset_degrees");
+    auto subset2items = offset_scan(Read<LO>(degrees));
+    Write<LO> items_w(subset2items.last());
+    auto list = OMEGA_H_LAMBDA(LO i) {
+      auto item = froots2items[roots[i]];
+      for (auto j = subset2items[i]; j < subset2items[i + 1]; ++j) {
+        items_w[j] = item++;
+      }
+    };
+    parallel_for(roots.size(), list, "exch_subset_items");
+    items = items_w;
+    data = expand(data, subset2items, width);
+  }
+  LOs content = items;
+  if (items2content_[F].exists()) content = unmap(items, items2content_[F], 1);
+  auto order = sort_by_keys(content);
+  content = unmap(order, content, 1);
+  data = unmap(order, data, width);
+  auto fmsgs2content = msgs2content_[F];
+  auto nfmsgs = fmsgs2content.size() - 1;
+  auto ncontent = content.size();
+  Write<LO> sdispls(nfmsgs + 1);
+  auto split = OMEGA_H_LAMBDA(LO m) {
+    sdispls[m] = count_below(content, ncontent, fmsgs2content[m]);
+  };
+  parallel_for(nfmsgs + 1, split, "exch_subset_sdispls");
+  Write<LO> padded_sdispls(nfmsgs + 1);
+  Write<LO> positions(ncontent + nfmsgs, -1);
+  Write<T> padded_data((ncontent + nfmsgs) * width, T(0));
+  auto pad = OMEGA_H_LAMBDA(LO m) { padded_sdispls[m] = sdispls[m] + m; };
+  parallel_for(nfmsgs + 1, pad, "exch_subset_pad");
+  auto locate = OMEGA_H_LAMBDA(LO i) {
+    auto m = count_below(fmsgs2content, nfmsgs + 1, content[i] + 1) - 1;
+    auto p = i + m + 1;
+    positions[p] = content[i] - fmsgs2content[m];
+    for (Int j = 0; j < width; ++j) {
+      padded_data[p * width + j] = data[i * width + j];
+    }
+  };
+  parallel_for(ncontent, locate, "exch_subset_positions");
+  auto scounts = get_degrees(LOs(padded_sdispls));
+  auto rdispls = offset_scan(comm_[F]->alltoall(scounts));
+  auto recvd_positions =
+      comm_[F]->alltoallv(read(positions), read(padded_sdispls), rdispls, 1);
+  auto recvd = comm_[F]->alltoallv(
+      read(padded_data), read(padded_sdispls), rdispls, width);
+  auto rcontent2rroots = ask_rcontent2rroots();
+  auto rmsgs2content = msgs2content_[R];
+  auto nrmsgs = rmsgs2content.size() - 1;
+  Write<LO> recvd_roots_w(recvd_positions.size(), -1);
+  auto arrive = OMEGA_H_LAMBDA(LO i) {
+    if (recvd_positions[i] < 0) return;
+    auto m = count_below(rdispls, nrmsgs + 1, i + 1) - 1;
+    recvd_roots_w[i] = rcontent2rroots[rmsgs2content[m] + recvd_positions[i]];
+  };
+  parallel_for(recvd_positions.size(), arrive, "exch_subset_roots");
+  auto kept = collect_marked(each_geq_to(recvd_positions, LO(0)));
+  *recvd_roots = unmap(kept, LOs(recvd_roots_w), 1);
+  return unmap(kept, recvd, width);
+}
+
 CommPtr Dist::parent_comm() const { return parent_comm_; }
 
 CommPtr Dist::comm() const { return comm_[F]; }
@@ -202,6 +394,8 @@ void Dist::change_comm(CommPtr new_comm) {
   comm_[R] = comm_[F]->graph_inverse();
   // replace parent_comm_
   parent_comm_ = new_comm;
+  // plans are bound to the old communicators
+  reset_plans();
   // thats it! since all rank information is queried from graph comms
 }
 
@@ -218,6 +412,7 @@ void Dist::copy(Dist const& other) {
     items2content_[i] = other.items2content_[i];
     msgs2content_[i] = other.msgs2content_[i];
     comm_[i] = other.comm_[i];
+    plans_[i] = other.plans_[i];
   }
 }
 
@@ -260,7 +455,9 @@ Dist create_dist_for_variable_sized(Dist copies2owners, LOs copies2data) {
   template Read<T> Dist::exch(Read<T> data, Int width) const;                  \
   template Future<T> Dist::iexch(Read<T> data, Int width) const;             \
   template Read<T> Dist::exch_reduce(Read<T> data, Int width, Omega_h_Op op)   \
-      const;
+      const;                                                                   \
+  template Read<T> Dist::exch_subset(                                          \
+      LOs roots, Read<T> data, Int width, LOs* recvd_roots) const;
 INST_T(I8)
 INST_T(I32)
 INST_T(I64)
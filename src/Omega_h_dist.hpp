@@ -89,12 +89,17 @@ namespace Omega_h {
    sent and received data, respectively.
  */
 
+struct ExchPlans;
+
 class Dist {
   CommPtr parent_comm_;
   LOs roots2items_[2];
   LOs items2content_[2];
   LOs msgs2content_[2];
   CommPtr comm_[2];
+  /* persistent exchange plans for each direction, shared by copies
+     of this Dist, if keep_plans() was called */
+  std::shared_ptr<ExchPlans> plans_[2];
 
  public:
   Dist();
@@ -132,6 +137,13 @@ class Dist {
      are assumed to be the same as reverse items.
      one may only call this API or set_dest_idxs(), not both */
   void set_dest_globals(GOs fitems2ritem_globals);
+  /* marks this Dist as one that will exchange many times, so that
+     once a type and width is reused, exchanges of it go through a
+     persistent AlltoallvPlan. copies and inversions share the plans.
+     this only sets up local bookkeeping. the collective step is the
+     plan creation inside the second exch() of a type and width,
+     which every rank reaches together like any other exch(). */
+  void keep_plans();
   Dist invert() const;
   template <typename T>
   Read<T> exch(Read<T> data, Int width) const;
@@ -139,6 +151,17 @@ class Dist {
   Future<T> iexch(Read<T> data, Int width) const;
   template <typename T>
   Read<T> exch_reduce(Read<T> data, Int width, Omega_h_Op op) const;
+  /* like exch(), but only the forward roots listed in (roots) send,
+     with (data) holding one packet per listed root.
+     returns the packets received, in no particular order, and sets
+     (*recvd_roots) to the reverse root each of them is for.
+     besides the packets, their positions, one count and one
+     placeholder packet per neighbor travel, so this is cheap when
+     few roots send.
+     this is a collective call. */
+  template <typename T>
+  Read<T> exch_subset(
+      LOs roots, Read<T> data, Int width, LOs* recvd_roots) const;
   CommPtr parent_comm() const;
   CommPtr comm() const;
   LOs msgs2content() const;
@@ -159,6 +182,10 @@ class Dist {
 
  private:
   void copy(Dist const& other);
+  void reset_plans();
+  LOs ask_rcontent2rroots() const;
+  template <typename T>
+  AlltoallvPlan<T>* ask_plan(Int width) const;
   enum { F, R };
 };
 
@@ -175,7 +202,9 @@ Dist create_dist_for_variable_sized(Dist copies2owners, LOs copies2data);
   extern template Read<T> Dist::exch(Read<T> data, Int width) const;           \
   extern template Future<T> Dist::iexch(Read<T> data, Int width) const;        \
   extern template Read<T> Dist::exch_reduce<T>(                                \
-      Read<T> data, Int width, Omega_h_Op op) const;
+      Read<T> data, Int width, Omega_h_Op op) const;                           \
+  extern template Read<T> Dist::exch_subset<T>(                                \
+      LOs roots, Read<T> data, Int width, LOs* recvd_roots) const;
 OMEGA_H_EXPL_INST_DECL(I8)
 OMEGA_H_EXPL_INST_DECL(I32)
 OMEGA_H_EXPL_INST_DECL(I64)
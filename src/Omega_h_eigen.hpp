@@ -511,6 +511,238 @@ OMEGA_H_INLINE_BIG Tensor<dim> sqrt_spd(Tensor<dim> const m) OMEGA_H_NOEXCEPT {
   return compose_ortho(decomp.q, decomp.l);
 }
 
+/* batched eigendecomposition of symmetric tensors.
+   a pack holds (eigen_pack_width) tensors as structure-of-arrays,
+   one lane per tensor, and decompose_symm_pack() works through
+   them in loops over lanes without branches, so that compilers
+   vectorize those loops for whatever instruction set they target.
+   eigenvalues come from the trigonometric solution of the
+   characteristic polynomial, whose roots are all real for
+   symmetric tensors:
+     O.K. Smith, "Eigenvalues of a symmetric 3x3 matrix",
+     Communications of the ACM 4(4), 1961
+   and eigenvectors from cross products of rows of (m - l*I).
+   unlike decompose_eigen(), eigenvalues are sorted from largest
+   to smallest and (q) is always orthonormal, including when
+   eigenvalues repeat.
+   a GPU thread gains nothing from packing, so packs have
+   a single lane there */
+#ifdef OMEGA_H_USE_CUDA
+constexpr Int eigen_pack_width = 1;
+#else
+constexpr Int eigen_pack_width = 8;
+#endif
+
+template <Int dim>
+struct SymmPack {
+  Real m[dim][dim][eigen_pack_width];
+};
+
+template <Int dim>
+struct DiagDecompPack {
+  Real q[dim][dim][eigen_pack_width];
+  Real l[dim][eigen_pack_width];
+};
+
+template <Int dim>
+OMEGA_H_INLINE Tensor<dim> get_lane(SymmPack<dim> const& pack, Int k) {
+  Tensor<dim> m;
+  for (Int j = 0; j < dim; ++j) {
+    for (Int i = 0; i < dim; ++i) m[j][i] = pack.m[j][i][k];
+  }
+  return m;
+}
+
+template <Int dim>
+OMEGA_H_INLINE void set_lane(SymmPack<dim>& pack, Int k, Tensor<dim> m) {
+  for (Int j = 0; j < dim; ++j) {
+    for (Int i = 0; i < dim; ++i) pack.m[j][i][k] = m[j][i];
+  }
+}
+
+template <Int dim>
+OMEGA_H_INLINE DiagDecomp<dim> get_lane(
+    DiagDecompPack<dim> const& pack, Int k) {
+  DiagDecomp<dim> dd;
+  for (Int j = 0; j < dim; ++j) {
+    for (Int i = 0; i < dim; ++i) dd.q[j][i] = pack.q[j][i][k];
+    dd.l[j] = pack.l[j][k];
+  }
+  return dd;
+}
+
+template <Int dim>
+OMEGA_H_INLINE void set_lane(
+    DiagDecompPack<dim>& pack, Int k, DiagDecomp<dim> dd) {
+  for (Int j = 0; j < dim; ++j) {
+    for (Int i = 0; i < dim; ++i) pack.q[j][i][k] = dd.q[j][i];
+    pack.l[j][k] = dd.l[j];
+  }
+}
+
+/* the unit vector along the largest cross product of two rows
+   of (s), which spans the null space of (s) if it has rank two */
+OMEGA_H_INLINE Vector<3> largest_row_cross(Tensor<3> const s) {
+  auto const c0 = cross(s[0], s[1]);
+  auto const c1 = cross(s[1], s[2]);
+  auto const c2 = cross(s[0], s[2]);
+  auto const n0 = norm_squared(c0);
+  auto const n1 = norm_squared(c1);
+  auto const n2 = norm_squared(c2);
+  auto const n01 = max2(n0, n1);
+  Vector<3> v;
+  for (Int i = 0; i < 3; ++i) {
+    auto const v01 = (n1 > n0) ? c1[i] : c0[i];
+    v[i] = (n2 > n01) ? c2[i] : v01;
+  }
+  return v / std::sqrt(norm_squared(v) + DBL_MIN);
+}
+
+/* a unit vector orthogonal to the unit vector (v),
+   its cross product with the axis along which (v) is shortest */
+OMEGA_H_INLINE Vector<3> any_orthogonal(Vector<3> const v) {
+  auto const x = std::abs(v[0]);
+  auto const y = std::abs(v[1]);
+  auto const z = std::abs(v[2]);
+  auto const along_x = (x <= y) && (x <= z);
+  auto const along_y = !along_x && (y <= z);
+  auto const e = vector_3(along_x ? 1.0 : 0.0, along_y ? 1.0 : 0.0,
+      (!along_x && !along_y) ? 1.0 : 0.0);
+  auto const u = cross(v, e);
+  return u / std::sqrt(norm_squared(u) + DBL_MIN);
+}
+
+/* the symmetric tensor [[a, b], [b, c]], with the larger
+   eigenvalue first */
+OMEGA_H_INLINE DiagDecomp<2> decompose_symm_2x2(
+    Real const a, Real const b, Real const c) {
+  auto const mean = (a + c) / 2.0;
+  auto const radius = std::sqrt(square((a - c) / 2.0) + square(b));
+  auto const l1 = mean + radius;
+  /* perpendicular to either row of (m - l1 * I), the longer one */
+  auto const x = vector_2(b, l1 - a);
+  auto const y = vector_2(l1 - c, b);
+  auto const nx = norm_squared(x);
+  auto const ny = norm_squared(y);
+  auto const n = max2(nx, ny);
+  auto const v = ((ny > nx) ? y : x) / std::sqrt(n + DBL_MIN);
+  /* both rows vanish: m is a multiple of the identity */
+  auto const is_iso = !(n > DBL_MIN);
+  DiagDecomp<2> dd;
+  for (Int i = 0; i < 2; ++i) {
+    dd.q[0][i] = is_iso ? ((i == 0) ? 1.0 : 0.0) : v[i];
+  }
+  dd.q[1] = perp(dd.q[0]);
+  dd.l[0] = l1;
+  dd.l[1] = mean - radius;
+  return dd;
+}
+
+OMEGA_H_INLINE DiagDecompPack<3> decompose_symm_pack(SymmPack<3> const& pack) {
+  constexpr Int w = eigen_pack_width;
+  Real scales[w];
+  Real means[w];
+  Real spreads[w];
+  Real cosines[w];
+  /* the characteristic polynomial of the normalized tensor (a),
+     shifted and scaled to (b = (a - mean * I) / spread) */
+  for (Int k = 0; k < w; ++k) {
+    auto const m = get_lane(pack, k);
+    auto const nm = max_norm(m);
+    auto const a = m / (nm + DBL_MIN);
+    auto const mean = trace(a) / 3.0;
+    auto const b = subtract_from_diag(a, mean);
+    auto const off_diag = square(a[1][0]) + square(a[2][0]) + square(a[2][1]);
+    auto const spread = std::sqrt(
+        (square(b[0][0]) + square(b[1][1]) + square(b[2][2]) + 2.0 * off_diag) /
+        6.0);
+    scales[k] = nm;
+    means[k] = mean;
+    spreads[k] = spread;
+    /* DBL_MIN only keeps this finite for isotropic tensors */
+    cosines[k] =
+        clamp(determinant(b) / (2.0 * cube(spread) + DBL_MIN), -1.0, 1.0);
+  }
+  /* kept apart so that the arithmetic around it still vectorizes */
+  Real angles[w];
+  for (Int k = 0; k < w; ++k) angles[k] = std::acos(cosines[k]) / 3.0;
+  Real cos1[w];
+  Real cos3[w];
+  for (Int k = 0; k < w; ++k) {
+    cos1[k] = std::cos(angles[k]);
+    cos3[k] = std::cos(angles[k] + (2.0 * PI / 3.0));
+  }
+  DiagDecompPack<3> out;
+  for (Int k = 0; k < w; ++k) {
+    auto const m = get_lane(pack, k);
+    auto const a = m / (scales[k] + DBL_MIN);
+    /* like decompose_eigen(), tiny tensors are taken as zero */
+    auto const scale = (scales[k] > EPSILON) ? scales[k] : 0.0;
+    auto const l1 = means[k] + 2.0 * spreads[k] * cos1[k];
+    auto const l3 = means[k] + 2.0 * spreads[k] * cos3[k];
+    auto const l2 = 3.0 * means[k] - l1 - l3;
+    /* the eigenvector of the eigenvalue furthest from the others
+       is well conditioned. the other two span the plane normal
+       to it, where they are found by decomposing (a) restricted
+       to that plane. this keeps nearly repeated eigenvalues as
+       accurate as the others, which the trigonometric solution
+       alone would not */
+    auto const first_is_far = (l1 - l2) >= (l2 - l3);
+    auto const far_l = first_is_far ? l1 : l3;
+    auto const far_v = largest_row_cross(subtract_from_diag(a, far_l));
+    auto const u = any_orthogonal(far_v);
+    auto const v = cross(far_v, u);
+    auto const au = a * u;
+    auto const av = a * v;
+    auto const pair = decompose_symm_2x2(u * au, u * av, v * av);
+    auto const hi_v = u * pair.q[0][0] + v * pair.q[0][1];
+    auto const lo_v = u * pair.q[1][0] + v * pair.q[1][1];
+    auto const far_rq = far_v * (a * far_v);
+    /* all three repeat: m is a multiple of the identity */
+    auto const is_iso = !(spreads[k] > EPSILON);
+    DiagDecomp<3> dd;
+    for (Int i = 0; i < 3; ++i) {
+      auto const v1 = first_is_far ? far_v[i] : hi_v[i];
+      auto const v2 = first_is_far ? hi_v[i] : lo_v[i];
+      auto const v3 = first_is_far ? lo_v[i] : far_v[i];
+      dd.q[0][i] = is_iso ? ((i == 0) ? 1.0 : 0.0) : v1;
+      dd.q[1][i] = is_iso ? ((i == 1) ? 1.0 : 0.0) : v2;
+      dd.q[2][i] = is_iso ? ((i == 2) ? 1.0 : 0.0) : v3;
+    }
+    auto const rq1 = first_is_far ? far_rq : pair.l[0];
+    auto const rq2 = first_is_far ? pair.l[0] : pair.l[1];
+    auto const rq3 = first_is_far ? pair.l[1] : far_rq;
+    dd.l[0] = (is_iso ? means[k] : rq1) * scale;
+    dd.l[1] = (is_iso ? means[k] : rq2) * scale;
+    dd.l[2] = (is_iso ? means[k] : rq3) * scale;
+    set_lane(out, k, dd);
+  }
+  return out;
+}
+
+OMEGA_H_INLINE DiagDecompPack<2> decompose_symm_pack(SymmPack<2> const& pack) {
+  DiagDecompPack<2> out;
+  for (Int k = 0; k < eigen_pack_width; ++k) {
+    auto const m = get_lane(pack, k);
+    auto const nm = max_norm(m);
+    auto const scale = (nm > EPSILON) ? nm : 0.0;
+    auto const a = m / (nm + DBL_MIN);
+    auto dd = decompose_symm_2x2(a[0][0], a[1][0], a[1][1]);
+    dd.l = dd.l * scale;
+    set_lane(out, k, dd);
+  }
+  return out;
+}
+
+OMEGA_H_INLINE DiagDecompPack<1> decompose_symm_pack(SymmPack<1> const& pack) {
+  DiagDecompPack<1> out;
+  for (Int k = 0; k < eigen_pack_width; ++k) {
+    out.q[0][0][k] = 1.0;
+    out.l[0][k] = pack.m[0][0][k];
+  }
+  return out;
+}
+
 Reals get_max_eigenvalues(Int dim, Reals symms);
 
 }  // end namespace Omega_h
@@ -33,7 +33,7 @@ void fail(char const* format, ...) {
 #  ifdef OMEGA_H_ENABLE_DEMANGLED_STACKTRACE
   buf = buf + "\n" + Omega_h::Stacktrace::demangled_stacktrace();
 #  endif
-  if (Omega_h::profile::global_singleton_history) {
+  if (Omega_h::is_profiled_thread()) {
     auto &h = *Omega_h::profile::global_singleton_history;
     auto s = h.current_frame;
     buf = buf + "\nFrames:\n" + h.get_name(s);
@@ -56,7 +56,7 @@ void fail(char const* format, ...) {
 #  ifdef OMEGA_H_ENABLE_DEMANGLED_STACKTRACE
   std::cerr << "\n" << Omega_h::Stacktrace::demangled_stacktrace() << std::endl;
 #  endif
-  if (Omega_h::profile::global_singleton_history) {
+  if (Omega_h::is_profiled_thread()) {
     auto &h = *Omega_h::profile::global_singleton_history;
     auto s = h.current_frame;
     std::cerr << "\nFrames:\n" << h.get_name(s);
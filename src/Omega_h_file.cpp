@@ -2,17 +2,29 @@
 
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <algorithm>
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
+#include <exception>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <streambuf>
+
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #ifdef OMEGA_H_USE_ZLIB
 #include <zlib.h>
 #endif
 
 #include "Omega_h_array_ops.hpp"
+#include "Omega_h_compress.hpp"
 #include "Omega_h_for.hpp"
 #include "Omega_h_inertia.hpp"
 #include "Omega_h_mesh.hpp"
@@ -87,6 +99,89 @@ struct SwapBytes<T, 8> {
 
 unsigned char const magic[2] = {0xa1, 0x1a};
 
+/* since version 10, uncompressed arrays start at a multiple
+   of this many bytes from the start of the file */
+constexpr std::size_t array_alignment = 64;
+
+/* a whole file mapped into memory copy-on-write:
+   arrays may be modified in memory without changing the file */
+struct MappedFile {
+  void* data;
+  std::size_t size;
+  MappedFile(void* data_in, std::size_t size_in)
+      : data(data_in), size(size_in) {}
+  MappedFile(MappedFile const&) = delete;
+  MappedFile& operator=(MappedFile const&) = delete;
+  ~MappedFile() {
+#ifndef _MSC_VER
+    ::munmap(data, size);
+#endif
+  }
+};
+
+/* returns nullptr if the file can't be mapped, in which case
+   callers should fall back to reading it through a stream */
+std::shared_ptr<MappedFile> map_file(filesystem::path const& filepath) {
+#ifndef _MSC_VER
+  auto const fd = ::open(filepath.c_str(), O_RDONLY);
+  if (fd == -1) return nullptr;
+  struct ::stat info;
+  if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+    ::close(fd);
+    return nullptr;
+  }
+  auto const size = static_cast<std::size_t>(info.st_size);
+  auto const data =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) return nullptr;
+  return std::make_shared<MappedFile>(data, size);
+#else
+  (void)filepath;
+  return nullptr;
+#endif
+}
+
+/* lets the stream-based reading code parse a mapped file,
+   and lets read_array wrap the arrays in it instead of copying them */
+class MappedFileBuf : public std::streambuf {
+  std::shared_ptr<MappedFile> file_;
+
+ public:
+  MappedFileBuf(std::shared_ptr<MappedFile> file) : file_(file) {
+    auto const begin = static_cast<char*>(file_->data);
+    setg(begin, begin, begin + file_->size);
+  }
+  char* current() const { return gptr(); }
+  std::size_t remaining() const { return std::size_t(egptr() - gptr()); }
+  void skip(std::size_t n) { setg(eback(), gptr() + n, egptr()); }
+  std::shared_ptr<MappedFile> const& file() const { return file_; }
+};
+
+/* arrays can only point into the mapped file if the
+   device can access host memory and no byte swapping is needed */
+template <typename T>
+bool wrap_mapped_array(
+    std::istream& stream, LO size, bool needs_swapping, Read<T>* array) {
+#if defined(OMEGA_H_USE_KOKKOS) || defined(OMEGA_H_USE_CUDA)
+  (void)stream;
+  (void)size;
+  (void)needs_swapping;
+  (void)array;
+  return false;
+#else
+  auto const buf = dynamic_cast<MappedFileBuf*>(stream.rdbuf());
+  if (buf == nullptr || needs_swapping) return false;
+  auto const bytes = static_cast<std::size_t>(size) * sizeof(T);
+  if (buf->remaining() < bytes) return false;
+  auto const data = buf->current();
+  if (reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0) return false;
+  *array = Write<T>(size, reinterpret_cast<T*>(data), buf->file());
+  buf->skip(bytes);
+  return true;
+#endif
+}
+
 }  // end anonymous namespace
 
 template <typename T>
@@ -115,49 +210,121 @@ void read_value(std::istream& stream, T& val, bool needs_swapping) {
   if (needs_swapping) swap_bytes(val);
 }
 
-template <typename T>
-void write_array(std::ostream& stream, Read<T> array, bool is_compressed,
-    bool needs_swapping) {
-  LO size = array.size();
-  write_value(stream, size, needs_swapping);
-  Read<T> swapped = swap_bytes(array, needs_swapping);
-  HostRead<T> uncompressed(swapped);
-  I64 uncompressed_bytes =
-      static_cast<I64>(static_cast<std::size_t>(size) * sizeof(T));
+/* writes the contents of an array that is already on the host.
+   this touches neither Omega_h arrays nor the profiler,
+   so it may be called from any thread */
+static void write_array_data(std::ostream& stream, void const* data,
+    std::size_t nbytes, std::size_t item_size, bool is_compressed,
+    bool needs_swapping, Codec codec) {
+  std::vector<unsigned char> swapped;
+  if (needs_swapping && item_size > 1) {
+    auto const bytes = static_cast<unsigned char const*>(data);
+    swapped.assign(bytes, bytes + nbytes);
+    for (std::size_t i = 0; i < nbytes; i += item_size) {
+      std::reverse(swapped.begin() + std::ptrdiff_t(i),
+          swapped.begin() + std::ptrdiff_t(i + item_size));
+    }
+    data = swapped.data();
+  }
 #ifdef OMEGA_H_USE_ZLIB
   if (is_compressed) {
-    uLong source_bytes = static_cast<uLong>(uncompressed_bytes);
-    uLong dest_bytes = ::compressBound(source_bytes);
-    auto compressed = new ::Bytef[dest_bytes];
-    int ret = ::compress2(compressed, &dest_bytes,
-        reinterpret_cast<const ::Bytef*>(nonnull(uncompressed.data())),
-        source_bytes, Z_BEST_SPEED);
-    OMEGA_H_CHECK(ret == Z_OK);
-    I64 compressed_bytes = static_cast<I64>(dest_bytes);
-    write_value(stream, compressed_bytes, needs_swapping);
-    stream.write(reinterpret_cast<const char*>(compressed), compressed_bytes);
-    delete[] compressed;
+    auto const blocks = compress_blocks(data, nbytes, item_size, codec);
+    I8 const codec_i8 = I8(codec);
+    write_value(stream, codec_i8, needs_swapping);
+    write_value(stream, I64(blocks.block_bytes), needs_swapping);
+    write_value(stream, I64(blocks.sizes.size()), needs_swapping);
+    for (auto const block_size : blocks.sizes) {
+      write_value(stream, I64(block_size), needs_swapping);
+    }
+    stream.write(reinterpret_cast<const char*>(blocks.data.data()),
+        std::streamsize(blocks.data.size()));
   } else
 #else
   OMEGA_H_CHECK(is_compressed == false);
+  (void)codec;
 #endif
   {
-    stream.write(reinterpret_cast<const char*>(nonnull(uncompressed.data())),
-        uncompressed_bytes);
+    /* pad so that the array can be used in place once mapped */
+    I8 npad = 0;
+    auto const pos = stream.tellp();
+    if (pos != std::streampos(-1)) {
+      auto const data_pos = static_cast<std::size_t>(pos) + sizeof(npad);
+      npad = I8((array_alignment - data_pos % array_alignment) %
+                array_alignment);
+    }
+    write_value(stream, npad, needs_swapping);
+    char const zeros[array_alignment] = {};
+    stream.write(zeros, npad);
+    stream.write(static_cast<const char*>(data), std::streamsize(nbytes));
   }
 }
 
+template <typename T>
+void write_array(std::ostream& stream, Read<T> array, bool is_compressed,
+    bool needs_swapping, Codec codec) {
+  LO size = array.size();
+  write_value(stream, size, needs_swapping);
+  HostRead<T> host_array(array);
+  write_array_data(stream, host_array.data(),
+      static_cast<std::size_t>(size) * sizeof(T), sizeof(T), is_compressed,
+      needs_swapping, codec);
+}
+
+#ifdef OMEGA_H_USE_ZLIB
+/* since version 11, compressed arrays are split into blocks:
+   codec, uncompressed block size, block count,
+   compressed size of each block, then the blocks */
+static void read_compressed_blocks(std::istream& stream, void* data,
+    std::uint64_t nbytes, std::size_t item_size, bool needs_swapping) {
+  I8 codec;
+  read_value(stream, codec, needs_swapping);
+  OMEGA_H_CHECK(codec == CODEC_ZLIB || codec == CODEC_SHUFFLE_ZLIB ||
+                codec == CODEC_ZLIB_HUFFMAN);
+  I64 block_bytes;
+  read_value(stream, block_bytes, needs_swapping);
+  OMEGA_H_CHECK(block_bytes >= 0);
+  I64 nblocks;
+  read_value(stream, nblocks, needs_swapping);
+  OMEGA_H_CHECK(nblocks >= 1);
+  CompressedBlocks blocks;
+  blocks.block_bytes = std::uint64_t(block_bytes);
+  blocks.sizes.resize(std::size_t(nblocks));
+  std::uint64_t compressed_bytes = 0;
+  for (auto& block_size : blocks.sizes) {
+    I64 block_size_i64;
+    read_value(stream, block_size_i64, needs_swapping);
+    OMEGA_H_CHECK(block_size_i64 >= 0);
+    block_size = std::uint64_t(block_size_i64);
+    compressed_bytes += block_size;
+  }
+  blocks.data.resize(compressed_bytes);
+  stream.read(reinterpret_cast<char*>(blocks.data.data()),
+      std::streamsize(compressed_bytes));
+  decompress_blocks(blocks, item_size, Codec(codec), data, nbytes);
+}
+#endif
+
 template <typename T>
 void read_array(std::istream& stream, Read<T>& array, bool is_compressed,
-    bool needs_swapping) {
+    bool needs_swapping, I32 version) {
   LO size;
   read_value(stream, size, needs_swapping);
   OMEGA_H_CHECK(size >= 0);
+  if (!is_compressed && version >= 10) {
+    I8 npad;
+    read_value(stream, npad, needs_swapping);
+    OMEGA_H_CHECK(0 <= npad && std::size_t(npad) < array_alignment);
+    stream.ignore(npad);
+    if (wrap_mapped_array(stream, size, needs_swapping, &array)) return;
+  }
   I64 uncompressed_bytes =
       static_cast<I64>(static_cast<std::size_t>(size) * sizeof(T));
   HostWrite<T> uncompressed(size);
 #ifdef OMEGA_H_USE_ZLIB
-  if (is_compressed) {
+  if (is_compressed && version >= 11) {
+    read_compressed_blocks(stream, nonnull(uncompressed.data()),
+        std::uint64_t(uncompressed_bytes), sizeof(T), needs_swapping);
+  } else if (is_compressed) {
     I64 compressed_bytes;
     read_value(stream, compressed_bytes, needs_swapping);
     OMEGA_H_CHECK(compressed_bytes >= 0);
@@ -180,7 +347,11 @@ void read_array(std::istream& stream, Read<T>& array, bool is_compressed,
     stream.read(reinterpret_cast<char*>(nonnull(uncompressed.data())),
         uncompressed_bytes);
   }
-  array = swap_bytes(Read<T>(uncompressed.write()), needs_swapping);
+  /* swap on the host copy rather than making another device copy */
+  if (needs_swapping) {
+    for (LO i = 0; i < size; ++i) swap_bytes(uncompressed[i]);
+  }
+  array = uncompressed.write();
 }
 
 void write(std::ostream& stream, std::string const& val, bool needs_swapping) {
@@ -270,8 +441,47 @@ static void read_meta(
   }
 }
 
-static void write_tag(std::ostream& stream, TagBase const* tag,
-    bool is_compressed, bool needs_swapping) {
+/* the contents of an .osh part file, except that the mesh's arrays
+   are referenced rather than copied. taking a snapshot must happen on
+   the thread that owns the mesh, but writing one out doesn't involve
+   the mesh, so it may happen on any thread */
+struct MeshSnapshot {
+  struct Array {
+    /* the bytes between the previous array and this one */
+    std::string prefix;
+    void const* data;
+    std::size_t nbytes;
+    std::size_t item_size;
+  };
+  bool is_compressed;
+  bool needs_swapping;
+  Codec codec;
+  std::vector<Array> arrays;
+  /* the bytes after the last array */
+  std::string suffix;
+  /* keeps the arrays alive (and on the host) */
+  std::vector<std::shared_ptr<void>> owners;
+};
+
+template <typename T>
+static void snapshot_array(
+    std::ostringstream& stream, Read<T> array, MeshSnapshot* snapshot) {
+  LO size = array.size();
+  write_value(stream, size, snapshot->needs_swapping);
+  auto const host_array = std::make_shared<HostRead<T>>(array);
+  MeshSnapshot::Array entry;
+  entry.prefix = stream.str();
+  entry.data = host_array->data();
+  entry.nbytes = static_cast<std::size_t>(size) * sizeof(T);
+  entry.item_size = sizeof(T);
+  snapshot->arrays.push_back(std::move(entry));
+  snapshot->owners.push_back(host_array);
+  stream.str("");
+}
+
+static void snapshot_tag(
+    std::ostringstream& stream, TagBase const* tag, MeshSnapshot* snapshot) {
+  auto const needs_swapping = snapshot->needs_swapping;
   std::string name = tag->name();
   write(stream, name, needs_swapping);
   auto ncomps = I8(tag->ncomps());
@@ -279,13 +489,13 @@ static void write_tag(std::ostream& stream, TagBase const* tag,
   I8 type = tag->type();
   write_value(stream, type, needs_swapping);
   if (is<I8>(tag)) {
-    write_array(stream, as<I8>(tag)->array(), is_compressed, needs_swapping);
+    snapshot_array(stream, as<I8>(tag)->array(), snapshot);
   } else if (is<I32>(tag)) {
-    write_array(stream, as<I32>(tag)->array(), is_compressed, needs_swapping);
+    snapshot_array(stream, as<I32>(tag)->array(), snapshot);
   } else if (is<I64>(tag)) {
-    write_array(stream, as<I64>(tag)->array(), is_compressed, needs_swapping);
+    snapshot_array(stream, as<I64>(tag)->array(), snapshot);
   } else if (is<Real>(tag)) {
-    write_array(stream, as<Real>(tag)->array(), is_compressed, needs_swapping);
+    snapshot_array(stream, as<Real>(tag)->array(), snapshot);
   } else {
     Omega_h_fail("unexpected tag type in binary write\n");
   }
@@ -309,26 +519,26 @@ static void read_tag(std::istream& stream, Mesh* mesh, Int d,
   }
   if (type == OMEGA_H_I8) {
     Read<I8> array;
-    read_array(stream, array, is_compressed, needs_swapping);
+    read_array(stream, array, is_compressed, needs_swapping, version);
     mesh->add_tag(d, name, ncomps, array, true);
   } else if (type == OMEGA_H_I32) {
     Read<I32> array;
-    read_array(stream, array, is_compressed, needs_swapping);
+    read_array(stream, array, is_compressed, needs_swapping, version);
     mesh->add_tag(d, name, ncomps, array, true);
   } else if (type == OMEGA_H_I64) {
     Read<I64> array;
-    read_array(stream, array, is_compressed, needs_swapping);
+    read_array(stream, array, is_compressed, needs_swapping, version);
     mesh->add_tag(d, name, ncomps, array, true);
   } else if (type == OMEGA_H_F64) {
     Read<Real> array;
-    read_array(stream, array, is_compressed, needs_swapping);
+    read_array(stream, array, is_compressed, needs_swapping, version);
     mesh->add_tag(d, name, ncomps, array, true);
   } else {
     Omega_h_fail("unexpected tag type in binary read\n");
   }
 }
 
-static void write_sets(std::ostream& stream, Mesh* mesh, bool needs_swapping) {
+void write_sets(std::ostream& stream, Mesh* mesh, bool needs_swapping) {
   auto n = I32(mesh->class_sets.size());
   write_value(stream, n, needs_swapping);
   for (auto& set : mesh->class_sets) {
@@ -343,7 +553,7 @@ static void write_sets(std::ostream& stream, Mesh* mesh, bool needs_swapping) {
   }
 }
 
-static void read_sets(std::istream& stream, Mesh* mesh, bool needs_swapping) {
+void read_sets(std::istream& stream, Mesh* mesh, bool needs_swapping) {
   I32 n;
   read_value(stream, n, needs_swapping);
   for (I32 i = 0; i < n; ++i) {
@@ -360,37 +570,38 @@ static void read_sets(std::istream& stream, Mesh* mesh, bool needs_swapping) {
   }
 }
 
-void write(std::ostream& stream, Mesh* mesh) {
-  begin_code("binary::write(stream,Mesh)");
+static MeshSnapshot snapshot_mesh(Mesh* mesh, bool compress, Codec codec) {
+  begin_code("binary::snapshot_mesh");
+  MeshSnapshot snapshot;
+  snapshot.is_compressed = compress;
+  snapshot.needs_swapping = !is_little_endian_cpu();
+  snapshot.codec = codec;
+  auto const needs_swapping = snapshot.needs_swapping;
+  std::ostringstream stream;
   stream.write(reinterpret_cast<const char*>(magic), sizeof(magic));
 // write_value(stream, latest_version); moved to /version at version 4
-#ifdef OMEGA_H_USE_ZLIB
-  I8 is_compressed = true;
-#else
-  I8 is_compressed = false;
-#endif
-  bool needs_swapping = !is_little_endian_cpu();
+  I8 is_compressed = compress;
   write_value(stream, is_compressed, needs_swapping);
   write_meta(stream, mesh, needs_swapping);
   LO nverts = mesh->nverts();
   write_value(stream, nverts, needs_swapping);
   for (Int d = 1; d <= mesh->dim(); ++d) {
     auto down = mesh->ask_down(d, d - 1);
-    write_array(stream, down.ab2b, is_compressed, needs_swapping);
+    snapshot_array(stream, down.ab2b, &snapshot);
     if (d > 1) {
-      write_array(stream, down.codes, is_compressed, needs_swapping);
+      snapshot_array(stream, down.codes, &snapshot);
     }
   }
   for (Int d = 0; d <= mesh->dim(); ++d) {
     auto nsaved_tags = mesh->ntags(d);
     write_value(stream, nsaved_tags, needs_swapping);
     for (Int i = 0; i < mesh->ntags(d); ++i) {
-      write_tag(stream, mesh->get_tag(d, i), is_compressed, needs_swapping);
+      snapshot_tag(stream, mesh->get_tag(d, i), &snapshot);
     }
     if (mesh->comm()->size() > 1) {
       auto owners = mesh->ask_owners(d);
-      write_array(stream, owners.ranks, is_compressed, needs_swapping);
-      write_array(stream, owners.idxs, is_compressed, needs_swapping);
+      snapshot_array(stream, owners.ranks, &snapshot);
+      snapshot_array(stream, owners.idxs, &snapshot);
     }
   }
   write_sets(stream, mesh, needs_swapping);
@@ -399,10 +610,28 @@ void write(std::ostream& stream, Mesh* mesh) {
   if (has_parents) {
     for (Int d = 0; d <= mesh->dim(); ++d) {
       auto parents = mesh->ask_parents(d);
-      write_array(stream, parents.parent_idx, is_compressed, needs_swapping);
-      write_array(stream, parents.codes, is_compressed, needs_swapping);
+      snapshot_array(stream, parents.parent_idx, &snapshot);
+      snapshot_array(stream, parents.codes, &snapshot);
     }
   }
+  snapshot.suffix = stream.str();
+  end_code();
+  return snapshot;
+}
+
+/* may be called from any thread */
+static void write_snapshot(std::ostream& stream, MeshSnapshot const& snapshot) {
+  for (auto& array : snapshot.arrays) {
+    stream.write(array.prefix.data(), std::streamsize(array.prefix.size()));
+    write_array_data(stream, array.data, array.nbytes, array.item_size,
+        snapshot.is_compressed, snapshot.needs_swapping, snapshot.codec);
+  }
+  stream.write(snapshot.suffix.data(), std::streamsize(snapshot.suffix.size()));
+}
+
+void write(std::ostream& stream, Mesh* mesh, bool compress, Codec codec) {
+  begin_code("binary::write(stream,Mesh)");
+  write_snapshot(stream, snapshot_mesh(mesh, compress, codec));
   end_code();
 }
 
@@ -427,9 +656,9 @@ void read(std::istream& stream, Mesh* mesh, I32 version) {
   mesh->set_verts(nverts);
   for (Int d = 1; d <= mesh->dim(); ++d) {
     Adj down;
-    read_array(stream, down.ab2b, is_compressed, needs_swapping);
+    read_array(stream, down.ab2b, is_compressed, needs_swapping, version);
     if (d > 1) {
-      read_array(stream, down.codes, is_compressed, needs_swapping);
+      read_array(stream, down.codes, is_compressed, needs_swapping, version);
     }
     mesh->set_ents(d, down);
   }
@@ -441,8 +670,8 @@ void read(std::istream& stream, Mesh* mesh, I32 version) {
     }
     if (mesh->comm()->size() > 1) {
       Remotes owners;
-      read_array(stream, owners.ranks, is_compressed, needs_swapping);
-      read_array(stream, owners.idxs, is_compressed, needs_swapping);
+      read_array(stream, owners.ranks, is_compressed, needs_swapping, version);
+      read_array(stream, owners.idxs, is_compressed, needs_swapping, version);
       mesh->set_owners(d, owners);
     }
   }
@@ -455,8 +684,10 @@ void read(std::istream& stream, Mesh* mesh, I32 version) {
     if (has_parents) {
       for (Int d = 0; d <= mesh->dim(); ++d) {
         Parents parents;
-        read_array(stream, parents.parent_idx, is_compressed, needs_swapping);
-        read_array(stream, parents.codes, is_compressed, needs_swapping);
+        read_array(stream, parents.parent_idx, is_compressed, needs_swapping,
+            version);
+        read_array(stream, parents.codes, is_compressed, needs_swapping,
+            version);
         mesh->set_parents(d, parents);
       }
     }
@@ -515,8 +746,9 @@ I32 read_version(filesystem::path const& path, CommPtr comm) {
   return version;
 }
 
-void write(filesystem::path const& path, Mesh* mesh) {
-  begin_code("binary::write(path,Mesh)");
+/* creates the directory and returns the path of this rank's part */
+static filesystem::path start_writing(
+    filesystem::path const& path, Mesh* mesh) {
   if (path.extension().string() != ".osh" && can_print(mesh)) {
     std::cout
         << "it is strongly recommended to end Omega_h paths in \".osh\",\n";
@@ -527,15 +759,146 @@ void write(filesystem::path const& path, Mesh* mesh) {
   auto filepath = path;
   filepath /= std::to_string(mesh->comm()->rank());
   filepath += ".osh";
-  std::ofstream file(filepath.c_str());
-  OMEGA_H_CHECK(file.is_open());
-  write(file, mesh);
+  return filepath;
+}
+
+/* may be called from any thread */
+static void write_part(
+    filesystem::path const& filepath, MeshSnapshot const& snapshot) {
+  /* arrays read from an older version of this file may still be
+     mapped into memory, so the old file is replaced rather than
+     being overwritten in place */
+  auto tmppath = filepath;
+  tmppath += ".tmp";
+  {
+    std::ofstream file(tmppath.c_str(), std::ios::binary);
+    OMEGA_H_CHECK(file.is_open());
+    write_snapshot(file, snapshot);
+  }
+#ifdef _MSC_VER
+  filesystem::remove(filepath);
+#endif
+  if (std::rename(tmppath.c_str(), filepath.c_str()) != 0) {
+    Omega_h_fail("could not rename \"%s\" to \"%s\": %s\n", tmppath.c_str(),
+        filepath.c_str(), std::strerror(errno));
+  }
+}
+
+void write(filesystem::path const& path, Mesh* mesh, bool compress,
+    Codec codec) {
+  begin_code("binary::write(path,Mesh)");
+  auto const filepath = start_writing(path, mesh);
+  write_part(filepath, snapshot_mesh(mesh, compress, codec));
   write_nparts(path, mesh);
   write_version(path, mesh);
   mesh->comm()->barrier();
   end_code();
 }
 
+struct AsyncWriter::Job {
+  filesystem::path filepath;
+  MeshSnapshot snapshot;
+  bool done;
+  std::exception_ptr error;
+};
+
+AsyncWriter::AsyncWriter(std::size_t max_pending)
+    : max_pending_(max_pending), stopping_(false) {
+  OMEGA_H_CHECK(max_pending_ >= 1);
+  thread_ = std::thread([this]() { this->run(); });
+}
+
+AsyncWriter::~AsyncWriter() {
+  /* a destructor may not throw, so failures nobody waited for are
+     dropped. the thread still finishes every queued job */
+  try {
+    wait();
+  } catch (...) {
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  thread_.join();
+}
+
+/* the background thread only sees jobs through (queued_),
+   and the calling thread only destroys them (and the arrays
+   they hold) once they are done */
+void AsyncWriter::run() {
+  while (true) {
+    Job* job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return stopping_ || !queued_.empty(); });
+      if (queued_.empty()) return;
+      job = queued_.front();
+      queued_.pop_front();
+    }
+    std::exception_ptr error;
+    try {
+      write_part(job->filepath, job->snapshot);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      job->error = error;
+      job->done = true;
+    }
+    condition_.notify_all();
+  }
+}
+
+/* forgets the oldest jobs until (max_remaining) remain,
+   waiting for them to be done as needed.
+   the first failure among the forgotten jobs is rethrown */
+void AsyncWriter::retire(std::size_t max_remaining) {
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (pending_.size() > max_remaining) {
+      auto const job = pending_.front().get();
+      condition_.wait(lock, [job]() { return job->done; });
+      if (!error) error = job->error;
+      pending_.pop_front();
+    }
+    while (!pending_.empty() && pending_.front()->done) {
+      if (!error) error = pending_.front()->error;
+      pending_.pop_front();
+    }
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+void AsyncWriter::write(filesystem::path const& path, Mesh* mesh,
+    bool compress, Codec codec) {
+  begin_code("binary::AsyncWriter::write");
+  auto const filepath = start_writing(path, mesh);
+  retire(max_pending_ - 1);
+  auto job = std::make_shared<Job>();
+  job->filepath = filepath;
+  job->snapshot = snapshot_mesh(mesh, compress, codec);
+  job->done = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back(job);
+    queued_.push_back(job.get());
+  }
+  condition_.notify_all();
+  write_nparts(path, mesh);
+  write_version(path, mesh);
+  end_code();
+}
+
+bool AsyncWriter::completed() {
+  retire(pending_.size());
+  return pending_.empty();
+}
+
+void AsyncWriter::wait() { retire(0); }
+
 void read_in_comm(
     filesystem::path const& path, CommPtr comm, Mesh* mesh, I32 version) {
   ScopedTimer timer("binary::read_in_comm(path, comm, mesh, version)");
@@ -543,6 +906,13 @@ void read_in_comm(
   auto filepath = path;
   filepath /= std::to_string(mesh->comm()->rank());
   if (version != -1) filepath += ".osh";
+  auto const mapped = map_file(filepath);
+  if (mapped) {
+    MappedFileBuf buf(mapped);
+    std::istream stream(&buf);
+    read(stream, mesh, version);
+    return;
+  }
   std::ifstream file(filepath.c_str(), std::ios::binary);
   OMEGA_H_CHECK(file.is_open());
   read(file, mesh, version);
@@ -594,9 +964,10 @@ Mesh read(filesystem::path const& path, CommPtr comm, bool strict) {
   template Read<T> swap_bytes(Read<T> array, bool is_little_endian);           \
   template void write_value(std::ostream& stream, T val, bool);                \
   template void read_value(std::istream& stream, T& val, bool);                \
-  template void write_array(std::ostream& stream, Read<T> array, bool, bool);  \
-  template void read_array(                                                    \
-      std::istream& stream, Read<T>& array, bool is_compressed, bool);
+  template void write_array(                                                   \
+      std::ostream& stream, Read<T> array, bool, bool, Codec);                 \
+  template void read_array(std::istream& stream, Read<T>& array,             \
+      bool is_compressed, bool, I32);
 OMEGA_H_INST(I8)
 OMEGA_H_INST(I32)
 OMEGA_H_INST(I64)
@@ -645,6 +1016,8 @@ OMEGA_H_DLL Mesh read_mesh_file(filesystem::path const& path, CommPtr comm) {
   auto const extension = path.extension().string();
   if (extension == ".osh") {
     return binary::read(path, comm);
+  } else if (extension == ".oshs") {
+    return binary::read_shared(path, comm);
   } else if (extension == ".meshb") {
 #ifdef OMEGA_H_USE_LIBMESHB
     Mesh mesh(comm->library());
@@ -1,12 +1,18 @@
 #ifndef OMEGA_H_FILE_HPP
 #define OMEGA_H_FILE_HPP
 
+#include <condition_variable>
+#include <deque>
 #include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include <Omega_h_config.h>
 #include <Omega_h_array.hpp>
 #include <Omega_h_comm.hpp>
+#include <Omega_h_compress.hpp>
 #include <Omega_h_defines.hpp>
 #include <Omega_h_filesystem.hpp>
 #include <Omega_h_mesh.hpp>
@@ -90,15 +96,18 @@ static constexpr bool dont_compress = false;
 #endif
 TagSet get_all_vtk_tags(Mesh* mesh, Int cell_dim);
 void write_vtu(std::ostream& stream, Mesh* mesh, Int cell_dim,
-    TagSet const& tags, bool compress = OMEGA_H_DEFAULT_COMPRESS);
+    TagSet const& tags, bool compress = OMEGA_H_DEFAULT_COMPRESS,
+    Codec codec = CODEC_ZLIB);
 void write_vtu(filesystem::path const& filename, Mesh* mesh, Int cell_dim,
-    TagSet const& tags, bool compress = OMEGA_H_DEFAULT_COMPRESS);
+    TagSet const& tags, bool compress = OMEGA_H_DEFAULT_COMPRESS,
+    Codec codec = CODEC_ZLIB);
 void write_vtu(std::string const& filename, Mesh* mesh, Int cell_dim,
     bool compress = OMEGA_H_DEFAULT_COMPRESS);
 void write_vtu(std::string const& filename, Mesh* mesh,
     bool compress = OMEGA_H_DEFAULT_COMPRESS);
 void write_parallel(filesystem::path const& path, Mesh* mesh, Int cell_dim,
-    TagSet const& tags, bool compress = OMEGA_H_DEFAULT_COMPRESS);
+    TagSet const& tags, bool compress = OMEGA_H_DEFAULT_COMPRESS,
+    Codec codec = CODEC_ZLIB);
 void write_parallel(std::string const& path, Mesh* mesh, Int cell_dim,
     bool compress = OMEGA_H_DEFAULT_COMPRESS);
 void write_parallel(std::string const& path, Mesh* mesh,
@@ -112,6 +121,7 @@ class Writer {
   filesystem::path root_path_;
   Int cell_dim_;
   bool compress_;
+  Codec codec_;
   I64 step_;
   std::streampos pvd_pos_;
 
@@ -121,7 +131,8 @@ class Writer {
   Writer& operator=(Writer const&) = default;
   ~Writer() = default;
   Writer(filesystem::path const& root_path, Mesh* mesh, Int cell_dim = -1,
-      Real restart_time = 0.0, bool compress = OMEGA_H_DEFAULT_COMPRESS);
+      Real restart_time = 0.0, bool compress = OMEGA_H_DEFAULT_COMPRESS,
+      Codec codec = CODEC_ZLIB);
   void write();
   void write(Real time);
   void write(Real time, TagSet const& tags);
@@ -133,7 +144,8 @@ class FullWriter {
  public:
   FullWriter() = default;
   FullWriter(filesystem::path const& root_path, Mesh* mesh,
-      Real restart_time = 0.0, bool compress = OMEGA_H_DEFAULT_COMPRESS);
+      Real restart_time = 0.0, bool compress = OMEGA_H_DEFAULT_COMPRESS,
+      Codec codec = CODEC_ZLIB);
   void write(Real time);
   void write();
 };
@@ -141,7 +153,14 @@ class FullWriter {
 
 namespace binary {
 
-void write(filesystem::path const& path, Mesh* mesh);
+/* uncompressed files (since version 10) keep their arrays aligned,
+   so that reading them maps the file into memory and uses the
+   arrays in place; pages of arrays that are never accessed are
+   never read from disk.
+   compressed files (since version 11) split each array into blocks
+   that are compressed and decompressed in parallel with (codec) */
+void write(filesystem::path const& path, Mesh* mesh,
+    bool compress = OMEGA_H_DEFAULT_COMPRESS, Codec codec = CODEC_ZLIB);
 Mesh read(filesystem::path const& path, Library* lib, bool strict = false);
 Mesh read(filesystem::path const& path, CommPtr comm, bool strict = false);
 I32 read(filesystem::path const& path, CommPtr comm, Mesh* mesh,
@@ -151,7 +170,54 @@ I32 read_version(filesystem::path const& path, CommPtr comm);
 void read_in_comm(
     filesystem::path const& path, CommPtr comm, Mesh* mesh, I32 version);
 
-constexpr I32 latest_version = 9;
+constexpr I32 latest_version = 11;
+
+/* writes the whole mesh as one uncompressed file through MPI-IO,
+   each rank writing the rows of the entities it owns at offsets
+   given by an exscan of the owned counts.
+   read_shared() loads such a file onto any number of ranks by
+   reading contiguous slices of elements and vertices and
+   redistributing them, like exodus::read_sliced().
+   by convention these files have the ".oshs" extension */
+void write_shared(filesystem::path const& path, Mesh* mesh);
+Mesh read_shared(filesystem::path const& path, CommPtr comm);
+
+/* writes .osh files on a background thread.
+   write() only waits while the mesh's arrays are referenced
+   (and copied to the host if they live on a device), and the
+   byte swapping, compression and file writing happen later.
+   at most (max_pending) files may be unfinished, beyond that
+   write() waits for the oldest one.
+   completed() and wait() only concern the part file of this rank;
+   call wait() and then barrier the communicator before reading
+   the files back.
+   if writing a file fails on the background thread, the exception
+   is rethrown by the next write(), completed() or wait() call that
+   finds the file done. this requires Omega_h_THROW; otherwise
+   the failure aborts as usual. */
+class AsyncWriter {
+ public:
+  AsyncWriter(std::size_t max_pending = 2);
+  ~AsyncWriter();
+  AsyncWriter(AsyncWriter const&) = delete;
+  AsyncWriter& operator=(AsyncWriter const&) = delete;
+  void write(filesystem::path const& path, Mesh* mesh,
+      bool compress = OMEGA_H_DEFAULT_COMPRESS, Codec codec = CODEC_ZLIB);
+  bool completed();
+  void wait();
+
+ private:
+  struct Job;
+  void run();
+  void retire(std::size_t max_remaining);
+  std::size_t max_pending_;
+  bool stopping_;
+  std::deque<std::shared_ptr<Job>> pending_;
+  std::deque<Job*> queued_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::thread thread_;
+};
 
 template <typename T>
 void swap_bytes(T&);
@@ -165,26 +231,30 @@ template <typename T>
 void read_value(std::istream& stream, T& val, bool needs_swapping);
 template <typename T>
 void write_array(std::ostream& stream, Read<T> array, bool is_compressed,
-    bool needs_swapping);
+    bool needs_swapping, Codec codec = CODEC_ZLIB);
 template <typename T>
 void read_array(std::istream& stream, Read<T>& array, bool is_compressed,
-    bool needs_swapping);
+    bool needs_swapping, I32 version = latest_version);
 
 void write(std::ostream& stream, std::string const& val, bool needs_swapping);
 void read(std::istream& stream, std::string& val, bool needs_swapping);
 
-void write(std::ostream& stream, Mesh* mesh);
+void write(std::ostream& stream, Mesh* mesh,
+    bool compress = OMEGA_H_DEFAULT_COMPRESS, Codec codec = CODEC_ZLIB);
 void read(std::istream& stream, Mesh* mesh, I32 version);
 
+void write_sets(std::ostream& stream, Mesh* mesh, bool needs_swapping);
+void read_sets(std::istream& stream, Mesh* mesh, bool needs_swapping);
+
 #define INST_DECL(T)                                                           \
   extern template void swap_bytes(T&);                                         \
   extern template Read<T> swap_bytes(Read<T> array, bool needs_swapping);      \
   extern template void write_value(std::ostream& stream, T val, bool);         \
   extern template void read_value(std::istream& stream, T& val, bool);         \
   extern template void write_array(                                            \
-      std::ostream& stream, Read<T> array, bool, bool);                        \
+      std::ostream& stream, Read<T> array, bool, bool, Codec);                 \
   extern template void read_array(                                             \
-      std::istream& stream, Read<T>& array, bool, bool);
+      std::istream& stream, Read<T>& array, bool, bool, I32);
 INST_DECL(I8)
 INST_DECL(I32)
 INST_DECL(I64)
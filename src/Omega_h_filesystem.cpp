@@ -2,6 +2,7 @@
 #include <Omega_h_filesystem.hpp>
 #include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 
@@ -43,6 +44,15 @@ path current_path() {
   return std::string(buf);
 }
 
+path temp_directory_path() {
+  char buf[MAX_PATH + 1];
+  DWORD ret = ::GetTempPathA(sizeof(buf), buf);
+  if (ret == 0) {
+    throw filesystem_error(GetLastError(), "temp_directory_path");
+  }
+  return std::string(buf);
+}
+
 bool remove(path const& p) {
   BOOL success = ::DeleteFile(p.impl.c_str());
   if (!success) {
@@ -149,6 +159,14 @@ path current_path() {
   return ret;
 }
 
+path temp_directory_path() {
+  for (auto name : {"TMPDIR", "TMP", "TEMP", "TEMPDIR"}) {
+    auto value = std::getenv(name);
+    if (value) return value;
+  }
+  return "/tmp";
+}
+
 bool remove(path const& p) {
   errno = 0;
   int err = ::remove(p.impl.c_str());
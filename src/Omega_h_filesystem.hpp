@@ -55,6 +55,8 @@ std::ostream& operator<<(std::ostream& os, path const& p);
 
 bool create_directory(path const& p);
 path current_path();
+/* the directory for temporary files, from TMPDIR and the like */
+path temp_directory_path();
 bool remove(path const& p);
 std::uintmax_t remove_all(path const& p);
 bool exists(path const& p);
@@ -1,9 +1,15 @@
 #include "Omega_h_ghost.hpp"
 
+#include <iostream>
+
+#include "Omega_h_array_ops.hpp"
+#include "Omega_h_element.hpp"
 #include "Omega_h_for.hpp"
+#include "Omega_h_int_scan.hpp"
 #include "Omega_h_map.hpp"
 #include "Omega_h_mesh.hpp"
 #include "Omega_h_migrate.hpp"
+#include "Omega_h_sort.hpp"
 
 namespace Omega_h {
 
@@ -99,9 +105,305 @@ static Dist close_down(Mesh* mesh, Remotes old_use_owners, Dist elems2owners) {
   return verts2owners;
 }
 
+/* like get_own_verts2own_elems(), but only the elements of the
+ * marked vertices are sent to their owners
+ */
+static RemoteGraph get_marked_own_verts2own_elems(
+    Mesh* mesh, Read<I8> verts_are_marked) {
+  auto verts2elems = mesh->ask_up(VERT, mesh->dim());
+  auto nverts = mesh->nverts();
+  auto uses2verts = invert_fan(verts2elems.a2ab);
+  auto uses_are_marked = unmap(uses2verts, verts_are_marked, 1);
+  auto marked2uses = collect_marked(uses_are_marked);
+  auto marked2elems = unmap(marked2uses, verts2elems.ab2b, 1);
+  auto marked2own_elems = unmap(marked2elems, mesh->ask_owners(mesh->dim()));
+  auto marked2verts = unmap(marked2uses, uses2verts, 1);
+  auto marked2own_verts = unmap(marked2verts, mesh->ask_owners(VERT));
+  Dist marked2own_verts_dist(mesh->comm(), marked2own_verts, nverts);
+  auto serv_uses2own_elems = marked2own_verts_dist.exch(marked2own_elems, 1);
+  auto own_verts2serv_uses = marked2own_verts_dist.invert().roots2items();
+  return {own_verts2serv_uses, serv_uses2own_elems};
+}
+
+/* the elements a rank needs are those adjacent to its vertices.
+ * around a vertex that gained no elements, those are the ghosts
+ * it had before which have not been removed, so only the elements
+ * around the other vertices are pushed by the vertex owners.
+ * returns the copies of the non-local ones, sorted by global number.
+ */
+static Dist get_new_ghosts2owners(Mesh* mesh, GhostHistory const& history) {
+  auto comm = mesh->comm();
+  auto rank = comm->rank();
+  auto dim = mesh->dim();
+  auto nverts_per_elem = dim + 1;
+  auto ghost_verts2verts = history.ghost_verts2verts;
+  auto nold_ghosts = history.ghosts2old_owners.ranks.size();
+  Write<I8> old_ghosts_touch(nold_ghosts);
+  auto f = OMEGA_H_LAMBDA(LO g) {
+    I8 touches = 0;
+    for (Int i = 0; i < nverts_per_elem; ++i) {
+      if (ghost_verts2verts[g * nverts_per_elem + i] >= 0) touches = 1;
+    }
+    old_ghosts_touch[g] = touches;
+  };
+  parallel_for(nold_ghosts, f, "old_ghosts_touch");
+  auto cands2old_ghosts = collect_marked(read(old_ghosts_touch));
+  auto cands2old_owners = unmap(cands2old_ghosts, history.ghosts2old_owners);
+  Dist cands2old_elems(comm, cands2old_owners, history.nold_elems);
+  auto cands2idxs = cands2old_elems.invert().exch(history.old_elems2elems, 1);
+  auto kept2cands = collect_marked(each_geq_to(cands2idxs, LO(0)));
+  auto kept2ranks = read(unmap(kept2cands, cands2old_owners.ranks, 1));
+  auto kept2idxs = LOs(unmap(kept2cands, cands2idxs, 1));
+  auto verts_gained_elems = mesh->reduce_array(
+      VERT, history.verts_gained_elems, 1, OMEGA_H_MAX);
+  verts_gained_elems = mesh->sync_array(VERT, verts_gained_elems, 1);
+  auto pushed = push_elem_uses(
+      get_marked_own_verts2own_elems(mesh, verts_gained_elems),
+      mesh->ask_dist(VERT).invert());
+  auto nkept = kept2ranks.size();
+  auto nuses = nkept + pushed.ranks.size();
+  Write<I32> use_ranks(nuses);
+  Write<LO> use_idxs(nuses);
+  map_into_range(kept2ranks, 0, nkept, use_ranks, 1);
+  map_into_range(kept2idxs, 0, nkept, use_idxs, 1);
+  map_into_range(pushed.ranks, nkept, nuses, use_ranks, 1);
+  map_into_range(pushed.idxs, nkept, nuses, use_idxs, 1);
+  auto ghost_uses = collect_marked(each_neq_to(read(use_ranks), rank));
+  auto ghost_use_owners =
+      unmap(ghost_uses, Remotes(read(use_ranks), LOs(use_idxs)));
+  Dist uses2owners(comm, ghost_use_owners, mesh->nelems());
+  return get_new_copies2old_owners(uses2owners, mesh->globals(dim));
+}
+
+/* the number of entries of the ascending (a) of size (n) below (v) */
+OMEGA_H_INLINE LO count_globals_below(GOs const& a, LO n, GO v) {
+  LO l = 0;
+  LO r = n;
+  while (l < r) {
+    auto m = (l + r) / 2;
+    if (a[m] < v) {
+      l = m + 1;
+    } else {
+      r = m;
+    }
+  }
+  return l;
+}
+
+/* the entities of both ascending (a) and (b), which have no global
+ * number in common, are numbered in ascending order of the union.
+ * returns the new numbers of those of (a).
+ */
+static LOs merge_globals(GOs a, GOs b) {
+  auto na = a.size();
+  auto nb = b.size();
+  Write<LO> a2new(na);
+  auto f = OMEGA_H_LAMBDA(LO i) {
+    a2new[i] = i + count_globals_below(b, nb, a[i]);
+  };
+  parallel_for(na, f, "merge_globals");
+  return a2new;
+}
+
+template <typename T>
+static void append_ghost_tag(Mesh* new_mesh, Int ent_dim, TagBase const* tag,
+    Dist owners2ghosts, LOs locals2new, LOs ghosts2new) {
+  auto ncomps = tag->ncomps();
+  auto array = as<T>(tag)->array();
+  Write<T> new_array((locals2new.size() + ghosts2new.size()) * ncomps);
+  map_into(array, locals2new, new_array, ncomps);
+  map_into(owners2ghosts.exch(array, ncomps), ghosts2new, new_array, ncomps);
+  new_mesh->add_tag<T>(ent_dim, tag->name(), ncomps, read(new_array), true);
+}
+
+/* the entities of an element-based mesh stay as they are, and the
+ * copies of the (elems2owners) elements and the missing entities
+ * in their closure are fetched from their owners. both are merged
+ * by global number, which is the order migrate_mesh() gives.
+ * besides the ghost entities, only the new indices of the entities
+ * shared with other ranks travel.
+ */
+static void append_ghosts(Mesh* mesh, Dist elems2owners) {
+  OMEGA_H_TIME_FUNCTION;
+  auto comm = mesh->comm();
+  auto rank = comm->rank();
+  auto dim = mesh->dim();
+  std::vector<Dist> ghosts2owners(dim + 1);
+  std::vector<GOs> ghost_globals(dim + 1);
+  std::vector<LOs> ghost_uses2lows(dim + 1);
+  std::vector<Read<I8>> ghost_codes(dim + 1);
+  ghosts2owners[dim] = elems2owners;
+  ghost_globals[dim] = elems2owners.invert().exch(mesh->globals(dim), 1);
+  for (Int d = dim; d > VERT; --d) {
+    auto owners2ghosts = ghosts2owners[d].invert();
+    auto deg = element_degree(mesh->family(), d, d - 1);
+    auto down = mesh->ask_down(d, d - 1);
+    auto use_owners =
+        owners2ghosts.exch(form_down_use_owners(mesh, d, d - 1), deg);
+    auto low_globals = mesh->globals(d - 1);
+    auto use_globals =
+        owners2ghosts.exch(GOs(unmap(down.ab2b, low_globals, 1)), deg);
+    if (down.codes.exists()) {
+      ghost_codes[d] = owners2ghosts.exch(down.codes, deg);
+    }
+    /* a use is of a local entity, or of a ghost one numbered by
+       (-1 - i) until all of them are known */
+    auto nlows = mesh->nents(d - 1);
+    auto nuses = use_globals.size();
+    Write<LO> uses2lows(nuses);
+    Write<I8> uses_are_ghosts(nuses);
+    auto find = OMEGA_H_LAMBDA(LO u) {
+      auto l = count_globals_below(low_globals, nlows, use_globals[u]);
+      auto is_local = (l < nlows && low_globals[l] == use_globals[u]);
+      uses2lows[u] = is_local ? l : -1;
+      uses_are_ghosts[u] = !is_local;
+    };
+    parallel_for(nuses, find, "find_ghost_lows");
+    auto ghost_uses2uses = collect_marked(read(uses_are_ghosts));
+    auto ghost_use_globals = GOs(unmap(ghost_uses2uses, use_globals, 1));
+    auto sorted2ghost_uses = sort_by_keys(ghost_use_globals);
+    auto sorted2uses = LOs(unmap(sorted2ghost_uses, ghost_uses2uses, 1));
+    auto sorted_globals = GOs(unmap(sorted2uses, use_globals, 1));
+    auto nsorted = sorted_globals.size();
+    Write<I8> firsts(nsorted);
+    auto mark_firsts = OMEGA_H_LAMBDA(LO i) {
+      firsts[i] = (i == 0 || sorted_globals[i] != sorted_globals[i - 1]);
+    };
+    parallel_for(nsorted, mark_firsts, "mark_first_ghost_lows");
+    auto sorted2ghost_lows = offset_scan(read(firsts));
+    auto number = OMEGA_H_LAMBDA(LO i) {
+      uses2lows[sorted2uses[i]] = -sorted2ghost_lows[i + 1];
+    };
+    parallel_for(nsorted, number, "number_ghost_lows");
+    auto ghost_lows2sorted = collect_marked(read(firsts));
+    auto ghost_lows2uses = LOs(unmap(ghost_lows2sorted, sorted2uses, 1));
+    ghost_globals[d - 1] = unmap(ghost_lows2sorted, sorted_globals, 1);
+    ghosts2owners[d - 1] =
+        Dist(comm, unmap(ghost_lows2uses, use_owners), nlows);
+    ghost_uses2lows[d] = uses2lows;
+  }
+  std::vector<LOs> locals2new(dim + 1);
+  std::vector<LOs> ghosts2new(dim + 1);
+  for (Int d = 0; d <= dim; ++d) {
+    auto globals = mesh->globals(d);
+    OMEGA_H_CHECK(is_sorted(globals));
+    locals2new[d] = merge_globals(globals, ghost_globals[d]);
+    ghosts2new[d] = merge_globals(ghost_globals[d], globals);
+  }
+  auto new_mesh = mesh->copy_meta();
+  for (Int d = dim; d > VERT; --d) {
+    auto deg = element_degree(mesh->family(), d, d - 1);
+    auto down = mesh->ask_down(d, d - 1);
+    auto nlocals = mesh->nents(d);
+    auto nghosts = ghost_globals[d].size();
+    auto has_codes = down.codes.exists();
+    Write<LO> new_ab2b((nlocals + nghosts) * deg);
+    Write<I8> new_codes;
+    if (has_codes) new_codes = Write<I8>((nlocals + nghosts) * deg);
+    auto ents2new = locals2new[d];
+    auto lows2new = locals2new[d - 1];
+    auto ab2b = down.ab2b;
+    auto local_codes = down.codes;
+    auto f = OMEGA_H_LAMBDA(LO e) {
+      for (Int i = 0; i < deg; ++i) {
+        auto new_use = ents2new[e] * deg + i;
+        new_ab2b[new_use] = lows2new[ab2b[e * deg + i]];
+        if (has_codes) new_codes[new_use] = local_codes[e * deg + i];
+      }
+    };
+    parallel_for(nlocals, f, "append_ghosts_local_conn");
+    auto ghost_ents2new = ghosts2new[d];
+    auto ghost_lows2new = ghosts2new[d - 1];
+    auto uses2lows = ghost_uses2lows[d];
+    auto codes = ghost_codes[d];
+    auto g = OMEGA_H_LAMBDA(LO e) {
+      for (Int i = 0; i < deg; ++i) {
+        auto new_use = ghost_ents2new[e] * deg + i;
+        auto l = uses2lows[e * deg + i];
+        new_ab2b[new_use] = (l >= 0) ? lows2new[l] : ghost_lows2new[-1 - l];
+        if (has_codes) new_codes[new_use] = codes[e * deg + i];
+      }
+    };
+    parallel_for(nghosts, g, "append_ghosts_ghost_conn");
+    if (has_codes) {
+      new_mesh.set_ents(d, Adj(LOs(new_ab2b), Read<I8>(new_codes)));
+    } else {
+      new_mesh.set_ents(d, Adj(LOs(new_ab2b)));
+    }
+  }
+  new_mesh.set_verts(mesh->nverts() + ghost_globals[VERT].size());
+  for (Int d = 0; d <= dim; ++d) {
+    auto owners2ghosts = ghosts2owners[d].invert();
+    auto nnew = new_mesh.nents(d);
+    auto owners = mesh->ask_owners(d);
+    auto old_own_ranks = owners.ranks;
+    auto old_own_idxs = owners.idxs;
+    auto ents2new = locals2new[d];
+    Write<I32> own_ranks(nnew);
+    Write<LO> own_idxs(nnew);
+    auto f = OMEGA_H_LAMBDA(LO e) {
+      own_ranks[ents2new[e]] = old_own_ranks[e];
+      if (old_own_ranks[e] == rank) {
+        own_idxs[ents2new[e]] = ents2new[old_own_idxs[e]];
+      }
+    };
+    parallel_for(mesh->nents(d), f, "append_ghosts_local_owners");
+    auto shared2ents = collect_marked(each_neq_to(owners.ranks, rank));
+    Dist shared2owners(comm, unmap(shared2ents, owners), mesh->nents(d));
+    map_into(shared2owners.invert().exch(ents2new, 1),
+        unmap(shared2ents, ents2new, 1), own_idxs, 1);
+    map_into(ghosts2owners[d].items2ranks(), ghosts2new[d], own_ranks, 1);
+    map_into(owners2ghosts.exch(ents2new, 1), ghosts2new[d], own_idxs, 1);
+    new_mesh.set_owners(d, Remotes(read(own_ranks), LOs(own_idxs)));
+    for (Int i = 0; i < mesh->ntags(d); ++i) {
+      auto tag = mesh->get_tag(d, i);
+      switch (tag->type()) {
+        case OMEGA_H_I8:
+          append_ghost_tag<I8>(
+              &new_mesh, d, tag, owners2ghosts, ents2new, ghosts2new[d]);
+          break;
+        case OMEGA_H_I32:
+          append_ghost_tag<I32>(
+              &new_mesh, d, tag, owners2ghosts, ents2new, ghosts2new[d]);
+          break;
+        case OMEGA_H_I64:
+          append_ghost_tag<I64>(
+              &new_mesh, d, tag, owners2ghosts, ents2new, ghosts2new[d]);
+          break;
+        case OMEGA_H_F64:
+          append_ghost_tag<Real>(
+              &new_mesh, d, tag, owners2ghosts, ents2new, ghosts2new[d]);
+          break;
+      }
+    }
+  }
+  *mesh = new_mesh;
+}
+
+static bool has_ghost_history(Mesh* mesh) {
+  auto history = mesh->ghost_history();
+  auto ok = history && history->old_elems2elems.exists() &&
+            history->verts_gained_elems.size() == mesh->nverts();
+  return mesh->comm()->allreduce(I32(ok), OMEGA_H_MIN) == 1;
+}
+
 void ghost_mesh(Mesh* mesh, Int nlayers, bool verbose) {
   OMEGA_H_CHECK(mesh->nghost_layers() >= 0);
   OMEGA_H_CHECK(nlayers > mesh->nghost_layers());
+  if (nlayers == 1 && mesh->parting() == OMEGA_H_ELEM_BASED &&
+      has_ghost_history(mesh)) {
+    OMEGA_H_TIME_FUNCTION;
+    auto elems2owners = get_new_ghosts2owners(mesh, *mesh->ghost_history());
+    if (verbose) {
+      auto comm = mesh->comm();
+      auto nghosts = comm->allreduce(GO(elems2owners.nitems()), OMEGA_H_SUM);
+      if (comm->rank() == 0) {
+        std::cout << "ghosting by pulling " << nghosts << " elements\n";
+      }
+    }
+    append_ghosts(mesh, elems2owners);
+    return;
+  }
   auto nnew_layers = nlayers - mesh->nghost_layers();
   auto own_verts2own_elems = get_own_verts2own_elems(mesh);
   auto verts2owners = mesh->ask_dist(VERT);
@@ -130,14 +432,138 @@ void partition_by_verts(Mesh* mesh, bool verbose) {
   migrate_mesh(mesh, elems2owners, OMEGA_H_VERT_BASED, verbose);
 }
 
+/* marks the entities of (low_dim) adjacent to marked entities of
+ * (low_dim + 1) using only the local copies
+ */
+static Read<I8> mark_local_closure(
+    Mesh* mesh, Int low_dim, Read<I8> high_marked) {
+  auto hl2l = mesh->ask_down(low_dim + 1, low_dim).ab2b;
+  auto deg = element_degree(mesh->family(), low_dim + 1, low_dim);
+  Write<I8> low_marks(mesh->nents(low_dim), 0);
+  auto f = OMEGA_H_LAMBDA(LO h) {
+    if (!high_marked[h]) return;
+    for (Int hl = 0; hl < deg; ++hl) low_marks[hl2l[h * deg + hl]] = 1;
+  };
+  parallel_for(mesh->nents(low_dim + 1), f, "mark_local_closure");
+  return low_marks;
+}
+
+/* (b2c) applied to the entries of (a2b) that are not -1 */
+static LOs follow_map(LOs a2b, LOs b2c) {
+  Write<LO> a2c(a2b.size());
+  auto f = OMEGA_H_LAMBDA(LO a) {
+    a2c[a] = (a2b[a] == -1) ? -1 : b2c[a2b[a]];
+  };
+  parallel_for(a2b.size(), f, "follow_map");
+  return a2c;
+}
+
+/* what partition_by_elems() keeps of the ghost layer it drops */
+static Mesh::GhostHistoryPtr get_ghost_history(
+    Mesh* mesh, LOs new_elems2old_elems, LOs new_verts2old_verts) {
+  auto dim = mesh->dim();
+  auto history = std::make_shared<GhostHistory>();
+  history->nold_elems = mesh->nelems();
+  history->old_elems2elems =
+      invert_injective_map(new_elems2old_elems, mesh->nelems());
+  auto ghosts2old_elems = collect_marked(invert_marks(mesh->owned(dim)));
+  history->ghosts2old_owners =
+      unmap(ghosts2old_elems, mesh->ask_owners(dim));
+  auto ghost_verts2old_verts =
+      unmap(ghosts2old_elems, mesh->ask_elem_verts(), dim + 1);
+  history->ghost_verts2verts = compound_maps(ghost_verts2old_verts,
+      invert_injective_map(new_verts2old_verts, mesh->nverts()));
+  history->verts_gained_elems = Read<I8>(new_verts2old_verts.size(), 0);
+  return history;
+}
+
+/* the owner of each element always has a copy of it, so going to
+ * element-based partitioning never moves an element: each rank keeps
+ * its owned elements and their closure, with the connectivity
+ * renumbered locally.
+ * only the tags and new owners of the remaining entities are
+ * exchanged with their old owners, which is far cheaper than the
+ * general migrate_mesh() when the mesh was ghosted.
+ */
 void partition_by_elems(Mesh* mesh, bool verbose) {
+  OMEGA_H_TIME_FUNCTION;
   auto dim = mesh->dim();
-  auto all2owners = mesh->ask_owners(dim);
-  auto marked_owned = mesh->owned(dim);
-  auto owned2all = collect_marked(marked_owned);
-  auto owned2owners = unmap(owned2all, all2owners);
-  auto dist = Dist(mesh->comm(), owned2owners, mesh->nelems());
-  migrate_mesh(mesh, dist, OMEGA_H_ELEM_BASED, verbose);
+  auto comm = mesh->comm();
+  auto new_mesh = mesh->copy_meta();
+  auto marks = mesh->owned(dim);
+  if (verbose) {
+    auto nkept = get_sum(comm, marks);
+    auto ncopies = comm->allreduce(GO(mesh->nelems()), OMEGA_H_SUM);
+    if (comm->rank() == 0) {
+      std::cout << "keeping (" << nkept << " owned) / (" << ncopies
+                << " total) elements\n";
+    }
+  }
+  LOs new_ents2old_ents = collect_marked(marks);
+  auto new_elems2old_elems = new_ents2old_ents;
+  for (Int d = dim; d >= VERT; --d) {
+    LOs new_lows2old_lows;
+    if (d > VERT) {
+      auto low_marks = mark_local_closure(mesh, d - 1, marks);
+      new_lows2old_lows = collect_marked(low_marks);
+      auto old_lows2new_lows =
+          invert_injective_map(new_lows2old_lows, mesh->nents(d - 1));
+      auto deg = element_degree(mesh->family(), d, d - 1);
+      auto old_down = mesh->ask_down(d, d - 1);
+      Adj new_down;
+      new_down.ab2b = unmap(
+          unmap(new_ents2old_ents, old_down.ab2b, deg), old_lows2new_lows, 1);
+      if (old_down.codes.exists()) {
+        new_down.codes = unmap(new_ents2old_ents, old_down.codes, deg);
+      }
+      new_mesh.set_ents(d, new_down);
+      marks = low_marks;
+    } else {
+      new_mesh.set_verts(new_ents2old_ents.size());
+    }
+    auto new_ents2old_owners = unmap(new_ents2old_ents, mesh->ask_owners(d));
+    Dist new_ents2old_owners_dist(comm, new_ents2old_owners, mesh->nents(d));
+    auto old_owners2new_ents = new_ents2old_owners_dist.invert();
+    push_ents(mesh, &new_mesh, d, new_ents2old_owners_dist,
+        old_owners2new_ents, OMEGA_H_ELEM_BASED);
+    if (d == VERT && mesh->parting() == OMEGA_H_GHOSTED &&
+        mesh->nghost_layers() == 1) {
+      new_mesh.set_ghost_history(
+          get_ghost_history(mesh, new_elems2old_elems, new_ents2old_ents));
+    }
+    new_ents2old_ents = new_lows2old_lows;
+  }
+  *mesh = new_mesh;
+}
+
+void modify_ghost_history(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
+    LOs old_ents2new_ents, LOs prods2new_ents, LOs prod_verts2verts) {
+  auto old_history = old_mesh->ghost_history();
+  if (!old_history) return;
+  if (ent_dim == VERT) {
+    auto history = std::make_shared<GhostHistory>(*old_history);
+    history->old_elems2elems = LOs();
+    history->ghost_verts2verts =
+        follow_map(old_history->ghost_verts2verts, old_ents2new_ents);
+    auto old_gained = old_history->verts_gained_elems;
+    Write<I8> gained(new_mesh->nverts(), 0);
+    auto f = OMEGA_H_LAMBDA(LO v) {
+      auto new_v = old_ents2new_ents[v];
+      if (new_v != -1) gained[new_v] = old_gained[v];
+    };
+    parallel_for(old_ents2new_ents.size(), f, "carry_verts_gained_elems");
+    map_value_into(I8(1), prods2new_ents, gained);
+    history->verts_gained_elems = gained;
+    new_mesh->set_ghost_history(history);
+  } else if (ent_dim == old_mesh->dim() && new_mesh->ghost_history()) {
+    auto history = std::make_shared<GhostHistory>(*new_mesh->ghost_history());
+    history->old_elems2elems =
+        follow_map(old_history->old_elems2elems, old_ents2new_ents);
+    auto gained = deep_copy(history->verts_gained_elems);
+    map_value_into(I8(1), prod_verts2verts, gained);
+    history->verts_gained_elems = gained;
+    new_mesh->set_ghost_history(history);
+  }
 }
 
 }  // end namespace Omega_h
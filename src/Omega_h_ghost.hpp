@@ -24,7 +24,32 @@ void get_own_verts2own_elem_uses(
     Mesh* mesh, Remotes& serv_uses2own_elems, LOs& own_verts2serv_uses);
 Remotes push_elem_uses(RemoteGraph own_verts2own_elems, Dist own_verts2verts);
 
+/* what going element-based from a mesh ghosted by one layer leaves
+ * behind for ghosting it again, kept up to date across modify_ents().
+ */
+struct GhostHistory {
+  /* the number of elements when ghosted, and the current index of
+     those that were owned, or -1 if they have been removed since */
+  LO nold_elems;
+  LOs old_elems2elems;
+  /* the owners of the other (ghost) elements in that numbering, and
+     their vertices as current vertices, or -1 if not kept here */
+  Remotes ghosts2old_owners;
+  LOs ghost_verts2verts;
+  /* the vertices adjacent to elements created here since */
+  Read<I8> verts_gained_elems;
+};
+
+/* ghosting one layer from an element-based mesh which has a complete
+ * ghost history only pushes the elements around vertices that gained
+ * new elements, keeping the other ghosts, and fetches the ghost
+ * entities from their owners without moving the local ones.
+ */
 void ghost_mesh(Mesh* mesh, Int nlayers, bool verbose);
+/* carries the ghost history of (old_mesh) over to (new_mesh), with
+ * the arguments modify_ents() has for (ent_dim) */
+void modify_ghost_history(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
+    LOs old_ents2new_ents, LOs prods2new_ents, LOs prod_verts2verts);
 void partition_by_verts(Mesh* mesh, bool verbose);
 void partition_by_elems(Mesh* mesh, bool verbose);
 
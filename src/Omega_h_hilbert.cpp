@@ -1,7 +1,13 @@
 #include "Omega_h_hilbert.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include "Omega_h_bbox.hpp"
 #include "Omega_h_for.hpp"
+#include "Omega_h_mesh.hpp"
+#include "Omega_h_profile.hpp"
 #include "Omega_h_sort.hpp"
 
 namespace Omega_h {
@@ -54,6 +60,179 @@ LOs sort_coords(Reals coords, Int dim) {
   return sort_by_keys(keys, dim);
 }
 
+/* the Hilbert distance of each point along a curve over the
+   bounding box of the points on all ranks, with (nbits) bits
+   per axis packed into a single integer */
+template <Int dim>
+static Read<I64> keys_from_coords_dim(CommPtr comm, Reals coords, Int nbits) {
+  auto bbox = find_bounding_box<dim>(coords);
+  for (Int i = 0; i < dim; ++i) {
+    bbox.min[i] = comm->allreduce(bbox.min[i], OMEGA_H_MIN);
+    bbox.max[i] = comm->allreduce(bbox.max[i], OMEGA_H_MAX);
+  }
+  bbox = make_equilateral(bbox);
+  /* a single point still needs a box with some extent */
+  for (Int i = 0; i < dim; ++i) {
+    if (!(bbox.max[i] > bbox.min[i])) bbox.max[i] = bbox.min[i] + 1.0;
+  }
+  auto unit_affine = get_affine_from_bbox_into_unit(bbox);
+  auto npts = divide_no_remainder(coords.size(), dim);
+  Write<I64> out(npts);
+  auto f = OMEGA_H_LAMBDA(LO i) {
+    auto spatial_coord = get_vector<dim>(coords, i);
+    auto hilbert_coord =
+        hilbert::from_spatial(unit_affine, nbits, spatial_coord);
+    hilbert::coord_t key = 0;
+    for (Int j = 0; j < dim; ++j) key = (key << nbits) | hilbert_coord[j];
+    out[i] = static_cast<I64>(key);
+  };
+  parallel_for(npts, f, "hilbert::keys_from_coords");
+  return out;
+}
+
+static Read<I64> keys_from_coords(
+    CommPtr comm, Reals coords, Int dim, Int nbits) {
+  if (dim == 3) return keys_from_coords_dim<3>(comm, coords, nbits);
+  if (dim == 2) return keys_from_coords_dim<2>(comm, coords, nbits);
+  if (dim == 1) return keys_from_coords_dim<1>(comm, coords, nbits);
+  OMEGA_H_NORETURN(Read<I64>());
+}
+
+/* finds each of the (nparts - 1) cuts along the curve: the
+   smallest key such that the elements before it weigh at least
+   the share of the parts before the cut, less half an average
+   element so that elements near the cut go to the side where
+   most of their weight is.
+   each cut is searched for in an interval [lo, hi) of keys,
+   which every round first shrinks to the keys actually in it
+   and then splits into (nsplits) pieces, so the number of
+   elements left in the interval drops by about (nsplits) per
+   round. rounds only reduce small arrays over the ranks. */
+static std::vector<I64> find_cuts(
+    CommPtr comm, Read<I64> keys, Reals masses, Int nparts, I64 end) {
+  constexpr Int nsplits = 16;
+  auto n = keys.size();
+  auto perm = HostRead<LO>(sort_by_keys(keys));
+  auto host_keys = HostRead<I64>(keys);
+  auto host_masses = HostRead<Real>(masses);
+  std::vector<I64> sorted(static_cast<std::size_t>(n));
+  std::vector<Real> weight_below(static_cast<std::size_t>(n) + 1, 0.0);
+  for (LO i = 0; i < n; ++i) {
+    auto const si = std::size_t(i);
+    sorted[si] = host_keys[perm[i]];
+    weight_below[si + 1] = weight_below[si] + host_masses[perm[i]];
+  }
+  auto local_weight_before = [&](I64 key) {
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), key);
+    return weight_below[std::size_t(it - sorted.begin())];
+  };
+  auto total = comm->allreduce(weight_below.back(), OMEGA_H_SUM);
+  auto count = comm->allreduce(GO(n), OMEGA_H_SUM);
+  auto half_mass = total / Real(max2(count, GO(1))) / 2.0;
+  auto const ncuts = std::size_t(nparts - 1);
+  /* the elements before (lo) weigh less than the target and
+     those before (hi) do not */
+  std::vector<Real> targets(ncuts);
+  std::vector<I64> lo(ncuts, 0);
+  std::vector<I64> hi(ncuts, end);
+  for (std::size_t c = 0; c < ncuts; ++c) {
+    targets[c] = total * Real(c + 1) / Real(nparts) - half_mass;
+    if (!(targets[c] > 0.0)) hi[c] = lo[c] + 1;
+  }
+  auto const none = std::numeric_limits<I64>::max();
+  while (true) {
+    HostWrite<I64> host_bounds(static_cast<LO>(ncuts * 2));
+    for (std::size_t c = 0; c < ncuts; ++c) {
+      auto first = std::lower_bound(sorted.begin(), sorted.end(), lo[c]);
+      auto last = std::lower_bound(first, sorted.end(), hi[c]);
+      auto const i = LO(c * 2);
+      host_bounds[i + 0] = (first == last) ? none : *first;
+      host_bounds[i + 1] = (first == last) ? none : -*(last - 1);
+    }
+    auto global_bounds =
+        HostRead<I64>(comm->allreduce(Read<I64>(host_bounds.write()),
+            OMEGA_H_MIN));
+    bool done = true;
+    for (std::size_t c = 0; c < ncuts; ++c) {
+      if (hi[c] - lo[c] <= 1) continue;
+      auto const i = LO(c * 2);
+      if (global_bounds[i] == none) {
+        hi[c] = lo[c] + 1;
+        continue;
+      }
+      lo[c] = global_bounds[i + 0];
+      hi[c] = -global_bounds[i + 1] + 1;
+      if (hi[c] - lo[c] > 1) done = false;
+    }
+    if (done) break;
+    auto const nsamples = ncuts * std::size_t(nsplits - 1);
+    std::vector<I64> samples(nsamples);
+    HostWrite<Real> host_weights(static_cast<LO>(nsamples));
+    for (std::size_t c = 0; c < ncuts; ++c) {
+      auto span = hi[c] - lo[c];
+      for (Int j = 1; j < nsplits; ++j) {
+        auto const k = c * std::size_t(nsplits - 1) + std::size_t(j - 1);
+        samples[k] =
+            lo[c] + (span / nsplits) * j + (span % nsplits) * j / nsplits;
+        host_weights[LO(k)] = local_weight_before(samples[k]);
+      }
+    }
+    auto global_weights = HostRead<Real>(
+        comm->allreduce(Read<Real>(host_weights.write()), OMEGA_H_SUM));
+    for (std::size_t c = 0; c < ncuts; ++c) {
+      if (hi[c] - lo[c] <= 1) continue;
+      for (Int j = 1; j < nsplits; ++j) {
+        auto const k = c * std::size_t(nsplits - 1) + std::size_t(j - 1);
+        if (global_weights[LO(k)] < targets[c]) {
+          lo[c] = samples[k];
+        } else {
+          hi[c] = samples[k];
+          break;
+        }
+      }
+    }
+  }
+  return hi;
+}
+
+Read<I32> partition(Mesh* mesh, Reals masses, Int nparts) {
+  OMEGA_H_TIME_FUNCTION;
+  OMEGA_H_CHECK(masses.size() == mesh->nelems());
+  OMEGA_H_CHECK(nparts >= 1);
+  auto dim = mesh->dim();
+  auto comm = mesh->comm();
+  auto centroids = average_field(mesh, dim, dim, mesh->coords());
+  /* the keys of all axes have to fit in one signed integer */
+  auto nbits = 62 / dim;
+  auto end = I64(1) << (nbits * dim);
+  auto keys = keys_from_coords(comm, centroids, dim, nbits);
+  auto host_cuts = find_cuts(comm, keys, masses, nparts, end);
+  HostWrite<I64> host_cuts_w(LO(host_cuts.size()));
+  for (LO c = 0; c < host_cuts_w.size(); ++c) {
+    host_cuts_w[c] = host_cuts[std::size_t(c)];
+  }
+  auto cuts = Read<I64>(host_cuts_w.write());
+  auto ncuts = cuts.size();
+  Write<I32> parts(keys.size());
+  auto f = OMEGA_H_LAMBDA(LO i) {
+    /* the number of cuts at or before this key */
+    auto key = keys[i];
+    LO first = 0;
+    LO last = ncuts;
+    while (first < last) {
+      auto mid = first + (last - first) / 2;
+      if (cuts[mid] <= key) {
+        first = mid + 1;
+      } else {
+        last = mid;
+      }
+    }
+    parts[i] = first;
+  };
+  parallel_for(keys.size(), f, "hilbert::partition");
+  return parts;
+}
+
 }  // end namespace hilbert
 
 }  // end namespace Omega_h
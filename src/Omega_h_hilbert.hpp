@@ -9,6 +9,8 @@
 
 namespace Omega_h {
 
+class Mesh;
+
 namespace hilbert {
 
 /* The following code is verbatim plus one bug fix from the paper:
@@ -156,6 +158,17 @@ OMEGA_H_INLINE Few<hilbert::coord_t, dim> from_spatial(
    the bounding box of the points */
 LOs sort_coords(Reals coords, Int dim);
 
+/* partitions the elements of (mesh) into (nparts) parts by
+   cutting a Hilbert curve through the element centroids into
+   pieces of nearly equal weight, where (masses) are the element
+   weights. the cuts are found by a parallel search in the
+   space of curve positions, so no elements move until the
+   returned parts are used for migration, and elements that
+   stay in the same place along the curve tend to stay in the
+   same part when the weights change.
+   returns the part of each element */
+Read<I32> partition(Mesh* mesh, Reals masses, Int nparts);
+
 }  // end namespace hilbert
 
 }  // end namespace Omega_h
@@ -7,15 +7,12 @@
 
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_element.hpp"
-#include "Omega_h_mark.hpp"
 #include "Omega_h_mesh.hpp"
 
 namespace Omega_h {
 
-Histogram get_histogram(Mesh* mesh, Int dim, Int nbins, Real min_value,
-    Real max_value, Reals values) {
-  OMEGA_H_CHECK(values.size() == mesh->nents(dim));
-  auto owned_values = mesh->owned_array(dim, values, 1);
+Histogram get_histogram(CommPtr comm, Int nbins, Real min_value,
+    Real max_value, Reals owned_values) {
   auto interval = (max_value - min_value) / Real(nbins);
   Histogram histogram;
   histogram.min = min_value;
@@ -32,11 +29,18 @@ Histogram get_histogram(Mesh* mesh, Int dim, Int nbins, Real min_value,
     else
       ceil_marks = each_lt(owned_values, ceil);
     auto marked = land_each(floor_marks, ceil_marks);
-    histogram.bins[std::size_t(i)] = get_sum(mesh->comm(), marked);
+    histogram.bins[std::size_t(i)] = get_sum(comm, marked);
   }
   return histogram;
 }
 
+Histogram get_histogram(Mesh* mesh, Int dim, Int nbins, Real min_value,
+    Real max_value, Reals values) {
+  OMEGA_H_CHECK(values.size() == mesh->nents(dim));
+  auto owned_values = mesh->owned_array(dim, values, 1);
+  return get_histogram(mesh->comm(), nbins, min_value, max_value, owned_values);
+}
+
 void print_histogram(Histogram const& histogram, std::string const& name) {
   std::ios saved_state(nullptr);
   saved_state.copyfmt(std::cout);
@@ -53,13 +57,14 @@ void print_histogram(Histogram const& histogram, std::string const& name) {
   std::cout.copyfmt(saved_state);
 }
 
-void print_goal_stats(Mesh* mesh, char const* name, Int ent_dim, Reals values,
-    MinMax<Real> desired, MinMax<Real> actual) {
-  auto low_marks = each_lt(values, desired.min);
-  auto high_marks = each_gt(values, desired.max);
-  auto nlow = count_owned_marks(mesh, ent_dim, low_marks);
-  auto nhigh = count_owned_marks(mesh, ent_dim, high_marks);
-  auto ntotal = mesh->nglobal_ents(ent_dim);
+void print_goal_stats(Mesh* mesh, char const* name, Int ent_dim,
+    Reals owned_values, MinMax<Real> desired, MinMax<Real> actual) {
+  auto comm = mesh->comm();
+  auto low_marks = each_lt(owned_values, desired.min);
+  auto high_marks = each_gt(owned_values, desired.max);
+  auto nlow = get_sum(comm, low_marks);
+  auto nhigh = get_sum(comm, high_marks);
+  auto ntotal = comm->allreduce(GO(owned_values.size()), OMEGA_H_SUM);
   auto nmid = ntotal - nlow - nhigh;
   if (mesh->comm()->rank() == 0) {
     auto precision_before = std::cout.precision();
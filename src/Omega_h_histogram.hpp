@@ -16,13 +16,16 @@ struct Histogram {
   std::vector<GO> bins;
 };
 
+Histogram get_histogram(CommPtr comm, Int nbins, Real min_value,
+    Real max_value, Reals owned_values);
 Histogram get_histogram(Mesh* mesh, Int dim, Int nbins, Real min_value,
     Real max_value, Reals values);
 
 void print_histogram(Histogram const& histogram, std::string const& name);
 
-void print_goal_stats(Mesh* mesh, char const* name, Int ent_dim, Reals values,
-    MinMax<Real> desired, MinMax<Real> actual);
+/* (owned_values) are those of the owned entities being reported on */
+void print_goal_stats(Mesh* mesh, char const* name, Int ent_dim,
+    Reals owned_values, MinMax<Real> desired, MinMax<Real> actual);
 
 void render_histogram_matplotlib(
     Histogram const& histogram, std::string const& filepath);
@@ -5,19 +5,27 @@
 #include <Omega_h_for.hpp>
 #include <Omega_h_indset.hpp>
 #include <Omega_h_mesh.hpp>
+#include <Omega_h_profile.hpp>
 
 namespace Omega_h {
 namespace indset {
 
 enum { NOT_IN, IN, UNKNOWN };
 
+/* decides the UNKNOWN entities whose neighborhood allows it.
+   only owned entities are decided, the states of the others
+   come from their owners during synchronization.
+   a stale copy is UNKNOWN where its owner already decided,
+   which can only hold back an owned neighbor, never let it
+   into the set wrongly, so several of these can run between
+   synchronizations. */
 template <class Compare>
-inline Read<I8> local_iteration(
-    LOs xadj, LOs adj, Read<I8> old_state, Compare compare) {
+inline Read<I8> local_iteration(LOs xadj, LOs adj, Read<I8> owned,
+    Read<I8> old_state, Compare compare) {
   auto n = xadj.size() - 1;
   Write<I8> new_state = deep_copy(old_state);
   auto f = OMEGA_H_LAMBDA(LO v) {
-    if (old_state[v] != UNKNOWN) return;
+    if (old_state[v] != UNKNOWN || !owned[v]) return;
     auto begin = xadj[v];
     auto end = xadj[v + 1];
     // nodes adjacent to chosen ones are rejected
@@ -42,14 +50,31 @@ inline Read<I8> local_iteration(
   return new_state;
 }
 
+/* one round: local iterations until no more owned entities
+   can be decided without hearing from the other ranks,
+   then a single neighbor synchronization */
 template <class Compare>
-Read<I8> iteration(Mesh* mesh, Int dim, LOs xadj, LOs adj, Read<I8> old_state,
-    Compare compare) {
-  auto local_state = local_iteration(xadj, adj, old_state, compare);
+Read<I8> iteration(Mesh* mesh, Int dim, LOs xadj, LOs adj, Read<I8> owned,
+    Read<I8> old_state, Compare compare) {
+  auto local_state = old_state;
+  while (true) {
+    ScopedTimer sweep_timer("indset::local_iteration");
+    auto new_state = local_iteration(xadj, adj, owned, local_state, compare);
+    if (new_state == local_state) break;
+    local_state = new_state;
+  }
   auto synced_state = mesh->sync_array(dim, local_state, 1);
   return synced_state;
 }
 
+/* the global termination check for a round's state is a
+   nonblocking reduction. ranks that still have UNKNOWN entities
+   need another round anyway, so they collect it only after that
+   round, and each of their rounds costs only its neighbor
+   synchronization. the other ranks wait for it right away, so no
+   round runs once every rank has decided everything.
+   the number of rounds shows up as the call count of
+   "indset::round" in the profiler. */
 template <class Compare>
 Read<I8> find(Mesh* mesh, Int dim, LOs xadj, LOs adj, Read<I8> candidates,
     Compare compare) {
@@ -64,9 +89,20 @@ Read<I8> find(Mesh* mesh, Int dim, LOs xadj, LOs adj, Read<I8> candidates,
   };
   parallel_for(n, f);
   auto comm = mesh->comm();
+  auto owned = mesh->owned(dim);
   auto state = Read<I8>(initial_state);
-  while (get_max(comm, state) == UNKNOWN) {
-    state = iteration(mesh, dim, xadj, adj, state, compare);
+  auto local_max = get_max(state);
+  auto any_unknown = comm->iallreduce(local_max, OMEGA_H_MAX);
+  while (true) {
+    bool waited = (local_max != UNKNOWN);
+    if (waited && any_unknown.get().last() != UNKNOWN) break;
+    {
+      ScopedTimer round_timer("indset::round");
+      state = iteration(mesh, dim, xadj, adj, owned, state, compare);
+    }
+    if (!waited) any_unknown.get();
+    local_max = get_max(state);
+    any_unknown = comm->iallreduce(local_max, OMEGA_H_MAX);
   }
   return state;
 }
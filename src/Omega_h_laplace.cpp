@@ -2,43 +2,143 @@
 
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 #include "Omega_h_array_ops.hpp"
+#include "Omega_h_for.hpp"
 #include "Omega_h_map.hpp"
 #include "Omega_h_mark.hpp"
 #include "Omega_h_mesh.hpp"
 
 namespace Omega_h {
 
+/* the graph Laplacian of the vertex star in CSR form, with the
+   row of every fixed vertex zeroed: for a free vertex (v),
+   y(v) = deg(v) x(v) - sum over neighbors (u) of x(u) */
+static Reals apply_laplacian(Graph star, Read<I8> is_free, Reals x, Int width) {
+  auto v2vv = star.a2ab;
+  auto vv2v = star.ab2b;
+  auto nverts = is_free.size();
+  Write<Real> y(nverts * width);
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    for (Int j = 0; j < width; ++j) {
+      Real sum = 0.0;
+      if (is_free[v]) {
+        sum = Real(v2vv[v + 1] - v2vv[v]) * x[v * width + j];
+        for (auto vv = v2vv[v]; vv < v2vv[v + 1]; ++vv) {
+          sum -= x[vv2v[vv] * width + j];
+        }
+      }
+      y[v * width + j] = sum;
+    }
+  };
+  parallel_for(nverts, f, "apply_laplacian");
+  return y;
+}
+
+/* y + alpha x, with a separate (alpha) for each component */
+static Reals axpy(
+    std::vector<Real> const& alpha, Reals x, Reals y, Int width) {
+  HostWrite<Real> h_alpha(width);
+  for (Int j = 0; j < width; ++j) h_alpha[j] = alpha[std::size_t(j)];
+  Reals d_alpha(h_alpha.write());
+  Write<Real> out(x.size());
+  auto f = OMEGA_H_LAMBDA(LO i) { out[i] = d_alpha[i % width] * x[i] + y[i]; };
+  parallel_for(x.size(), f, "axpy");
+  return out;
+}
+
+/* the dot products of each component of (as[i]) and (bs[i]) over
+   the vertices weighted by (owned_w), summed over all ranks in a
+   single reduction */
+static std::vector<Real> get_dots(CommPtr comm, Reals owned_w,
+    std::vector<Reals> const& as, std::vector<Reals> const& bs, Int width) {
+  auto n = Int(as.size());
+  HostWrite<Real> local_dots(n * width);
+  for (Int i = 0; i < n; ++i) {
+    auto a = as[std::size_t(i)];
+    auto b = bs[std::size_t(i)];
+    Reals ab = multiply_each(Reals(multiply_each(a, b)), owned_w);
+    for (Int j = 0; j < width; ++j) {
+      local_dots[i * width + j] = get_sum(get_component(ab, width, j));
+    }
+  }
+  auto dots = HostRead<Real>(
+      comm->allreduce(Read<Real>(local_dots.write()), OMEGA_H_SUM));
+  std::vector<Real> out(std::size_t(n * width));
+  for (Int i = 0; i < n * width; ++i) out[std::size_t(i)] = dots[i];
+  return out;
+}
+
 Reals solve_laplacian(
     Mesh* mesh, Reals initial, Int width, Real tol, Real floor) {
   OMEGA_H_CHECK(mesh->owners_have_all_upward(VERT));
   OMEGA_H_CHECK(initial.size() == mesh->nverts() * width);
   auto comm = mesh->comm();
-  auto state = initial;
+  auto nverts = mesh->nverts();
   auto star = mesh->ask_star(VERT);
-  auto interior = mark_by_class_dim(mesh, VERT, mesh->dim());
-  auto boundary = invert_marks(interior);
-  auto b2v = collect_marked(boundary);
-  auto weights = Reals(star.ab2b.size(), 1.0);
-  auto bc_data = read(unmap(b2v, initial, width));
-  bool done = false;
-  Int niters = 0;
-  do {
-    auto new_state_nobc = graph_weighted_average(star, weights, state, width);
-    auto new_state_w = deep_copy(new_state_nobc);
-    map_into(bc_data, b2v, new_state_w, width);
-    auto new_state = Reals(new_state_w);
-    new_state = mesh->sync_array(VERT, new_state, width);
-    auto local_done = are_close(state, new_state, tol, floor);
-    done = comm->reduce_and(local_done);
-    state = new_state;
+  auto is_free = mark_by_class_dim(mesh, VERT, mesh->dim());
+  auto owned = mesh->owned(VERT);
+  auto degrees = get_degrees(star.a2ab);
+  auto inv_diag_w = Write<Real>(nverts);
+  auto owned_w_w = Write<Real>(nverts);
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    inv_diag_w[v] = (is_free[v] && degrees[v]) ? (1.0 / Real(degrees[v])) : 0.0;
+    owned_w_w[v] = owned[v] ? 1.0 : 0.0;
+  };
+  parallel_for(nverts, f, "laplacian_diagonal");
+  Reals inv_diag(inv_diag_w);
+  Reals owned_w(owned_w_w);
+  /* Jacobi-preconditioned conjugate gradients on the free vertices,
+     one independent system per component, with the fixed values
+     moved into the initial residual.
+     each iteration costs one halo exchange and two reductions */
+  auto x = initial;
+  Reals r = multiply_each_by(apply_laplacian(star, is_free, x, width), -1.0);
+  Reals z = multiply_each(r, inv_diag);
+  auto p = mesh->sync_array(VERT, z, width);
+  auto dots = get_dots(comm, owned_w, {r, r}, {z, r}, width);
+  std::vector<Real> rz(dots.begin(), dots.begin() + width);
+  std::vector<Real> rr0(dots.begin() + width, dots.end());
+  auto rr = rr0;
+  auto max_iters = mesh->nglobal_ents(VERT);
+  GO niters = 0;
+  while (niters < max_iters) {
+    bool done = true;
+    for (std::size_t j = 0; j < rr.size(); ++j) {
+      if (rr[j] > square(tol) * rr0[j] && rr[j] > square(floor)) done = false;
+    }
+    if (done) break;
+    auto ap = apply_laplacian(star, is_free, p, width);
+    auto pap = get_dots(comm, owned_w, {p}, {ap}, width);
+    std::vector<Real> alpha(rz.size());
+    std::vector<Real> minus_alpha(rz.size());
+    for (std::size_t j = 0; j < rz.size(); ++j) {
+      alpha[j] = (pap[j] > 0.0) ? (rz[j] / pap[j]) : 0.0;
+      minus_alpha[j] = -alpha[j];
+    }
+    x = axpy(alpha, p, x, width);
+    r = axpy(minus_alpha, ap, r, width);
+    z = multiply_each(r, inv_diag);
+    dots = get_dots(comm, owned_w, {r, r}, {z, r}, width);
+    std::vector<Real> beta(rz.size());
+    for (std::size_t j = 0; j < rz.size(); ++j) {
+      beta[j] = (rz[j] > 0.0) ? (dots[j] / rz[j]) : 0.0;
+      rz[j] = dots[j];
+      rr[j] = dots[std::size_t(width) + j];
+    }
+    p = mesh->sync_array(VERT, axpy(beta, p, z, width), width);
     ++niters;
-  } while (!done);
+  }
   if (comm->rank() == 0) {
-    std::cout << "laplacian solve took " << niters << " iterations\n";
+    Real residual = 0.0;
+    for (std::size_t j = 0; j < rr.size(); ++j) {
+      if (rr0[j] > 0.0) residual = max2(residual, std::sqrt(rr[j] / rr0[j]));
+    }
+    std::cout << "laplacian solve took " << niters
+              << " iterations, relative residual " << residual << '\n';
   }
-  return state;
+  return x;
 }
 
 }  // end namespace Omega_h
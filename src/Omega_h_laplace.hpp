@@ -7,6 +7,15 @@ namespace Omega_h {
 
 class Mesh;
 
+/* solves for the harmonic extension of (initial), whose (width)
+   components are held fixed on the vertices not classified on the
+   interior and whose interior values are the starting guess.
+   conjugate gradients stop once, for every component, the residual
+   2-norm is below (tol) times the initial one or below (floor).
+   (tol) is thus a relative residual reduction, not a bound on the
+   change between iterates: the error can be larger than (tol) by
+   a factor that grows with the mesh size, about ten at 1e-2 on a
+   64x64 box, so 1e-4 or less is needed for a few digits */
 Reals solve_laplacian(
     Mesh* mesh, Reals initial, Int width, Real tol, Real floor = EPSILON);
 
@@ -2,6 +2,7 @@
 #include <Omega_h_cmdline.hpp>
 #include <Omega_h_library.hpp>
 #include <Omega_h_malloc.hpp>
+#include <Omega_h_comm_stats.hpp>
 #include <Omega_h_profile.hpp>
 #include <Omega_h_dbg.hpp>
 
@@ -105,10 +106,19 @@ void Library::initialize(char const* head_desc, int* argc, char*** argv
   osh_time_chop_flag.add_arg<double>("0.0");
   cmdline.add_flag("--osh-time-with-filename", "add file name to function name in profile output");
 
+  cmdline.add_flag("--osh-comm-stats",
+      "print the messages, bytes and wait time of each communication site");
+  auto& comm_traffic_flag = cmdline.add_flag("--osh-comm-traffic",
+      "--osh-comm-stats, and write the bytes sent between ranks to a CSV file");
+  comm_traffic_flag.add_arg<std::string>("path");
+  cmdline.add_flag("--osh-shared-memory",
+      "exchange repeated messages between ranks of a node in shared memory");
   cmdline.add_flag("--osh-signal", "catch signals and print a stacktrace");
   cmdline.add_flag("--osh-fpe", "enable floating-point exceptions");
   cmdline.add_flag("--osh-silent", "suppress all output");
   cmdline.add_flag("--osh-pool", "use memory pooling");
+  cmdline.add_flag("--osh-pool-stats",
+      "use memory pooling and print its high water mark and fragmentation");
   auto& self_send_flag =
       cmdline.add_flag("--osh-self-send", "control self send threshold");
   self_send_flag.add_arg<int>("value");
@@ -131,6 +141,13 @@ void Library::initialize(char const* head_desc, int* argc, char*** argv
     Omega_h::profile::global_singleton_history =
       new Omega_h::profile::History(world_, true, chop, add_filename);
   }
+  if (cmdline.parsed("--osh-comm-traffic")) {
+    comm_traffic_path_ =
+        cmdline.get<std::string>("--osh-comm-traffic", "path");
+  }
+  if (cmdline.parsed("--osh-comm-stats") || !comm_traffic_path_.empty()) {
+    comm_stats::global_singleton_stats = new comm_stats::Stats(world_);
+  }
   if (cmdline.parsed("--osh-fpe")) {
     enable_floating_point_exceptions();
   }
@@ -139,6 +156,7 @@ void Library::initialize(char const* head_desc, int* argc, char*** argv
     self_send_threshold_ = cmdline.get<int>("--osh-self-send", "value");
   }
   silent_ = cmdline.parsed("--osh-silent");
+  shared_memory_exchange_ = cmdline.parsed("--osh-shared-memory");
 #ifdef OMEGA_H_USE_KOKKOS
   if (!Kokkos::is_initialized()) {
     OMEGA_H_CHECK(argc != nullptr);
@@ -171,11 +189,14 @@ void Library::initialize(char const* head_desc, int* argc, char*** argv
   // and prevent it from polluting later timings
   cudaFree(nullptr);
 #endif
-  if (cmdline.parsed("--osh-pool")) enable_pooling();
+  print_pool_stats_ = cmdline.parsed("--osh-pool-stats");
+  if (cmdline.parsed("--osh-pool") || print_pool_stats_) enable_pooling();
 }
 
 Library::Library(Library const& other)
-    : world_(other.world_),
+    : shared_memory_exchange_(other.shared_memory_exchange_),
+      print_pool_stats_(false),
+      world_(other.world_),
       self_(other.self_)
 #ifdef OMEGA_H_USE_MPI
       ,
@@ -201,6 +222,19 @@ Library::~Library() {
     delete Omega_h::profile::global_singleton_history;
     Omega_h::profile::global_singleton_history = nullptr;
   }
+  if (comm_stats::global_singleton_stats) {
+    auto stats = comm_stats::global_singleton_stats;
+    /* stop recording before reporting */
+    comm_stats::global_singleton_stats = nullptr;
+    comm_stats::print(*stats);
+    if (!comm_traffic_path_.empty()) {
+      comm_stats::write_traffic(*stats, comm_traffic_path_);
+    }
+    delete stats;
+  }
+  if (print_pool_stats_ && world_->rank() == 0) {
+    print_pooling_stats(std::cout);
+  }
   // need to destroy all Comm objects prior to MPI_Finalize()
   world_ = CommPtr();
   self_ = CommPtr();
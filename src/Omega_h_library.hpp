@@ -37,6 +37,10 @@ class Library {
   LO self_send_threshold() const;
   LO self_send_threshold_;
   bool silent_;
+  /* exchange persistent messages between ranks on the same node
+     through shared memory instead of MPI */
+  bool shared_memory_exchange_;
+  bool print_pool_stats_;
   std::vector<std::string> argv_;
 
  private:
@@ -55,6 +59,7 @@ class Library {
   bool we_called_kokkos_init;
 #endif
   std::map<std::string, double> timers;
+  std::string comm_traffic_path_;
 };
 
 extern char* max_memory_stacktrace;
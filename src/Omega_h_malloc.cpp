@@ -3,6 +3,7 @@
 #include <Omega_h_pool.hpp>
 #include <Omega_h_profile.hpp>
 #include <cstdlib>
+#include <iostream>
 
 namespace Omega_h {
 
@@ -71,6 +72,17 @@ void disable_pooling() {
   host_pool = nullptr;
 }
 
+void print_pooling_stats(std::ostream& stream) {
+  if (device_pool) {
+    stream << "device memory pool:\n";
+    print_pool_stats(stream, get_stats(*device_pool));
+  }
+  if (host_pool) {
+    stream << "host memory pool:\n";
+    print_pool_stats(stream, get_stats(*host_pool));
+  }
+}
+
 void* maybe_pooled_device_malloc(std::size_t size) {
   if (device_pool) return allocate(*device_pool, size);
   return device_malloc(size);
@@ -2,6 +2,7 @@
 #define OMEGA_H_MALLOC_HPP
 
 #include <cstddef>
+#include <iosfwd>
 
 namespace Omega_h {
 
@@ -12,6 +13,7 @@ void host_free(void* ptr, std::size_t size);
 
 void enable_pooling();
 void disable_pooling();
+void print_pooling_stats(std::ostream& stream);
 
 void* maybe_pooled_device_malloc(std::size_t size);
 void maybe_pooled_device_free(void* ptr, std::size_t size);
@@ -10,10 +10,13 @@
 #include "Omega_h_element.hpp"
 #include "Omega_h_for.hpp"
 #include "Omega_h_ghost.hpp"
+#include "Omega_h_hilbert.hpp"
 #include "Omega_h_inertia.hpp"
 #include "Omega_h_map.hpp"
 #include "Omega_h_mark.hpp"
 #include "Omega_h_migrate.hpp"
+#include "Omega_h_multilevel.hpp"
+#include "Omega_h_profile.hpp"
 #include "Omega_h_quality.hpp"
 #include "Omega_h_shape.hpp"
 #include "Omega_h_timer.hpp"
@@ -71,6 +74,7 @@ void Mesh::set_comm(CommPtr const& new_comm) {
     }
   }
   comm_ = new_comm;
+  ghost_history_ = GhostHistoryPtr();
 }
 
 void Mesh::set_family(Omega_h_Family family_in) { family_ = family_in; }
@@ -472,7 +476,9 @@ Dist Mesh::ask_dist(Int ent_dim) {
     auto owners = ask_owners(ent_dim);
     OMEGA_H_CHECK(owners.ranks.exists());
     OMEGA_H_CHECK(owners.idxs.exists());
-    dists_[ent_dim] = std::make_shared<Dist>(comm_, owners, nents(ent_dim));
+    auto dist = std::make_shared<Dist>(comm_, owners, nents(ent_dim));
+    dist->keep_plans();
+    dists_[ent_dim] = dist;
   }
   return *(dists_[ent_dim]);
 }
@@ -531,31 +537,54 @@ void Mesh::set_parting(Omega_h_Parting parting_in, bool verbose) {
     set_parting(parting_in, 1, verbose);
 }
 
+void Mesh::balance(bool predictive) { balance(OMEGA_H_RIB, predictive); }
+
 /* this is a member function mainly because it
    modifies the RIB hints */
-void Mesh::balance(bool predictive) {
+void Mesh::balance(Omega_h_Balancer balancer, bool predictive) {
   OMEGA_H_TIME_FUNCTION;
   if (comm_->size() == 1) return;
   set_parting(OMEGA_H_ELEM_BASED);
-  inertia::Rib hints;
-  if (rib_hints_) hints = *rib_hints_;
-  auto ecoords =
-      average_field(this, dim(), LOs(nelems(), 0, 1), dim(), coords());
-  if (dim() < 3) ecoords = resize_vectors(ecoords, dim(), 3);
   Reals masses;
-  Real abs_tol;
   if (predictive) {
     masses = get_complexity_per_elem(this, get_array<Real>(VERT, "metric"));
     /* average between input mesh weight (1.0)
        and predicted output mesh weight */
     masses = add_to_each(masses, 1.);
     masses = multiply_each_by(masses, 1. / 2.);
-    abs_tol = max2(0.0, get_max(comm_, masses));
   } else {
     masses = Reals(nelems(), 1);
-    abs_tol = 1.0;
   }
+  balance(masses, balancer);
+}
+
+void Mesh::balance(Reals masses, Omega_h_Balancer balancer) {
+  OMEGA_H_TIME_FUNCTION;
+  if (comm_->size() == 1) return;
+  OMEGA_H_CHECK(parting() == OMEGA_H_ELEM_BASED);
+  OMEGA_H_CHECK(masses.size() == nelems());
+  auto abs_tol = max2(0.0, get_max(comm_, masses));
   abs_tol *= 2.0;  // fudge factor ?
+  if (balancer != OMEGA_H_RIB) {
+    Read<I32> parts;
+    if (balancer == OMEGA_H_MULTILEVEL) {
+      parts = multilevel::partition(this, masses, comm_->size(), 0.03);
+    } else {
+      parts = hilbert::partition(this, masses, comm_->size());
+    }
+    Dist old2new;
+    old2new.set_parent_comm(comm_);
+    old2new.set_dest_ranks(parts);
+    old2new.set_roots2items(LOs(nelems() + 1, 0, 1));
+    old2new.set_dest_globals(globals(dim()));
+    migrate_mesh(this, old2new.invert(), OMEGA_H_ELEM_BASED, false);
+    return;
+  }
+  inertia::Rib hints;
+  if (rib_hints_) hints = *rib_hints_;
+  auto ecoords =
+      average_field(this, dim(), LOs(nelems(), 0, 1), dim(), coords());
+  if (dim() < 3) ecoords = resize_vectors(ecoords, dim(), 3);
   auto owners = ask_owners(dim());
   recursively_bisect(comm(), abs_tol, &ecoords, &masses, &owners, &hints);
   rib_hints_ = std::make_shared<inertia::Rib>(hints);
@@ -610,6 +639,74 @@ Read<T> Mesh::reduce_array(Int ent_dim, Read<T> a, Int width, Omega_h_Op op) {
   return ask_dist(ent_dim).exch_reduce(a, width, op);
 }
 
+/* copies each of (arrays) into its own columns of an array with
+   (*p_width) components per entity */
+template <typename T>
+static Read<T> pack_columns(LO n, std::vector<Read<T>> const& arrays,
+    std::vector<Int> const& widths, Int* p_width) {
+  OMEGA_H_CHECK(arrays.size() == widths.size());
+  Int width = 0;
+  for (auto w : widths) width += w;
+  Write<T> packed(n * width);
+  Int offset = 0;
+  for (std::size_t i = 0; i < arrays.size(); ++i) {
+    auto a = arrays[i];
+    auto a_width = widths[i];
+    OMEGA_H_CHECK(a.size() == n * a_width);
+    auto f = OMEGA_H_LAMBDA(LO e) {
+      for (Int j = 0; j < a_width; ++j) {
+        packed[e * width + offset + j] = a[e * a_width + j];
+      }
+    };
+    parallel_for(n, f, "pack_columns");
+    offset += a_width;
+  }
+  *p_width = width;
+  return packed;
+}
+
+template <typename T>
+static std::vector<Read<T>> unpack_columns(
+    LO n, Read<T> packed, std::vector<Int> const& widths, Int width) {
+  std::vector<Read<T>> arrays;
+  Int offset = 0;
+  for (auto a_width : widths) {
+    Write<T> a(n * a_width);
+    auto f = OMEGA_H_LAMBDA(LO e) {
+      for (Int j = 0; j < a_width; ++j) {
+        a[e * a_width + j] = packed[e * width + offset + j];
+      }
+    };
+    parallel_for(n, f, "unpack_columns");
+    arrays.push_back(a);
+    offset += a_width;
+  }
+  return arrays;
+}
+
+template <typename T>
+std::vector<Read<T>> Mesh::sync_arrays(Int ent_dim,
+    std::vector<Read<T>> const& arrays, std::vector<Int> const& widths) {
+  OMEGA_H_TIME_FUNCTION;
+  if (arrays.empty() || !could_be_shared(ent_dim)) return arrays;
+  Int width;
+  auto packed = pack_columns(nents(ent_dim), arrays, widths, &width);
+  packed = ask_dist(ent_dim).invert().exch(packed, width);
+  return unpack_columns(nents(ent_dim), packed, widths, width);
+}
+
+template <typename T>
+std::vector<Read<T>> Mesh::reduce_arrays(Int ent_dim,
+    std::vector<Read<T>> const& arrays, std::vector<Int> const& widths,
+    Omega_h_Op op) {
+  OMEGA_H_TIME_FUNCTION;
+  if (arrays.empty() || !could_be_shared(ent_dim)) return arrays;
+  Int width;
+  auto packed = pack_columns(nents(ent_dim), arrays, widths, &width);
+  packed = ask_dist(ent_dim).exch_reduce(packed, width, op);
+  return unpack_columns(nents(ent_dim), packed, widths, width);
+}
+
 template <typename T>
 Read<T> Mesh::owned_array(Int ent_dim, Read<T> a, Int width) {
   OMEGA_H_CHECK(a.size() == width * nents(ent_dim));
@@ -660,6 +757,117 @@ void Mesh::sync_tag(Int ent_dim, std::string const& name) {
   }
 }
 
+/* copies the bytes of each entity's (width) values of (a) into bytes
+   [offset, offset + width * sizeof(T)) of that entity's record of
+   (nwords) words in (packed). the records are made of whole words so
+   that moving them through a Dist costs little more than moving the
+   arrays one at a time */
+template <typename T>
+static void pack_bytes(
+    Read<T> a, Int width, Write<I64> packed, Int nwords, Int offset) {
+  auto n = divide_no_remainder(packed.size(), nwords);
+  auto packed_bytes = reinterpret_cast<unsigned char*>(packed.data());
+  auto stride = nwords * Int(sizeof(I64));
+  auto f = OMEGA_H_LAMBDA(LO e) {
+    for (Int j = 0; j < width; ++j) {
+      T const val = a[e * width + j];
+      auto bytes = reinterpret_cast<unsigned char const*>(&val);
+      auto out = packed_bytes + e * stride + offset + j * Int(sizeof(T));
+      for (Int k = 0; k < Int(sizeof(T)); ++k) out[k] = bytes[k];
+    }
+  };
+  parallel_for(n, f, "pack_bytes");
+}
+
+template <typename T>
+static Read<T> unpack_bytes(
+    Read<I64> packed, Int nwords, Int offset, Int width) {
+  auto n = divide_no_remainder(packed.size(), nwords);
+  auto packed_bytes = reinterpret_cast<unsigned char const*>(packed.data());
+  auto stride = nwords * Int(sizeof(I64));
+  Write<T> a(n * width);
+  auto f = OMEGA_H_LAMBDA(LO e) {
+    for (Int j = 0; j < width; ++j) {
+      T val;
+      auto bytes = reinterpret_cast<unsigned char*>(&val);
+      auto in = packed_bytes + e * stride + offset + j * Int(sizeof(T));
+      for (Int k = 0; k < Int(sizeof(T)); ++k) bytes[k] = in[k];
+      a[e * width + j] = val;
+    }
+  };
+  parallel_for(n, f, "unpack_bytes");
+  return a;
+}
+
+static Int tag_nbytes(TagBase const* tagbase) {
+  switch (tagbase->type()) {
+    case OMEGA_H_I8:
+      return tagbase->ncomps() * Int(sizeof(I8));
+    case OMEGA_H_I32:
+      return tagbase->ncomps() * Int(sizeof(I32));
+    case OMEGA_H_I64:
+      return tagbase->ncomps() * Int(sizeof(I64));
+    case OMEGA_H_F64:
+      return tagbase->ncomps() * Int(sizeof(Real));
+  }
+  OMEGA_H_NORETURN(0);
+}
+
+void Mesh::sync_tags(Int ent_dim, std::vector<std::string> const& names) {
+  OMEGA_H_TIME_FUNCTION;
+  if (names.empty() || !could_be_shared(ent_dim)) return;
+  Int nbytes = 0;
+  for (auto& name : names) nbytes += tag_nbytes(get_tagbase(ent_dim, name));
+  auto nwords = (nbytes + Int(sizeof(I64)) - 1) / Int(sizeof(I64));
+  Write<I64> packed(nents(ent_dim) * nwords, 0);
+  Int offset = 0;
+  for (auto& name : names) {
+    auto tagbase = get_tagbase(ent_dim, name);
+    auto ncomps = tagbase->ncomps();
+    switch (tagbase->type()) {
+      case OMEGA_H_I8:
+        pack_bytes(as<I8>(tagbase)->array(), ncomps, packed, nwords, offset);
+        break;
+      case OMEGA_H_I32:
+        pack_bytes(as<I32>(tagbase)->array(), ncomps, packed, nwords, offset);
+        break;
+      case OMEGA_H_I64:
+        pack_bytes(as<I64>(tagbase)->array(), ncomps, packed, nwords, offset);
+        break;
+      case OMEGA_H_F64:
+        pack_bytes(as<Real>(tagbase)->array(), ncomps, packed, nwords, offset);
+        break;
+    }
+    offset += tag_nbytes(tagbase);
+  }
+  auto recvd = ask_dist(ent_dim).invert().exch(Read<I64>(packed), nwords);
+  offset = 0;
+  for (auto& name : names) {
+    auto tagbase = get_tagbase(ent_dim, name);
+    auto ncomps = tagbase->ncomps();
+    auto tag_offset = offset;
+    offset += tag_nbytes(tagbase);
+    switch (tagbase->type()) {
+      case OMEGA_H_I8:
+        set_tag(ent_dim, name,
+            unpack_bytes<I8>(recvd, nwords, tag_offset, ncomps));
+        break;
+      case OMEGA_H_I32:
+        set_tag(ent_dim, name,
+            unpack_bytes<I32>(recvd, nwords, tag_offset, ncomps));
+        break;
+      case OMEGA_H_I64:
+        set_tag(ent_dim, name,
+            unpack_bytes<I64>(recvd, nwords, tag_offset, ncomps));
+        break;
+      case OMEGA_H_F64:
+        set_tag(ent_dim, name,
+            unpack_bytes<Real>(recvd, nwords, tag_offset, ncomps));
+        break;
+    }
+  }
+}
+
 void Mesh::reduce_tag(Int ent_dim, std::string const& name, Omega_h_Op op) {
   auto tagbase = get_tagbase(ent_dim, name);
   switch (tagbase->type()) {
@@ -735,6 +943,12 @@ Mesh::RibPtr Mesh::rib_hints() const { return rib_hints_; }
 
 void Mesh::set_rib_hints(RibPtr hints) { rib_hints_ = hints; }
 
+Mesh::GhostHistoryPtr Mesh::ghost_history() const { return ghost_history_; }
+
+void Mesh::set_ghost_history(GhostHistoryPtr history) {
+  ghost_history_ = history;
+}
+
 Real Mesh::imbalance(Int ent_dim) const {
   if (ent_dim == -1) ent_dim = dim();
   auto local = Real(nents(ent_dim));
@@ -746,6 +960,17 @@ Real Mesh::imbalance(Int ent_dim) const {
   return m / a;
 }
 
+Real Mesh::imbalance(Reals masses) const {
+  OMEGA_H_CHECK(masses.size() == nents(dim()));
+  auto local = get_sum(masses);
+  auto s = comm_->allreduce(local, OMEGA_H_SUM);
+  if (s == 0.0) return 1.0;
+  auto m = comm_->allreduce(local, OMEGA_H_MAX);
+  auto n = comm_->size();
+  auto a = s / n;
+  return m / a;
+}
+
 std::string Mesh::string(int verbose) {
   auto gre = ghosted_ratio(dim());
   auto gr0 = ghosted_ratio(0);
@@ -848,6 +1073,29 @@ Reals average_field(Mesh* mesh, Int ent_dim, Int ncomps, Reals v2x) {
   return average_field(mesh, ent_dim, a2e, ncomps, v2x);
 }
 
+Reals time_weighted_masses(Mesh* mesh, Reals masses, Real time) {
+  OMEGA_H_CHECK(masses.size() == mesh->nelems());
+  auto comm = mesh->comm();
+  auto local_mass = get_sum(masses);
+  auto total_mass = comm->allreduce(local_mass, OMEGA_H_SUM);
+  auto total_time = comm->allreduce(time, OMEGA_H_SUM);
+  if (!(total_time > 0.0) || !(total_mass > 0.0)) return masses;
+  /* ranks that measured nothing are assumed to be average */
+  auto average_rate = total_time / total_mass;
+  auto rate = average_rate;
+  if (time > 0.0 && local_mass > 0.0) rate = time / local_mass;
+  return multiply_each_by(masses, rate / average_rate);
+}
+
+Reals timer_weighted_masses(
+    Mesh* mesh, Reals masses, char const* timer_name) {
+  Real time = 0.0;
+  if (profile::global_singleton_history) {
+    time = profile::total_time(*profile::global_singleton_history, timer_name);
+  }
+  return time_weighted_masses(mesh, masses, time);
+}
+
 void get_all_dim_tags(Mesh* mesh, Int dim, TagSet* tags) {
   for (Int j = 0; j < mesh->ntags(dim); ++j) {
     auto tagbase = mesh->get_tag(dim, j);
@@ -931,7 +1179,12 @@ __host__
   template Read<T> Mesh::owned_subset_array(                                   \
       Int ent_dim, Read<T> a_data, LOs a2e, T default_val, Int width);         \
   template Read<T> Mesh::reduce_array(                                         \
-      Int ent_dim, Read<T> a, Int width, Omega_h_Op op);
+      Int ent_dim, Read<T> a, Int width, Omega_h_Op op);                       \
+  template std::vector<Read<T>> Mesh::sync_arrays(Int ent_dim,                 \
+      std::vector<Read<T>> const& arrays, std::vector<Int> const& widths);     \
+  template std::vector<Read<T>> Mesh::reduce_arrays(Int ent_dim,               \
+      std::vector<Read<T>> const& arrays, std::vector<Int> const& widths,      \
+      Omega_h_Op op);
 OMEGA_H_INST(I8)
 OMEGA_H_INST(I32)
 OMEGA_H_INST(I64)
@@ -19,6 +19,8 @@ namespace inertia {
 struct Rib;
 }
 
+struct GhostHistory;
+
 struct ClassPair {
   inline ClassPair() = default;
   inline ClassPair(Int t_dim, LO t_id) : dim(t_dim), id(t_id) {}
@@ -85,12 +87,14 @@ class Mesh {
   Adj ask_up(Int from, Int to);
   Graph ask_star(Int dim);
   Graph ask_dual();
+  void add_adj(Int from, Int to, Adj adj);
 
  public:
   typedef std::shared_ptr<const TagBase> TagPtr;
   typedef std::shared_ptr<const Adj> AdjPtr;
   typedef std::shared_ptr<const Dist> DistPtr;
   typedef std::shared_ptr<const inertia::Rib> RibPtr;
+  typedef std::shared_ptr<const GhostHistory> GhostHistoryPtr;
   typedef std::shared_ptr<const Parents> ParentPtr;
   typedef std::shared_ptr<const Children> ChildrenPtr;
 
@@ -102,7 +106,6 @@ class Mesh {
   TagCIter tag_iter(Int dim, std::string const& name) const;
   void check_dim(Int dim) const;
   void check_dim2(Int dim) const;
-  void add_adj(Int from, Int to, Adj adj);
   Adj derive_adj(Int from, Int to);
   Adj ask_adj(Int from, Int to);
   void react_to_set_tag(Int dim, std::string const& name);
@@ -117,6 +120,7 @@ class Mesh {
   Remotes owners_[DIMS];
   DistPtr dists_[DIMS];
   RibPtr rib_hints_;
+  GhostHistoryPtr ghost_history_;
   ParentPtr parents_[DIMS];
   ChildrenPtr children_[DIMS][DIMS];
   Library* library_;
@@ -142,6 +146,10 @@ class Mesh {
   void set_parting(Omega_h_Parting parting_in, Int nlayers, bool verbose);
   void set_parting(Omega_h_Parting parting_in, bool verbose = false);
   void balance(bool predictive = false);
+  void balance(Omega_h_Balancer balancer, bool predictive = false);
+  /* balances the total of the element weights (masses) per rank
+     instead of the element count. the mesh must be element-based */
+  void balance(Reals masses, Omega_h_Balancer balancer = OMEGA_H_RIB);
   Graph ask_graph(Int from, Int to);
   template <typename T>
   Read<T> sync_array(Int ent_dim, Read<T> a, Int width);
@@ -152,11 +160,22 @@ class Mesh {
       Int ent_dim, Read<T> a_data, LOs a2e, T default_val, Int width);
   template <typename T>
   Read<T> reduce_array(Int ent_dim, Read<T> a, Int width, Omega_h_Op op);
+  /* the batched forms below pack several arrays side by side so that
+     they travel in a single exchange, i.e. one message per neighbor */
+  template <typename T>
+  std::vector<Read<T>> sync_arrays(Int ent_dim,
+      std::vector<Read<T>> const& arrays, std::vector<Int> const& widths);
+  template <typename T>
+  std::vector<Read<T>> reduce_arrays(Int ent_dim,
+      std::vector<Read<T>> const& arrays, std::vector<Int> const& widths,
+      Omega_h_Op op);
   template <typename T>
   Read<T> owned_array(Int ent_dim, Read<T> a, Int width);
   template <typename T>
   Read<T> owned_subset_array(Int ent_dim, Read<T> a_data, LOs a2e, T default_val, Int width);
   void sync_tag(Int dim, std::string const& name);
+  /* tags of different types are packed together byte-wise */
+  void sync_tags(Int dim, std::vector<std::string> const& names);
   void reduce_tag(Int dim, std::string const& name, Omega_h_Op op);
   bool operator==(Mesh& other);
   Real min_quality();
@@ -167,7 +186,14 @@ class Mesh {
   Mesh copy_meta() const;
   RibPtr rib_hints() const;
   void set_rib_hints(RibPtr hints);
+  /* left by going element-based from a ghosted mesh, see ghost_mesh().
+     unlike the RIB hints, this is not copied by copy_meta() */
+  GhostHistoryPtr ghost_history() const;
+  void set_ghost_history(GhostHistoryPtr history);
   Real imbalance(Int ent_dim = -1) const;
+  /* the largest total of the element weights (masses) on a rank
+     divided by the average total */
+  Real imbalance(Reals masses) const;
   Real ghosted_ratio(Int ent_dim);
   LO nents_owned(Int ent_dim);
   std::string string(int verbose=0);
@@ -183,6 +209,16 @@ Real repro_sum_owned(Mesh* mesh, Int dim, Reals a);
 Reals average_field(Mesh* mesh, Int dim, LOs a2e, Int ncomps, Reals v2x);
 Reals average_field(Mesh* mesh, Int dim, Int ncomps, Reals v2x);
 
+/* scales the element weights (masses) of this rank so that their
+   total is proportional to the (time) this rank spent on them.
+   a rank spending the average time per weight keeps its weights.
+   balancing by the result evens out the time per rank */
+Reals time_weighted_masses(Mesh* mesh, Reals masses, Real time);
+/* the same, using the time accumulated by the profiler timer
+   (timer_name) on this rank, or (masses) unchanged if profiling
+   is off */
+Reals timer_weighted_masses(Mesh* mesh, Reals masses, char const* timer_name);
+
 using TagSet = std::array<std::set<std::string>, DIMS>;
 
 void get_all_dim_tags(Mesh* mesh, Int dim, TagSet* tags);
@@ -226,7 +262,12 @@ __host__
   extern template Read<T> Mesh::owned_subset_array(                            \
       Int ent_dim, Read<T> a_data, LOs a2e, T default_val, Int width);         \
   extern template Read<T> Mesh::reduce_array(                                  \
-      Int ent_dim, Read<T> a, Int width, Omega_h_Op op);
+      Int ent_dim, Read<T> a, Int width, Omega_h_Op op);                       \
+  extern template std::vector<Read<T>> Mesh::sync_arrays(Int ent_dim,          \
+      std::vector<Read<T>> const& arrays, std::vector<Int> const& widths);     \
+  extern template std::vector<Read<T>> Mesh::reduce_arrays(Int ent_dim,        \
+      std::vector<Read<T>> const& arrays, std::vector<Int> const& widths,      \
+      Omega_h_Op op);
 OMEGA_H_EXPL_INST_DECL(I8)
 OMEGA_H_EXPL_INST_DECL(I32)
 OMEGA_H_EXPL_INST_DECL(I64)
@@ -4,6 +4,7 @@
 
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_confined.hpp"
+#include "Omega_h_dist.hpp"
 #include "Omega_h_for.hpp"
 #include "Omega_h_host_few.hpp"
 #include "Omega_h_map.hpp"
@@ -110,26 +111,47 @@ Reals interpolate_between_metrics(LO nmetrics, Reals a, Reals b, Real t) {
   return delinearize_metrics(nmetrics, log_c);
 }
 
-template <Int dim>
-Reals linearize_metrics_dim(Reals metrics) {
-  auto n = divide_no_remainder(metrics.size(), symm_ncomps(dim));
+/* replaces each symmetric tensor of (symms) by (op) of its
+   eigendecomposition, decomposing (eigen_pack_width) at a time */
+template <Int dim, typename Op>
+Reals map_symm_decomps(Reals symms, Op const& op, char const* name) {
+  auto const n = divide_no_remainder(symms.size(), symm_ncomps(dim));
+  auto const npacks = (n + eigen_pack_width - 1) / eigen_pack_width;
   auto out = Write<Real>(n * symm_ncomps(dim));
-  auto f = OMEGA_H_LAMBDA(LO i) {
-    set_symm(out, i, linearize_metric(get_symm<dim>(metrics, i)));
+  auto f = OMEGA_H_LAMBDA(LO pack) {
+    auto const first = pack * eigen_pack_width;
+    auto const nlanes = min2(eigen_pack_width, n - first);
+    SymmPack<dim> ms;
+    for (Int k = 0; k < eigen_pack_width; ++k) {
+      auto const m = (k < nlanes) ? get_symm<dim>(symms, first + k)
+                                  : zero_matrix<dim, dim>();
+      set_lane(ms, k, m);
+    }
+    auto const dds = decompose_symm_pack(ms);
+    for (Int k = 0; k < nlanes; ++k) {
+      set_symm(out, first + k, op(get_lane(dds, k)));
+    }
   };
-  parallel_for(n, f, "linearize_metrics");
+  parallel_for(npacks, std::move(f), name);
   return out;
 }
 
+template <Int dim>
+Reals linearize_metrics_dim(Reals metrics) {
+  auto op = OMEGA_H_LAMBDA(DiagDecomp<dim> dd) {
+    for (Int i = 0; i < dim; ++i) dd.l[i] = std::log(dd.l[i]);
+    return compose_ortho(dd.q, dd.l);
+  };
+  return map_symm_decomps<dim>(metrics, op, "linearize_metrics");
+}
+
 template <Int dim>
 Reals delinearize_metrics_dim(Reals lms) {
-  auto n = divide_no_remainder(lms.size(), symm_ncomps(dim));
-  auto out = Write<Real>(n * symm_ncomps(dim));
-  auto f = OMEGA_H_LAMBDA(LO i) {
-    set_symm(out, i, delinearize_metric(get_symm<dim>(lms, i)));
+  auto op = OMEGA_H_LAMBDA(DiagDecomp<dim> dd) {
+    for (Int i = 0; i < dim; ++i) dd.l[i] = std::exp(dd.l[i]);
+    return compose_ortho(dd.q, dd.l);
   };
-  parallel_for(n, f, "delinearize_metrics");
-  return out;
+  return map_symm_decomps<dim>(lms, op, "delinearize_metrics");
 }
 
 Reals linearize_metrics(LO nmetrics, Reals metrics) {
@@ -152,26 +174,36 @@ Reals delinearize_metrics(LO nmetrics, Reals linear_metrics) {
 
 /* gradation limiting code: */
 
+template <Int mesh_dim, Int metric_dim>
+OMEGA_H_INLINE Matrix<metric_dim, metric_dim> limit_gradation_at(LOs v2vv,
+    LOs vv2v, Reals coords, Reals values, LO v, Real max_rate) {
+  auto m = get_symm<metric_dim>(values, v);
+  auto x = get_vector<mesh_dim>(coords, v);
+  for (auto vv = v2vv[v]; vv < v2vv[v + 1]; ++vv) {
+    auto av = vv2v[vv];
+    auto am = get_symm<metric_dim>(values, av);
+    auto ax = get_vector<mesh_dim>(coords, av);
+    auto vec = ax - x;
+    auto metric_dist = metric_length(am, vec);
+    auto factor = metric_eigenvalue_from_length(1.0 + metric_dist * max_rate);
+    auto limiter = am * factor;
+    auto limited = intersect_metrics(m, limiter);
+    m = limited;
+  }
+  return m;
+}
+
 template <Int mesh_dim, Int metric_dim>
 Reals limit_gradation_once_tmpl(
     Mesh* mesh, Reals values, Real max_rate) {
   auto v2v = mesh->ask_star(VERT);
+  auto v2vv = v2v.a2ab;
+  auto vv2v = v2v.ab2b;
   auto coords = mesh->coords();
   auto out = Write<Real>(mesh->nverts() * symm_ncomps(metric_dim));
   auto f = OMEGA_H_LAMBDA(LO v) {
-    auto m = get_symm<metric_dim>(values, v);
-    auto x = get_vector<mesh_dim>(coords, v);
-    for (auto vv = v2v.a2ab[v]; vv < v2v.a2ab[v + 1]; ++vv) {
-      auto av = v2v.ab2b[vv];
-      auto am = get_symm<metric_dim>(values, av);
-      auto ax = get_vector<mesh_dim>(coords, av);
-      auto vec = ax - x;
-      auto metric_dist = metric_length(am, vec);
-      auto factor = metric_eigenvalue_from_length(1.0 + metric_dist * max_rate);
-      auto limiter = am * factor;
-      auto limited = intersect_metrics(m, limiter);
-      m = limited;
-    }
+    auto m = limit_gradation_at<mesh_dim, metric_dim>(
+        v2vv, vv2v, coords, values, v, max_rate);
     set_symm(out, v, m);
   };
   parallel_for(mesh->nverts(), f, "limit_metric_gradation");
@@ -180,6 +212,37 @@ Reals limit_gradation_once_tmpl(
   return values;
 }
 
+/* limits only the vertices in (a2v), keeping the old metric of
+   each one whose limited metric is close to it within (tol),
+   and sets (*changed_verts) to the others */
+template <Int mesh_dim, Int metric_dim>
+Reals limit_gradation_front_once_tmpl(Mesh* mesh, Reals values, LOs a2v,
+    Real max_rate, Real tol, LOs* changed_verts) {
+  auto v2v = mesh->ask_star(VERT);
+  auto v2vv = v2v.a2ab;
+  auto vv2v = v2v.ab2b;
+  auto coords = mesh->coords();
+  auto out = deep_copy(values);
+  auto a_changed = Write<I8>(a2v.size());
+  auto f = OMEGA_H_LAMBDA(LO a) {
+    auto v = a2v[a];
+    auto m = limit_gradation_at<mesh_dim, metric_dim>(
+        v2vv, vv2v, coords, values, v, max_rate);
+    auto old_m = get_symm<metric_dim>(values, v);
+    bool changed = false;
+    for (Int i = 0; i < metric_dim; ++i) {
+      for (Int j = 0; j < metric_dim; ++j) {
+        if (!are_close(m[i][j], old_m[i][j], tol)) changed = true;
+      }
+    }
+    if (changed) set_symm(out, v, m);
+    a_changed[a] = changed;
+  };
+  parallel_for(a2v.size(), f, "limit_metric_gradation_front");
+  *changed_verts = unmap(collect_marked(read(a_changed)), a2v, 1);
+  return out;
+}
+
 static Reals limit_gradation_once(Mesh* mesh, Reals values, Real max_rate) {
   auto metric_dim = get_metrics_dim(mesh->nverts(), values);
   if (mesh->dim() == 3 && metric_dim == 3) {
@@ -196,6 +259,28 @@ static Reals limit_gradation_once(Mesh* mesh, Reals values, Real max_rate) {
   OMEGA_H_NORETURN(Reals());
 }
 
+static Reals limit_gradation_front_once(Mesh* mesh, Reals values, LOs a2v,
+    Real max_rate, Real tol, LOs* changed_verts) {
+  auto metric_dim = get_metrics_dim(mesh->nverts(), values);
+  if (mesh->dim() == 3 && metric_dim == 3) {
+    return limit_gradation_front_once_tmpl<3, 3>(
+        mesh, values, a2v, max_rate, tol, changed_verts);
+  } else if (mesh->dim() == 2 && metric_dim == 2) {
+    return limit_gradation_front_once_tmpl<2, 2>(
+        mesh, values, a2v, max_rate, tol, changed_verts);
+  } else if (mesh->dim() == 3 && metric_dim == 1) {
+    return limit_gradation_front_once_tmpl<3, 1>(
+        mesh, values, a2v, max_rate, tol, changed_verts);
+  } else if (mesh->dim() == 2 && metric_dim == 1) {
+    return limit_gradation_front_once_tmpl<2, 1>(
+        mesh, values, a2v, max_rate, tol, changed_verts);
+  } else if (mesh->dim() == 1) {
+    return limit_gradation_front_once_tmpl<1, 1>(
+        mesh, values, a2v, max_rate, tol, changed_verts);
+  }
+  OMEGA_H_NORETURN(Reals());
+}
+
 Reals limit_metric_gradation(
     Mesh* mesh, Reals values, Real max_rate, Real tol, bool verbose) {
   OMEGA_H_TIME_FUNCTION;
@@ -218,6 +303,57 @@ Reals limit_metric_gradation(
   return values2;
 }
 
+Reals limit_metric_gradation_front(
+    Mesh* mesh, Reals values, Real max_rate, Real tol, bool verbose) {
+  OMEGA_H_TIME_FUNCTION;
+  OMEGA_H_CHECK(mesh->owners_have_all_upward(VERT));
+  OMEGA_H_CHECK(max_rate > 0.0);
+  auto comm = mesh->comm();
+  auto nverts = mesh->nverts();
+  auto ncomps = divide_no_remainder(values.size(), nverts);
+  auto v2v = mesh->ask_star(VERT);
+  auto owned = mesh->owned(VERT);
+  values = mesh->sync_array(VERT, values, ncomps);
+  /* only owned vertices are limited, since only they see their
+     whole star, and owners send what they changed to the copies */
+  auto active = owned;
+  /* whether anything changed anywhere in the previous step, which
+     is reduced while the next step runs. once nothing changed, the
+     step after it had nothing to do, so the test lags by one step
+     at the cost of a single empty step at the end */
+  auto prev_changed = Future<I8>(Read<I8>({I8(1)}));
+  Int i = 0;
+  while (true) {
+    auto a2v = collect_marked(active);
+    LOs changed_verts;
+    values = limit_gradation_front_once(
+        mesh, values, a2v, max_rate, tol, &changed_verts);
+    auto changed_copies = changed_verts;
+    if (mesh->could_be_shared(VERT)) {
+      auto changed_values = Reals(unmap(changed_verts, values, ncomps));
+      auto recvd = mesh->ask_dist(VERT).invert().exch_subset(
+          changed_verts, changed_values, ncomps, &changed_copies);
+      auto values_w = deep_copy(values);
+      map_into(recvd, changed_copies, values_w, ncomps);
+      values = values_w;
+    }
+    auto changed = mark_image(changed_copies, nverts);
+    active = land_each(mark_down(v2v, changed), owned);
+    ++i;
+    if (verbose && can_print(mesh) && i % 50 == 0) {
+      std::cout << "warning: gradation limiting is up to step " << i << '\n';
+    }
+    auto done = !HostRead<I8>(prev_changed.get())[0];
+    if (done) break;
+    prev_changed =
+        comm->iallreduce(I8(changed_verts.size() != 0), OMEGA_H_MAX);
+  }
+  if (verbose && can_print(mesh)) {
+    std::cout << "limited gradation in " << i << " steps\n";
+  }
+  return values;
+}
+
 template <Int metric_dim>
 Reals project_metrics_dim(Mesh* mesh, Reals e2m) {
   auto e_linear = linearize_metrics(mesh->nelems(), e2m);
@@ -331,8 +467,7 @@ Reals get_implied_isos(Mesh* mesh) {
 
 template <Int dim>
 static OMEGA_H_INLINE_BIG Tensor<dim> metric_from_hessian(
-    Tensor<dim> const hessian, Real const eps) {
-  auto const ed = decompose_eigen(hessian);
+    DiagDecomp<dim> const ed, Real const eps) {
   auto const r = ed.q;
   auto const l = ed.l;
   constexpr auto c_num = square(dim);
@@ -341,21 +476,15 @@ static OMEGA_H_INLINE_BIG Tensor<dim> metric_from_hessian(
   for (Int i = 0; i < dim; ++i) {
     tilde_l[i] = (c_num * std::abs(l[i])) / (c_denom * eps);
   }
-  return compose_eigen(r, tilde_l);
+  return compose_ortho(r, tilde_l);
 }
 
 template <Int dim>
 Reals metric_from_hessians_dim(Reals hessians, Real eps) {
-  auto ncomps = symm_ncomps(dim);
-  auto n = divide_no_remainder(hessians.size(), ncomps);
-  auto out = Write<Real>(n * ncomps);
-  auto f = OMEGA_H_LAMBDA(LO i) {
-    auto hess = get_symm<dim>(hessians, i);
-    auto m = metric_from_hessian(hess, eps);
-    set_symm(out, i, m);
+  auto op = OMEGA_H_LAMBDA(DiagDecomp<dim> ed) {
+    return metric_from_hessian(ed, eps);
   };
-  parallel_for(n, f, "metric_from_hessians");
-  return out;
+  return map_symm_decomps<dim>(hessians, op, "metric_from_hessians");
 }
 
 Reals get_hessian_metrics(Int dim, Reals hessians, Real eps) {
@@ -205,6 +205,11 @@ Reals get_pure_implied_metrics(Mesh* mesh);
 Reals get_implied_metrics(Mesh* mesh);
 Reals limit_metric_gradation(Mesh* mesh, Reals values, Real max_rate,
     Real tol = 1e-2, bool verbose = true);
+/* like limit_metric_gradation, but each step only revisits the
+   vertices next to ones that changed by more than (tol) in the
+   step before, and only sends those changes to the copies */
+Reals limit_metric_gradation_front(Mesh* mesh, Reals values, Real max_rate,
+    Real tol = 1e-2, bool verbose = true);
 Reals get_complexity_per_elem(Mesh* mesh, Reals v2m);
 Reals get_nelems_per_elem(Mesh* mesh, Reals v2m);
 Real get_complexity(Mesh* mesh, Reals v2m);
@@ -27,6 +27,7 @@ MetricInput::MetricInput() {
   should_limit_gradation = false;
   max_gradation_rate = 1.0;
   gradation_convergence_tolerance = 1e-3;
+  should_limit_gradation_by_front = false;
   should_limit_element_count = false;
   max_element_count = 1e6;
   min_element_count = 1.0;
@@ -220,7 +221,10 @@ Reals generate_metrics(Mesh* mesh, MetricInput const& input) {
       metrics = smooth_metric_once(mesh, metrics);
     }
     if (input.should_limit_gradation) {
-      metrics = limit_metric_gradation(mesh, metrics, input.max_gradation_rate,
+      auto limit = input.should_limit_gradation_by_front
+                       ? limit_metric_gradation_front
+                       : limit_metric_gradation;
+      metrics = limit(mesh, metrics, input.max_gradation_rate,
           input.gradation_convergence_tolerance, input.verbose);
     }
     if (!input.should_limit_element_count) {
@@ -5,6 +5,7 @@
 #include "Omega_h_atomics.hpp"
 #include "Omega_h_element.hpp"
 #include "Omega_h_for.hpp"
+#include "Omega_h_ghost.hpp"
 #include "Omega_h_globals.hpp"
 #include "Omega_h_int_scan.hpp"
 #include "Omega_h_linpart.hpp"
@@ -514,6 +515,88 @@ void modify_ents(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
   modify_globals(old_mesh, new_mesh, ent_dim, keep_mods, mods2mds, mods2prods,
       *p_prods2new_ents, *p_same_ents2old_ents, *p_same_ents2new_ents,
       mods2reps, global_rep_counts);
+  modify_ghost_history(old_mesh, new_mesh, ent_dim, *p_old_ents2new_ents,
+      *p_prods2new_ents, prod_verts2verts);
+}
+
+/* the lows of entities that stay the same are renumbered,
+   those of products are derived for them alone */
+static void modify_down_adj(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
+    Int low_dim, LOs old_ents2new_ents, LOs old_lows2new_lows,
+    LOs prods2new_ents) {
+  OMEGA_H_TIME_FUNCTION;
+  auto const family = old_mesh->family();
+  auto const deg = element_degree(family, ent_dim, low_dim);
+  auto const old_down = old_mesh->ask_down(ent_dim, low_dim);
+  auto const old_el2l = old_down.ab2b;
+  auto const old_codes = old_down.codes;
+  auto const has_codes = old_codes.exists();
+  auto const nnew_ents = new_mesh->nents(ent_dim);
+  Write<LO> new_el2l(nnew_ents * deg);
+  Write<I8> new_codes;
+  if (has_codes) new_codes = Write<I8>(nnew_ents * deg);
+  auto f = OMEGA_H_LAMBDA(LO old_ent) {
+    auto const new_ent = old_ents2new_ents[old_ent];
+    if (new_ent < 0) return;
+    for (Int el = 0; el < deg; ++el) {
+      auto const old_el = old_ent * deg + el;
+      auto const new_el = new_ent * deg + el;
+      new_el2l[new_el] = old_lows2new_lows[old_el2l[old_el]];
+      if (has_codes) new_codes[new_el] = old_codes[old_el];
+    }
+  };
+  parallel_for(old_ents2new_ents.size(), std::move(f));
+  auto const mid_dim = low_dim + 1;
+  auto const mid_deg = element_degree(family, ent_dim, mid_dim);
+  auto const new_ents2mids = new_mesh->ask_down(ent_dim, mid_dim);
+  auto prods2mids = Adj(unmap(prods2new_ents, new_ents2mids.ab2b, mid_deg));
+  if (new_ents2mids.codes.exists()) {
+    prods2mids.codes = unmap(prods2new_ents, new_ents2mids.codes, mid_deg);
+  }
+  auto const prods2lows = transit(prods2mids,
+      new_mesh->ask_down(mid_dim, low_dim), family, ent_dim, low_dim);
+  map_into(prods2lows.ab2b, prods2new_ents, new_el2l, deg);
+  if (has_codes) {
+    map_into(prods2lows.codes, prods2new_ents, new_codes, deg);
+    new_mesh->add_adj(
+        ent_dim, low_dim, Adj(LOs(new_el2l), Read<I8>(new_codes)));
+  } else {
+    new_mesh->add_adj(ent_dim, low_dim, Adj(LOs(new_el2l)));
+  }
+}
+
+void modify_adjs(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
+    Few<LOs, 4> old_ents2new_ents, LOs prods2new_ents) {
+  OMEGA_H_TIME_FUNCTION;
+  for (Int low_dim = ent_dim - 2; low_dim >= 0; --low_dim) {
+    if (!old_mesh->has_adj(ent_dim, low_dim)) continue;
+    modify_down_adj(old_mesh, new_mesh, ent_dim, low_dim,
+        old_ents2new_ents[ent_dim], old_ents2new_ents[low_dim],
+        prods2new_ents);
+  }
+  /* inserting the uses by products costs more per use than inverting
+     all uses, so past a small share of products the upward adjacencies
+     are left for derive_adj() */
+  auto const nprods = prods2new_ents.size();
+  if (nprods * 8 > new_mesh->nents(ent_dim)) return;
+  for (Int low_dim = 0; low_dim < ent_dim; ++low_dim) {
+    if (!old_mesh->has_adj(low_dim, ent_dim)) continue;
+    if (!new_mesh->has_adj(ent_dim, low_dim)) continue;
+    if (new_mesh->has_adj(low_dim, ent_dim)) continue;
+    auto const deg = element_degree(old_mesh->family(), ent_dim, low_dim);
+    auto const new_ents2new_lows = new_mesh->ask_down(ent_dim, low_dim);
+    auto const prod_lows2new_lows =
+        unmap(prods2new_ents, new_ents2new_lows.ab2b, deg);
+    auto prod_low_codes = Read<I8>();
+    if (new_ents2new_lows.codes.exists()) {
+      prod_low_codes = unmap(prods2new_ents, new_ents2new_lows.codes, deg);
+    }
+    auto const new_up = patch_up_adj(old_mesh->ask_up(low_dim, ent_dim),
+        old_ents2new_ents[low_dim], old_ents2new_ents[ent_dim],
+        Adj(prod_lows2new_lows, prod_low_codes), prods2new_ents, deg,
+        new_mesh->nents(low_dim), ent_dim, low_dim);
+    new_mesh->add_adj(low_dim, ent_dim, new_up);
+  }
 }
 
 void set_owners_by_indset(
@@ -26,6 +26,14 @@ void modify_ents(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
     bool mods_can_be_shared, LOs* p_prods2new_ents, LOs* p_same_ents2old_ents,
     LOs* p_same_ents2new_ents, LOs* p_old_ents2new_ents);
 
+/* carries the adjacencies into (ent_dim) that (old_mesh) had already
+   derived over to (new_mesh), patching them where entities changed
+   instead of leaving (new_mesh) to derive them from scratch.
+   (old_ents2new_ents) holds the old to new maps of all dimensions
+   up to (ent_dim) */
+void modify_adjs(Mesh* old_mesh, Mesh* new_mesh, Int ent_dim,
+    Few<LOs, 4> old_ents2new_ents, LOs prods2new_ents);
+
 void set_owners_by_indset(
     Mesh* mesh, Int key_dim, LOs keys2kds, Graph kds2elems);
 
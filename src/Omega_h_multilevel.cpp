@@ -0,0 +1,853 @@
+#include "Omega_h_multilevel.hpp"
+
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "Omega_h_array_ops.hpp"
+#include "Omega_h_dist.hpp"
+#include "Omega_h_element.hpp"
+#include "Omega_h_for.hpp"
+#include "Omega_h_int_scan.hpp"
+#include "Omega_h_map.hpp"
+#include "Omega_h_mesh.hpp"
+#include "Omega_h_profile.hpp"
+#include "Omega_h_random.hpp"
+#include "Omega_h_sort.hpp"
+
+namespace Omega_h {
+
+namespace multilevel {
+
+/* the part of a graph stored on one rank.
+   the neighbors of vertex (v) are graph.ab2b[graph.a2ab[v]] through
+   graph.ab2b[graph.a2ab[v + 1] - 1], weighing adj_weights at the
+   same positions, and a neighbor (u >= nverts) is ghost
+   (u - nverts): vertex ghosts.idxs[u - nverts] of rank
+   ghosts.ranks[u - nverts].
+   the graphs bisected on rank zero have no ghosts. */
+struct Level {
+  LO nverts = 0;
+  Reals weights;
+  Graph graph;
+  LOs adj_weights;
+  Remotes ghosts;
+  /* sends values from vertices to their ghosts on other ranks */
+  Dist owners2ghosts;
+};
+
+/* makes the distinct (rank, index) pairs of (remotes), in sorted
+   order, the ghosts of (l) and returns the ghost of each pair */
+static LOs number_ghosts(Level* l, Remotes remotes) {
+  auto n = remotes.idxs.size();
+  auto ranks = remotes.ranks;
+  auto idxs = remotes.idxs;
+  Write<LO> keys(n * 2);
+  auto f = OMEGA_H_LAMBDA(LO i) {
+    keys[i * 2 + 0] = ranks[i];
+    keys[i * 2 + 1] = idxs[i];
+  };
+  parallel_for(n, std::move(f), "multilevel::ghost_keys");
+  auto perm = sort_by_keys(LOs(keys), 2);
+  Write<I8> is_first(n);
+  auto g = OMEGA_H_LAMBDA(LO i) {
+    auto a = perm[i];
+    auto b = (i == 0) ? -1 : perm[i - 1];
+    is_first[i] =
+        (i == 0 || ranks[a] != ranks[b] || idxs[a] != idxs[b]) ? 1 : 0;
+  };
+  parallel_for(n, std::move(g), "multilevel::ghost_firsts");
+  auto firsts = offset_scan(Read<I8>(is_first));
+  auto nghosts = firsts.last();
+  Write<I32> ghost_ranks(nghosts);
+  Write<LO> ghost_idxs(nghosts);
+  Write<LO> out(n);
+  auto h = OMEGA_H_LAMBDA(LO i) {
+    auto a = perm[i];
+    auto ghost = firsts[i + 1] - 1;
+    out[a] = ghost;
+    if (is_first[i]) {
+      ghost_ranks[ghost] = ranks[a];
+      ghost_idxs[ghost] = idxs[a];
+    }
+  };
+  parallel_for(n, std::move(h), "multilevel::number_ghosts");
+  l->ghosts = Remotes(ghost_ranks, ghost_idxs);
+  return out;
+}
+
+static Remotes no_remotes() { return Remotes(Read<I32>(0, 0), LOs(0, 0)); }
+
+static void set_ghosts(CommPtr comm, Level* l) {
+  auto ghosts2owners = Dist(comm, l->ghosts, l->nverts);
+  l->owners2ghosts = ghosts2owners.invert();
+}
+
+template <typename T>
+static Read<T> get_ghost_values(Level const& l, Read<T> values) {
+  return l.owners2ghosts.exch(values, 1);
+}
+
+/* the dual graph of the elements. the element across a
+   partition boundary side is found by summing the number,
+   ranks and indices of the elements adjacent to each copy of
+   the side: a side has at most two elements, so once the sums
+   are reduced over all copies and synced back to them,
+   subtracting the local element leaves the remote one. */
+static Level build_dual(Mesh* mesh, Reals masses) {
+  OMEGA_H_TIME_FUNCTION;
+  auto dim = mesh->dim();
+  auto comm = mesh->comm();
+  auto rank = I64(comm->rank());
+  auto sides2elems = mesh->ask_up(dim - 1, dim);
+  auto side_offsets = sides2elems.a2ab;
+  auto side_elems = sides2elems.ab2b;
+  auto nsides = mesh->nents(dim - 1);
+  Write<I64> side_sums(nsides * 3);
+  auto f = OMEGA_H_LAMBDA(LO s) {
+    I64 rank_sum = 0;
+    I64 idx_sum = 0;
+    for (auto se = side_offsets[s]; se < side_offsets[s + 1]; ++se) {
+      rank_sum += rank;
+      idx_sum += side_elems[se];
+    }
+    side_sums[s * 3 + 0] = side_offsets[s + 1] - side_offsets[s];
+    side_sums[s * 3 + 1] = rank_sum;
+    side_sums[s * 3 + 2] = idx_sum;
+  };
+  parallel_for(nsides, std::move(f), "multilevel::side_sums");
+  auto local_sums = Read<I64>(side_sums);
+  auto global_sums = mesh->sync_array(dim - 1,
+      mesh->reduce_array(dim - 1, local_sums, 3, OMEGA_H_SUM), 3);
+  auto nelems = mesh->nelems();
+  auto dual = mesh->ask_dual();
+  auto dual_offsets = dual.a2ab;
+  auto dual_adj = dual.ab2b;
+  auto elems2sides = mesh->ask_down(dim, dim - 1).ab2b;
+  auto nsides_per_elem = element_degree(mesh->family(), dim, dim - 1);
+  /* the element sides with a remote element across them */
+  Write<I8> are_remote(nelems * nsides_per_elem);
+  auto g = OMEGA_H_LAMBDA(LO es) {
+    auto s = elems2sides[es];
+    are_remote[es] =
+        (local_sums[s * 3 + 0] == 1 && global_sums[s * 3 + 0] == 2) ? 1 : 0;
+  };
+  parallel_for(
+      nelems * nsides_per_elem, std::move(g), "multilevel::remote_sides");
+  auto remote2elem_sides = collect_marked(Read<I8>(are_remote));
+  auto nremote = remote2elem_sides.size();
+  Write<I32> remote_ranks(nremote);
+  Write<LO> remote_idxs(nremote);
+  auto h = OMEGA_H_LAMBDA(LO r) {
+    auto es = remote2elem_sides[r];
+    auto s = elems2sides[es];
+    remote_ranks[r] = I32(global_sums[s * 3 + 1] - rank);
+    remote_idxs[r] = LO(global_sums[s * 3 + 2] - es / nsides_per_elem);
+  };
+  parallel_for(nremote, std::move(h), "multilevel::remote_elems");
+  Level l;
+  l.nverts = nelems;
+  l.weights = masses;
+  auto remote2ghost =
+      number_ghosts(&l, Remotes(remote_ranks, remote_idxs));
+  auto elem_sides2remote = offset_scan(Read<I8>(are_remote));
+  Write<LO> degrees(nelems);
+  auto k = OMEGA_H_LAMBDA(LO e) {
+    degrees[e] = (dual_offsets[e + 1] - dual_offsets[e]) +
+                 (elem_sides2remote[(e + 1) * nsides_per_elem] -
+                     elem_sides2remote[e * nsides_per_elem]);
+  };
+  parallel_for(nelems, std::move(k), "multilevel::dual_degrees");
+  auto offsets = offset_scan(LOs(degrees));
+  Write<LO> adj(offsets.last());
+  auto m = OMEGA_H_LAMBDA(LO e) {
+    auto vu = offsets[e];
+    for (auto ee = dual_offsets[e]; ee < dual_offsets[e + 1]; ++ee) {
+      adj[vu++] = dual_adj[ee];
+    }
+    for (auto r = elem_sides2remote[e * nsides_per_elem];
+         r < elem_sides2remote[(e + 1) * nsides_per_elem]; ++r) {
+      adj[vu++] = nelems + remote2ghost[r];
+    }
+  };
+  parallel_for(nelems, std::move(m), "multilevel::dual_adj");
+  l.graph = Graph(offsets, adj);
+  l.adj_weights = LOs(adj.size(), 1);
+  set_ghosts(comm, &l);
+  return l;
+}
+
+/* heavy-edge matching among the vertices of one rank, by rounds
+   of handshakes: each unmatched vertex proposes to the unmatched
+   neighbor it shares the heaviest edge with, preferring light
+   neighbors and then ones with a higher random priority,
+   unless the pair would weigh more than (max_weight), and two
+   vertices that propose to each other are matched.
+   returns the coarse vertex of each vertex */
+static LOs match(Level const& l, Real max_weight, LO* p_ncoarse) {
+  enum { MAX_ROUNDS = 8 };
+  auto nverts = l.nverts;
+  auto offsets = l.graph.a2ab;
+  auto adj = l.graph.ab2b;
+  auto adj_weights = l.adj_weights;
+  auto weights = l.weights;
+  Write<LO> partners(nverts, -1);
+  Write<LO> proposals(nverts);
+  auto priorities =
+      unit_uniform_random_reals_from_globals(GOs(nverts, 0, 1), 0, 0);
+  for (Int round = 0; round < MAX_ROUNDS; ++round) {
+    auto propose = OMEGA_H_LAMBDA(LO v) {
+      proposals[v] = -1;
+      if (partners[v] != -1) return;
+      LO best = -1;
+      LO best_weight = 0;
+      for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+        auto u = adj[vu];
+        if (u >= nverts || partners[u] != -1) continue;
+        if (weights[v] + weights[u] > max_weight) continue;
+        auto w = adj_weights[vu];
+        if (best == -1 || w > best_weight ||
+            (w == best_weight &&
+                (weights[u] < weights[best] ||
+                    (weights[u] == weights[best] &&
+                        priorities[u] > priorities[best])))) {
+          best = u;
+          best_weight = w;
+        }
+      }
+      proposals[v] = best;
+    };
+    parallel_for(nverts, std::move(propose), "multilevel::propose");
+    Write<I8> matched(nverts);
+    auto accept = OMEGA_H_LAMBDA(LO v) {
+      auto u = proposals[v];
+      matched[v] = (u != -1 && proposals[u] == v) ? 1 : 0;
+      if (matched[v]) partners[v] = u;
+    };
+    parallel_for(nverts, std::move(accept), "multilevel::accept");
+    if (!nverts || get_max(Read<I8>(matched)) == 0) break;
+  }
+  /* each pair is numbered by its lower vertex */
+  Write<I8> are_first(nverts);
+  auto first = OMEGA_H_LAMBDA(LO v) {
+    are_first[v] = (partners[v] == -1 || v < partners[v]) ? 1 : 0;
+  };
+  parallel_for(nverts, std::move(first), "multilevel::pair_firsts");
+  auto firsts2coarse = offset_scan(Read<I8>(are_first));
+  Write<LO> fine2coarse(nverts);
+  auto number = OMEGA_H_LAMBDA(LO v) {
+    auto p = partners[v];
+    fine2coarse[v] = firsts2coarse[(p == -1 || v < p) ? v : p];
+  };
+  parallel_for(nverts, std::move(number), "multilevel::fine2coarse");
+  *p_ncoarse = firsts2coarse.last();
+  return fine2coarse;
+}
+
+/* builds the coarse graph out of the coarse vertex of each
+   vertex and the coarse vertex (on its own rank) of each ghost.
+   the edges of each coarse vertex are first merged into room for
+   all the edges of its fine vertices and then compacted */
+static Level contract(
+    Level const& fine, LOs fine2coarse, LO ncoarse, LOs ghosts2coarse) {
+  auto nfine = fine.nverts;
+  auto offsets = fine.graph.a2ab;
+  auto adj = fine.graph.ab2b;
+  auto adj_weights = fine.adj_weights;
+  Level coarse;
+  coarse.nverts = ncoarse;
+  auto coarse2fine = invert_map_by_sorting(fine2coarse, ncoarse);
+  auto c2cf = coarse2fine.a2ab;
+  auto cf2f = coarse2fine.ab2b;
+  coarse.weights =
+      fan_reduce(c2cf, read(unmap(cf2f, fine.weights, 1)), 1, OMEGA_H_SUM);
+  auto fine_ghosts2coarse_ghosts = number_ghosts(
+      &coarse, Remotes(fine.ghosts.ranks, ghosts2coarse));
+  Write<LO> fine_degrees(ncoarse);
+  auto count = OMEGA_H_LAMBDA(LO c) {
+    fine_degrees[c] = 0;
+    for (auto cf = c2cf[c]; cf < c2cf[c + 1]; ++cf) {
+      auto v = cf2f[cf];
+      fine_degrees[c] += offsets[v + 1] - offsets[v];
+    }
+  };
+  parallel_for(ncoarse, std::move(count), "multilevel::fine_degrees");
+  auto room_offsets = offset_scan(LOs(fine_degrees));
+  Write<LO> room_adj(room_offsets.last());
+  Write<LO> room_weights(room_offsets.last());
+  Write<LO> degrees(ncoarse);
+  auto merge = OMEGA_H_LAMBDA(LO c) {
+    auto begin = room_offsets[c];
+    auto end = begin;
+    for (auto cf = c2cf[c]; cf < c2cf[c + 1]; ++cf) {
+      auto v = cf2f[cf];
+      for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+        auto u = adj[vu];
+        auto cu = (u < nfine)
+                      ? fine2coarse[u]
+                      : ncoarse + fine_ghosts2coarse_ghosts[u - nfine];
+        if (cu == c) continue;
+        auto i = begin;
+        while (i < end && room_adj[i] != cu) ++i;
+        if (i == end) {
+          room_adj[end] = cu;
+          room_weights[end] = 0;
+          ++end;
+        }
+        room_weights[i] += adj_weights[vu];
+      }
+    }
+    degrees[c] = end - begin;
+  };
+  parallel_for(ncoarse, std::move(merge), "multilevel::merge_edges");
+  auto coarse_offsets = offset_scan(LOs(degrees));
+  Write<LO> coarse_adj(coarse_offsets.last());
+  Write<LO> coarse_weights(coarse_offsets.last());
+  auto compact = OMEGA_H_LAMBDA(LO c) {
+    for (LO i = 0; i < degrees[c]; ++i) {
+      coarse_adj[coarse_offsets[c] + i] = room_adj[room_offsets[c] + i];
+      coarse_weights[coarse_offsets[c] + i] = room_weights[room_offsets[c] + i];
+    }
+  };
+  parallel_for(ncoarse, std::move(compact), "multilevel::compact_edges");
+  coarse.graph = Graph(coarse_offsets, coarse_adj);
+  coarse.adj_weights = coarse_weights;
+  return coarse;
+}
+
+/* the subgraph of a single-rank graph induced by (verts) */
+static Level induce(Level const& g, LOs verts) {
+  auto offsets = g.graph.a2ab;
+  auto adj = g.graph.ab2b;
+  auto adj_weights = g.adj_weights;
+  auto old2new = invert_injective_map(verts, g.nverts);
+  Level sub;
+  sub.nverts = verts.size();
+  sub.weights = read(unmap(verts, g.weights, 1));
+  Write<LO> degrees(sub.nverts);
+  auto count = OMEGA_H_LAMBDA(LO i) {
+    auto v = verts[i];
+    degrees[i] = 0;
+    for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+      if (old2new[adj[vu]] != -1) ++degrees[i];
+    }
+  };
+  parallel_for(sub.nverts, std::move(count), "multilevel::induce_degrees");
+  auto sub_offsets = offset_scan(LOs(degrees));
+  Write<LO> sub_adj(sub_offsets.last());
+  Write<LO> sub_weights(sub_offsets.last());
+  auto fill = OMEGA_H_LAMBDA(LO i) {
+    auto v = verts[i];
+    auto ij = sub_offsets[i];
+    for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+      auto j = old2new[adj[vu]];
+      if (j == -1) continue;
+      sub_adj[ij] = j;
+      sub_weights[ij] = adj_weights[vu];
+      ++ij;
+    }
+  };
+  parallel_for(sub.nverts, std::move(fill), "multilevel::induce_adj");
+  sub.graph = Graph(sub_offsets, sub_adj);
+  sub.adj_weights = sub_weights;
+  sub.ghosts = no_remotes();
+  return sub;
+}
+
+static Real get_excess(Real const weights[2], Real const max_weights[2]) {
+  return max2(0.0, weights[0] - max_weights[0]) +
+         max2(0.0, weights[1] - max_weights[1]);
+}
+
+/* orders bisections by how much they overload a side,
+   then by the weight of the edges they cut */
+static bool is_better(Real excess, LO cut, Real best_excess, LO best_cut) {
+  return excess < best_excess || (excess == best_excess && cut < best_cut);
+}
+
+static LO get_cut(Level const& g, Read<I8> sides) {
+  auto offsets = g.graph.a2ab;
+  auto adj = g.graph.ab2b;
+  auto adj_weights = g.adj_weights;
+  Write<LO> vert_cuts(g.nverts);
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    vert_cuts[v] = 0;
+    for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+      if (sides[adj[vu]] != sides[v]) vert_cuts[v] += adj_weights[vu];
+    }
+  };
+  parallel_for(g.nverts, std::move(f), "multilevel::get_cut");
+  return LO(get_sum(LOs(vert_cuts)) / 2);
+}
+
+static void get_side_weights(
+    Level const& g, Read<I8> sides, Real side_weights[2]) {
+  auto weights = g.weights;
+  Write<Real> zero_weights(g.nverts);
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    zero_weights[v] = (sides[v] == 0) ? weights[v] : 0.0;
+  };
+  parallel_for(g.nverts, std::move(f), "multilevel::side_weights");
+  side_weights[0] = get_sum(Reals(zero_weights));
+  side_weights[1] = get_sum(g.weights) - side_weights[0];
+}
+
+/* Fiduccia-Mattheyses refinement of a bisection: each pass
+   moves unlocked boundary vertices one at a time, highest gain
+   first, even when the gain is negative, and then rolls back
+   to the best bisection seen during the pass.
+   this is serial, and only runs on rank zero */
+static Read<I8> refine_bisection(
+    Level const& g, Real const max_weights[2], Read<I8> sides_in) {
+  enum { MAX_PASSES = 8, MAX_FRUITLESS_MOVES = 50 };
+  auto nverts = g.nverts;
+  auto offsets = HostRead<LO>(g.graph.a2ab);
+  auto adj = HostRead<LO>(g.graph.ab2b);
+  auto adj_weights = HostRead<LO>(g.adj_weights);
+  auto vert_weights = HostRead<Real>(g.weights);
+  HostWrite<I8> sides(deep_copy(sides_in));
+  HostWrite<LO> gains(nverts);
+  Real weights[2] = {0.0, 0.0};
+  for (LO v = 0; v < nverts; ++v) {
+    weights[sides[v]] += vert_weights[v];
+    gains[v] = 0;
+    for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+      auto w = adj_weights[vu];
+      gains[v] += (sides[adj[vu]] != sides[v]) ? w : -w;
+    }
+  }
+  auto cut = get_cut(g, sides_in);
+  typedef std::pair<LO, LO> Entry;  // (gain, vertex)
+  std::priority_queue<Entry> queues[2];
+  HostWrite<I8> locked(nverts);
+  auto move = [&](LO v) {
+    auto from = sides[v];
+    auto to = 1 - from;
+    sides[v] = I8(to);
+    weights[from] -= vert_weights[v];
+    weights[to] += vert_weights[v];
+    cut -= gains[v];
+    gains[v] = -gains[v];
+    for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+      auto u = adj[vu];
+      auto w = adj_weights[vu];
+      gains[u] += (sides[u] == to) ? -2 * w : 2 * w;
+      if (!locked[u]) queues[sides[u]].push(Entry(gains[u], u));
+    }
+  };
+  HostWrite<LO> moves(nverts);
+  for (Int pass = 0; pass < MAX_PASSES; ++pass) {
+    for (auto& queue : queues) queue = std::priority_queue<Entry>();
+    for (LO v = 0; v < nverts; ++v) {
+      locked[v] = 0;
+      for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+        if (sides[adj[vu]] != sides[v]) {
+          queues[sides[v]].push(Entry(gains[v], v));
+          break;
+        }
+      }
+    }
+    LO nmoves = 0;
+    auto best_excess = get_excess(weights, max_weights);
+    auto best_cut = cut;
+    LO best_nmoves = 0;
+    LO nfruitless = 0;
+    while (nfruitless < MAX_FRUITLESS_MOVES) {
+      for (auto& queue : queues) {
+        while (!queue.empty() && (locked[queue.top().second] ||
+                                     gains[queue.top().second] !=
+                                         queue.top().first)) {
+          queue.pop();
+        }
+      }
+      Int from = -1;
+      for (Int side = 0; side < 2; ++side) {
+        if (weights[side] > max_weights[side]) from = side;
+      }
+      if (from == -1) {
+        for (Int side = 0; side < 2; ++side) {
+          if (queues[side].empty()) continue;
+          auto v = queues[side].top().second;
+          if (weights[1 - side] + vert_weights[v] > max_weights[1 - side]) {
+            continue;
+          }
+          if (from == -1 || gains[v] > queues[from].top().first) from = side;
+        }
+      }
+      if (from == -1 || queues[from].empty()) break;
+      auto v = queues[from].top().second;
+      queues[from].pop();
+      locked[v] = 1;
+      move(v);
+      moves[nmoves++] = v;
+      auto excess = get_excess(weights, max_weights);
+      if (is_better(excess, cut, best_excess, best_cut)) {
+        best_excess = excess;
+        best_cut = cut;
+        best_nmoves = nmoves;
+        nfruitless = 0;
+      } else {
+        ++nfruitless;
+      }
+    }
+    for (auto i = nmoves; i > best_nmoves; --i) move(moves[i - 1]);
+    if (best_nmoves == 0) break;
+  }
+  return sides.write();
+}
+
+/* grows side zero breadth-first from (seed) until it reaches
+   (target0), restarting elsewhere if a component runs out.
+   this is serial, and only runs on rank zero */
+static Read<I8> grow_bisection(Level const& g, LO seed, Real target0) {
+  auto nverts = g.nverts;
+  auto offsets = HostRead<LO>(g.graph.a2ab);
+  auto adj = HostRead<LO>(g.graph.ab2b);
+  auto weights = HostRead<Real>(g.weights);
+  HostWrite<I8> sides(nverts);
+  HostWrite<I8> queued(nverts);
+  for (LO v = 0; v < nverts; ++v) {
+    sides[v] = 1;
+    queued[v] = 0;
+  }
+  /* every vertex is queued at most once */
+  HostWrite<LO> queue(nverts);
+  LO head = 0;
+  LO tail = 0;
+  queue[tail++] = seed;
+  queued[seed] = 1;
+  Real weight0 = 0.0;
+  LO next_seed = 0;
+  while (weight0 < target0) {
+    if (head == tail) {
+      while (next_seed < nverts && queued[next_seed]) ++next_seed;
+      if (next_seed == nverts) break;
+      queue[tail++] = next_seed;
+      queued[next_seed] = 1;
+    }
+    auto v = queue[head++];
+    sides[v] = 0;
+    weight0 += weights[v];
+    for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+      auto u = adj[vu];
+      if (queued[u]) continue;
+      queue[tail++] = u;
+      queued[u] = 1;
+    }
+  }
+  return sides.write();
+}
+
+/* multilevel bisection of a single-rank graph such that side
+   zero has (fraction) of its weight */
+static Read<I8> bisect(Level const& g, Real fraction, Real tolerance) {
+  enum { COARSEST_SIZE = 64, NSEEDS = 4 };
+  auto total = get_sum(g.weights);
+  auto max_vertex_weight = get_max(g.weights);
+  Real const targets[2] = {fraction * total, (1.0 - fraction) * total};
+  Real max_weights[2];
+  for (Int side = 0; side < 2; ++side) {
+    max_weights[side] = max2(targets[side] * (1.0 + tolerance),
+        targets[side] + max_vertex_weight);
+  }
+  std::vector<Level> levels;
+  std::vector<LOs> maps;
+  levels.push_back(g);
+  auto max_weight = 1.5 * total / Real(COARSEST_SIZE);
+  while (levels.back().nverts > COARSEST_SIZE) {
+    LO ncoarse;
+    auto map = match(levels.back(), max_weight, &ncoarse);
+    if (Real(ncoarse) > 0.95 * Real(levels.back().nverts)) break;
+    auto coarse = contract(levels.back(), map, ncoarse, LOs(0, 0));
+    levels.push_back(std::move(coarse));
+    maps.push_back(map);
+  }
+  auto& coarsest = levels.back();
+  Read<I8> sides;
+  Real best_excess = 0.0;
+  LO best_cut = 0;
+  for (LO i = 0; i < NSEEDS; ++i) {
+    auto seed = LO(I64(coarsest.nverts) * i / NSEEDS);
+    if (i > 0 && seed == LO(I64(coarsest.nverts) * (i - 1) / NSEEDS)) {
+      continue;
+    }
+    auto try_sides = grow_bisection(coarsest, seed, targets[0]);
+    try_sides = refine_bisection(coarsest, max_weights, try_sides);
+    Real try_weights[2];
+    get_side_weights(coarsest, try_sides, try_weights);
+    auto excess = get_excess(try_weights, max_weights);
+    auto cut = get_cut(coarsest, try_sides);
+    if (i == 0 || is_better(excess, cut, best_excess, best_cut)) {
+      sides = try_sides;
+      best_excess = excess;
+      best_cut = cut;
+    }
+  }
+  for (auto i = maps.size(); i > 0; --i) {
+    sides = read(unmap(maps[i - 1], sides, 1));
+    sides = refine_bisection(levels[i - 1], max_weights, sides);
+  }
+  return sides;
+}
+
+/* assigns parts [first_part, first_part + nparts) to the
+   vertices of (g), which are vertices (ids) of the original graph */
+static void recursively_bisect(Level const& g, LOs ids, I32 first_part,
+    Int nparts, Real tolerance, Write<I32> parts) {
+  if (nparts == 1 || g.nverts == 0) {
+    map_value_into(first_part, ids, parts);
+    return;
+  }
+  auto nparts0 = nparts / 2;
+  auto sides = bisect(g, Real(nparts0) / Real(nparts), tolerance);
+  for (Int side = 0; side < 2; ++side) {
+    auto side_verts = collect_marked(each_eq_to(sides, I8(side)));
+    auto side_ids = read(unmap(side_verts, ids, 1));
+    auto side_first = (side == 0) ? first_part : first_part + nparts0;
+    auto side_nparts = (side == 0) ? nparts0 : nparts - nparts0;
+    recursively_bisect(induce(g, side_verts), side_ids, side_first,
+        side_nparts, tolerance, parts);
+  }
+}
+
+/* gathers a distributed graph on rank zero, partitions it there
+   by recursive bisection and returns the part of each vertex */
+static Read<I32> partition_gathered(
+    CommPtr comm, Level const& l, Int nparts, Real tolerance) {
+  OMEGA_H_TIME_FUNCTION;
+  auto is_root = (comm->rank() == 0);
+  auto nverts = l.nverts;
+  auto vert_offset = LO(comm->exscan(GO(nverts), OMEGA_H_SUM));
+  auto nglobal_verts = LO(comm->allreduce(GO(nverts), OMEGA_H_SUM));
+  auto offsets = l.graph.a2ab;
+  auto adj = l.graph.ab2b;
+  auto nedges = adj.size();
+  auto edge_offset = LO(comm->exscan(GO(nedges), OMEGA_H_SUM));
+  auto nglobal_edges = LO(comm->allreduce(GO(nedges), OMEGA_H_SUM));
+  auto globals = LOs(nverts, vert_offset, 1);
+  auto ghost_globals = get_ghost_values(l, globals);
+  Write<LO> edge_ends(nedges * 2);
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+      auto u = adj[vu];
+      edge_ends[vu * 2 + 0] = globals[v];
+      edge_ends[vu * 2 + 1] =
+          (u < nverts) ? globals[u] : ghost_globals[u - nverts];
+    }
+  };
+  parallel_for(nverts, std::move(f), "multilevel::edge_ends");
+  auto verts2root = Dist(comm,
+      Remotes(Read<I32>(nverts, 0), LOs(nverts, vert_offset, 1)),
+      is_root ? nglobal_verts : 0);
+  auto edges2root = Dist(comm,
+      Remotes(Read<I32>(nedges, 0), LOs(nedges, edge_offset, 1)),
+      is_root ? nglobal_edges : 0);
+  auto root_weights = verts2root.exch(l.weights, 1);
+  auto root_ends = edges2root.exch(LOs(edge_ends), 2);
+  auto root_edge_weights = edges2root.exch(l.adj_weights, 1);
+  Read<I32> root_parts(0, 0);
+  if (is_root) {
+    /* the ranks hold consecutive vertices and list their edges
+       in vertex order, so the gathered edges are sorted by the
+       vertex they start from */
+    Level g;
+    g.nverts = nglobal_verts;
+    g.weights = root_weights;
+    auto sources = read(unmap(LOs(nglobal_edges, 0, 2), root_ends, 1));
+    auto targets = read(unmap(LOs(nglobal_edges, 1, 2), root_ends, 1));
+    g.graph = Graph(invert_funnel(sources, nglobal_verts), targets);
+    g.adj_weights = root_edge_weights;
+    g.ghosts = no_remotes();
+    Write<I32> parts(nglobal_verts, 0);
+    /* the imbalance of nested bisections compounds */
+    Int depth = 0;
+    while ((Int(1) << depth) < nparts) ++depth;
+    recursively_bisect(g, LOs(nglobal_verts, 0, 1), 0, nparts,
+        tolerance / Real(depth), parts);
+    root_parts = parts;
+  }
+  return verts2root.invert().exch(root_parts, 1);
+}
+
+/* the total weight of the vertices of each part on this rank */
+static Read<Real> get_part_weights(
+    Reals weights, Read<I32> parts, Int nparts) {
+  auto parts2verts = invert_map_by_sorting(parts, nparts);
+  return fan_reduce(parts2verts.a2ab,
+      read(unmap(parts2verts.ab2b, weights, 1)), 1, OMEGA_H_SUM);
+}
+
+/* greedy boundary refinement of a distributed k-way partition.
+   rounds alternate between only moving vertices to higher parts
+   and only to lower parts, so that two neighbors on different
+   ranks never swap parts on the basis of each other's old part.
+   each rank only takes its share of the room left in a part,
+   in proportion to the weight it would like to move there,
+   and fills it with its highest gain moves first. */
+static Read<I32> refine_partition(CommPtr comm, Level const& l, Int nparts,
+    Real max_part_weight, Read<I32> parts) {
+  OMEGA_H_TIME_FUNCTION;
+  enum { MAX_ROUNDS = 8 };
+  auto nverts = l.nverts;
+  auto offsets = l.graph.a2ab;
+  auto adj = l.graph.ab2b;
+  auto adj_weights = l.adj_weights;
+  auto weights = l.weights;
+  Int nidle = 0;
+  for (Int round = 0; round < MAX_ROUNDS && nidle < 2; ++round) {
+    auto upward = (round % 2 == 0);
+    auto part_weights = comm->allreduce(
+        get_part_weights(weights, parts, nparts), OMEGA_H_SUM);
+    auto ghost_parts = get_ghost_values(l, parts);
+    Write<I32> targets(nverts);
+    Write<LO> gains(nverts);
+    auto f = OMEGA_H_LAMBDA(LO v) {
+      auto from = parts[v];
+      LO internal = 0;
+      for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+        auto u = adj[vu];
+        auto part = (u < nverts) ? parts[u] : ghost_parts[u - nverts];
+        if (part == from) internal += adj_weights[vu];
+      }
+      I32 best_part = -1;
+      LO best_gain = 0;
+      for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+        auto u = adj[vu];
+        auto to = (u < nverts) ? parts[u] : ghost_parts[u - nverts];
+        if (to == from || upward != (to > from)) continue;
+        if (part_weights[to] + weights[v] > max_part_weight) continue;
+        /* each part is weighed at its first edge */
+        auto vw = offsets[v];
+        for (; vw < vu; ++vw) {
+          auto w = adj[vw];
+          if (((w < nverts) ? parts[w] : ghost_parts[w - nverts]) == to) break;
+        }
+        if (vw < vu) continue;
+        LO connection = 0;
+        for (; vw < offsets[v + 1]; ++vw) {
+          auto w = adj[vw];
+          auto part = (w < nverts) ? parts[w] : ghost_parts[w - nverts];
+          if (part == to) connection += adj_weights[vw];
+        }
+        auto gain = connection - internal;
+        if (best_part == -1 || gain > best_gain ||
+            (gain == best_gain &&
+                part_weights[to] < part_weights[best_part])) {
+          best_gain = gain;
+          best_part = to;
+        }
+      }
+      if (best_part != -1 && best_gain <= 0 &&
+          part_weights[from] <= max_part_weight) {
+        best_part = -1;
+      }
+      targets[v] = best_part;
+      gains[v] = best_gain;
+    };
+    parallel_for(nverts, std::move(f), "multilevel::best_moves");
+    auto movers2verts = collect_marked(each_geq_to(Read<I32>(targets), 0));
+    auto nmovers = movers2verts.size();
+    if (comm->allreduce(GO(nmovers), OMEGA_H_SUM) == 0) {
+      ++nidle;
+      continue;
+    }
+    nidle = 0;
+    auto mover_targets = read(unmap(movers2verts, Read<I32>(targets), 1));
+    auto mover_weights = read(unmap(movers2verts, weights, 1));
+    auto mover_gains = read(unmap(movers2verts, LOs(gains), 1));
+    auto incoming = get_part_weights(mover_weights, mover_targets, nparts);
+    auto total_incoming = comm->allreduce(incoming, OMEGA_H_SUM);
+    /* the moves into each part, highest gain first */
+    Write<LO> keys(nmovers * 2);
+    auto g = OMEGA_H_LAMBDA(LO m) {
+      keys[m * 2 + 0] = mover_targets[m];
+      keys[m * 2 + 1] = -mover_gains[m];
+    };
+    parallel_for(nmovers, std::move(g), "multilevel::move_keys");
+    auto sorted2movers = sort_by_keys(LOs(keys), 2);
+    auto parts2sorted = invert_funnel(
+        unmap(sorted2movers, mover_targets, 1), nparts);
+    auto new_parts = deep_copy(parts);
+    auto h = OMEGA_H_LAMBDA(LO to) {
+      auto room = max_part_weight - part_weights[to];
+      auto share = incoming[to] * min2(1.0, room / total_incoming[to]);
+      Real accepted = 0.0;
+      for (auto i = parts2sorted[to]; i < parts2sorted[to + 1]; ++i) {
+        auto m = sorted2movers[i];
+        if (accepted + mover_weights[m] > share) continue;
+        accepted += mover_weights[m];
+        new_parts[movers2verts[m]] = to;
+      }
+    };
+    parallel_for(nparts, std::move(h), "multilevel::accept_moves");
+    parts = new_parts;
+  }
+  return parts;
+}
+
+Read<I32> partition(Mesh* mesh, Reals masses, Int nparts, Real tolerance) {
+  OMEGA_H_TIME_FUNCTION;
+  OMEGA_H_CHECK(mesh->parting() == OMEGA_H_ELEM_BASED);
+  OMEGA_H_CHECK(masses.size() == mesh->nelems());
+  if (nparts == 1) return Read<I32>(mesh->nelems(), 0);
+  auto comm = mesh->comm();
+  auto total_weight = get_sum(comm, masses);
+  auto average_weight = total_weight / Real(nparts);
+  auto max_part_weight = max2(average_weight * (1.0 + tolerance),
+      average_weight + get_max(comm, masses));
+  /* local matching stops once the graph is small enough to
+     gather, or when the partition boundaries keep it from
+     shrinking */
+  auto const coarsest_size = GO(nparts) * 32;
+  auto const max_coarse_weight = 1.5 * total_weight / Real(coarsest_size);
+  std::vector<Level> levels;
+  std::vector<LOs> maps;
+  levels.push_back(build_dual(mesh, masses));
+  while (true) {
+    auto& fine = levels.back();
+    auto nglobal = comm->allreduce(GO(fine.nverts), OMEGA_H_SUM);
+    if (nglobal <= coarsest_size) break;
+    LO ncoarse;
+    auto map = match(fine, max_coarse_weight, &ncoarse);
+    auto nglobal_coarse = comm->allreduce(GO(ncoarse), OMEGA_H_SUM);
+    if (Real(nglobal_coarse) > 0.95 * Real(nglobal)) break;
+    auto coarse = contract(fine, map, ncoarse, get_ghost_values(fine, map));
+    set_ghosts(comm, &coarse);
+    levels.push_back(std::move(coarse));
+    maps.push_back(map);
+  }
+  auto parts = partition_gathered(comm, levels.back(), nparts, tolerance);
+  parts = refine_partition(comm, levels.back(), nparts, max_part_weight, parts);
+  for (auto i = maps.size(); i > 0; --i) {
+    parts = read(unmap(maps[i - 1], parts, 1));
+    parts =
+        refine_partition(comm, levels[i - 1], nparts, max_part_weight, parts);
+  }
+  return parts;
+}
+
+GO edge_cut(Mesh* mesh, Read<I32> parts) {
+  OMEGA_H_CHECK(mesh->parting() == OMEGA_H_ELEM_BASED);
+  auto l = build_dual(mesh, Reals(mesh->nelems(), 1.0));
+  auto nverts = l.nverts;
+  auto offsets = l.graph.a2ab;
+  auto adj = l.graph.ab2b;
+  auto adj_weights = l.adj_weights;
+  auto ghost_parts = get_ghost_values(l, parts);
+  Write<LO> vert_cuts(nverts);
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    vert_cuts[v] = 0;
+    for (auto vu = offsets[v]; vu < offsets[v + 1]; ++vu) {
+      auto u = adj[vu];
+      auto part = (u < nverts) ? parts[u] : ghost_parts[u - nverts];
+      if (part != parts[v]) vert_cuts[v] += adj_weights[vu];
+    }
+  };
+  parallel_for(nverts, std::move(f), "multilevel::edge_cut");
+  /* every edge was seen from both of its ends */
+  return GO(get_sum(mesh->comm(), LOs(vert_cuts))) / 2;
+}
+
+}  // end namespace multilevel
+
+}  // end namespace Omega_h
@@ -0,0 +1,42 @@
+#ifndef OMEGA_H_MULTILEVEL_HPP
+#define OMEGA_H_MULTILEVEL_HPP
+
+#include "Omega_h_array.hpp"
+
+namespace Omega_h {
+
+class Mesh;
+
+namespace multilevel {
+
+/* partitions the elements of an element-based mesh into (nparts)
+   parts by multilevel partitioning of the dual graph.
+   heavy-edge matching coarsens the graph within each rank,
+   the coarsest graph is gathered to rank zero and split by
+   recursive multilevel bisection with Fiduccia-Mattheyses
+   refinement, and the parts are projected back through the
+   distributed levels with boundary refinement at each one.
+   all but the gathered stage run in parallel over the vertices
+   of each rank.
+   the gathered graph aims at 32 * nparts vertices, but coarsening
+   stops early once a round shrinks it by less than 5 percent, and
+   since vertices only match within their rank, each rank keeps at
+   least one vertex per connected piece of its elements. rank zero
+   holds the whole gathered graph with its edges and bisects it
+   serially, in time about linear in its size per level of the
+   log2(nparts) levels of bisection, which limits how far this
+   scales with nparts and with the number of ranks.
+   no part will weigh much more than (1 + tolerance) times
+   the average, where (masses) are the element weights.
+   returns the part of each element */
+Read<I32> partition(Mesh* mesh, Reals masses, Int nparts, Real tolerance);
+
+/* the total weight of the dual graph edges between elements
+   of different parts, summed over all ranks */
+GO edge_cut(Mesh* mesh, Read<I32> parts);
+
+}  // end namespace multilevel
+
+}  // end namespace Omega_h
+
+#endif
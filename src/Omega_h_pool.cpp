@@ -1,76 +1,159 @@
 #include <Omega_h_fail.hpp>
 #include <Omega_h_pool.hpp>
-#include <Omega_h_profile.hpp>
 #include <algorithm>
+#include <iostream>
 
 namespace Omega_h {
 
+static std::size_t floor_log2(std::size_t x) {
+  std::size_t p = 0;
+  while (x >>= 1) ++p;
+  return p;
+}
+
+/* sizes 1 through 4 have their own classes,
+   above that size class 4*(p-1)+j holds blocks of
+   2^p + j*2^(p-2) bytes for j in [1,4] */
+std::size_t get_pool_class(std::size_t size) {
+  if (size <= pool_nsubclasses) return std::max(size, std::size_t(1));
+  auto const p = floor_log2(size - 1);
+  auto const step = std::size_t(1) << (p - 2);
+  auto const j = ((size - (std::size_t(1) << p)) + step - 1) / step;
+  return pool_nsubclasses * (p - 1) + j;
+}
+
+std::size_t get_pool_class_size(std::size_t size_class) {
+  if (size_class <= pool_nsubclasses) return size_class;
+  auto const p = (size_class - 1) / pool_nsubclasses + 1;
+  auto const j = size_class - pool_nsubclasses * (p - 1);
+  return (std::size_t(1) << p) + j * (std::size_t(1) << (p - 2));
+}
+
 static void call_underlying_frees(Pool& pool, BlockList list[]) {
-  for (std::size_t i = 0; i < 64; ++i) {
+  for (std::size_t i = 0; i < pool_nclasses; ++i) {
     for (auto block : list[i]) {
-      pool.underlying_free(block, (std::size_t(1) << i));
+      pool.underlying_free(block, get_pool_class_size(i));
+      pool.stats.cached_bytes -= get_pool_class_size(i);
     }
     list[i].clear();
   }
 }
 
+static void call_all_underlying_frees(Pool& pool) {
+  call_underlying_frees(pool, pool.free_blocks);
+}
+
 Pool::Pool(MallocFunc malloc_in, FreeFunc free_in)
-    : underlying_malloc(malloc_in), underlying_free(free_in) {}
+    : stats(), underlying_malloc(malloc_in), underlying_free(free_in) {}
 
 Pool::~Pool() {
-  call_underlying_frees(*this, used_blocks);
-  call_underlying_frees(*this, free_blocks);
+  for (auto& entry : used_blocks) {
+    underlying_free(entry.first, get_pool_class_size(entry.second.size_class));
+  }
+  used_blocks.clear();
+  call_all_underlying_frees(*this);
 }
 
 static std::size_t underlying_total_size(Pool& pool) {
-  std::size_t total_size = 0;
-  for (std::size_t i = 0; i < 64; ++i) {
-    total_size += (std::size_t(1) << i) * pool.used_blocks[i].size();
-    total_size += (std::size_t(1) << i) * pool.free_blocks[i].size();
-  }
-  return total_size;
+  return pool.stats.used_bytes + pool.stats.cached_bytes;
 }
 
-void* allocate(Pool& pool, std::size_t size) {
-  ScopedTimer timer("pool allocate");
-  std::size_t shift;
-  for (shift = 0; ((std::size_t(1) << shift) < size); ++shift)
-    ;
-  if (!pool.free_blocks[shift].empty()) {
-    auto const data = pool.free_blocks[shift].back();
-    pool.used_blocks[shift].push_back(data);
-    pool.free_blocks[shift].pop_back();
+static void* take_free_block(Pool& pool, std::size_t size_class) {
+  if (!pool.free_blocks[size_class].empty()) {
+    auto const data = pool.free_blocks[size_class].back();
+    pool.free_blocks[size_class].pop_back();
     return data;
   }
-  auto const size_to_alloc = (std::size_t(1) << shift);
-  auto data = pool.underlying_malloc(size_to_alloc);
-  if (data == nullptr) {
-    call_underlying_frees(pool, pool.free_blocks);
-    data = pool.underlying_malloc(size_to_alloc);
-  }
-  if (data == nullptr) {
-    Omega_h_fail(
-        "Pool failed to allocate %zu bytes, %zu bytes already allocated\n",
-        size_to_alloc, underlying_total_size(pool));
+  return nullptr;
+}
+
+void* allocate(Pool& pool, std::size_t size) {
+#ifdef OMEGA_H_USE_OPENMP
+  std::lock_guard<std::mutex> lock(pool.mutex);
+#endif
+  auto const size_class = get_pool_class(size);
+  auto const class_size = get_pool_class_size(size_class);
+  ++pool.stats.nallocations;
+  auto data = take_free_block(pool, size_class);
+  if (data != nullptr) {
+    ++pool.stats.nreuses;
+    pool.stats.cached_bytes -= class_size;
+  } else {
+    data = pool.underlying_malloc(class_size);
+    if (data == nullptr) {
+      call_all_underlying_frees(pool);
+      data = pool.underlying_malloc(class_size);
+    }
+    if (data == nullptr) {
+      Omega_h_fail(
+          "Pool failed to allocate %zu bytes, %zu bytes already allocated\n",
+          class_size, underlying_total_size(pool));
+    }
+    ++pool.stats.nunderlying_allocations;
   }
-  pool.used_blocks[shift].push_back(data);
+  pool.used_blocks[data] = PoolBlock{size_class, size};
+  pool.stats.requested_bytes += size;
+  pool.stats.used_bytes += class_size;
+  pool.stats.high_water_bytes =
+      std::max(pool.stats.high_water_bytes, underlying_total_size(pool));
   return data;
 }
 
 void deallocate(Pool& pool, void* data, std::size_t size) {
-  ScopedTimer timer("pool deallocate");
-  std::size_t shift;
-  for (shift = 0; ((std::size_t(1) << shift) < size); ++shift)
-    ;
-  auto const end = pool.used_blocks[shift].end();
-  auto const it = std::find_if(pool.used_blocks[shift].begin(), end,
-      [=](VoidPtr b) -> bool { return b == data; });
-  if (it == end) {
+#ifdef OMEGA_H_USE_OPENMP
+  std::lock_guard<std::mutex> lock(pool.mutex);
+#endif
+  auto const it = pool.used_blocks.find(data);
+  if (it == pool.used_blocks.end()) {
     Omega_h_fail(
         "Tried to deallocate %p from pool, but pool didn't allocate it\n",
         data);
   }
-  pool.free_blocks[shift].push_back(*it);
-  pool.used_blocks[shift].erase(it);
+  auto const block = it->second;
+  if (block.size_class != get_pool_class(size)) {
+    Omega_h_fail(
+        "Tried to deallocate %p from pool with size %zu, "
+        "but it was allocated with size %zu\n",
+        data, size, block.requested_size);
+  }
+  pool.used_blocks.erase(it);
+  auto const class_size = get_pool_class_size(block.size_class);
+  ++pool.stats.ndeallocations;
+  pool.stats.requested_bytes -= block.requested_size;
+  pool.stats.used_bytes -= class_size;
+  pool.stats.cached_bytes += class_size;
+  pool.free_blocks[block.size_class].push_back(data);
+}
+
+PoolStats get_stats(Pool& pool) {
+#ifdef OMEGA_H_USE_OPENMP
+  std::lock_guard<std::mutex> lock(pool.mutex);
+#endif
+  return pool.stats;
+}
+
+double internal_fragmentation(PoolStats const& stats) {
+  if (stats.used_bytes == 0) return 0.0;
+  return double(stats.used_bytes - stats.requested_bytes) /
+         double(stats.used_bytes);
+}
+
+double cached_fraction(PoolStats const& stats) {
+  auto const total = stats.used_bytes + stats.cached_bytes;
+  if (total == 0) return 0.0;
+  return double(stats.cached_bytes) / double(total);
+}
+
+void print_pool_stats(std::ostream& stream, PoolStats const& stats) {
+  stream << "pool high water mark: " << stats.high_water_bytes << " bytes\n";
+  stream << "pool bytes in use: " << stats.used_bytes << " ("
+         << stats.requested_bytes << " requested, "
+         << internal_fragmentation(stats) * 100.0 << "% padding)\n";
+  stream << "pool bytes cached: " << stats.cached_bytes << " ("
+         << cached_fraction(stats) * 100.0 << "% of pool)\n";
+  stream << "pool allocations: " << stats.nallocations << " ("
+         << stats.nreuses << " reused, " << stats.nunderlying_allocations
+         << " underlying)\n";
+  stream << "pool deallocations: " << stats.ndeallocations << '\n';
 }
 }  // namespace Omega_h
@@ -1,9 +1,17 @@
 #ifndef OMEGA_H_POOL_HPP
 #define OMEGA_H_POOL_HPP
 
+#include <Omega_h_config.h>
+#include <cstddef>
 #include <functional>
+#include <iosfwd>
+#include <unordered_map>
 #include <vector>
 
+#ifdef OMEGA_H_USE_OPENMP
+#include <mutex>
+#endif
+
 namespace Omega_h {
 
 using VoidPtr = void*;
@@ -11,6 +19,43 @@ using BlockList = std::vector<VoidPtr>;
 using MallocFunc = std::function<VoidPtr(std::size_t)>;
 using FreeFunc = std::function<void(VoidPtr, std::size_t)>;
 
+/* Block sizes are rounded up to one of four size classes
+   per power of two (2^p * {1.25, 1.5, 1.75, 2}),
+   which bounds the padding waste to 25% instead of 100%. */
+constexpr std::size_t pool_nsubclasses = 4;
+constexpr std::size_t pool_nclasses = 256;
+
+std::size_t get_pool_class(std::size_t size);
+std::size_t get_pool_class_size(std::size_t size_class);
+
+struct PoolStats {
+  /* bytes currently handed out, as requested by callers */
+  std::size_t requested_bytes;
+  /* bytes currently handed out, after rounding up to size classes */
+  std::size_t used_bytes;
+  /* bytes held in free lists, ready for reuse */
+  std::size_t cached_bytes;
+  /* maximum of (used_bytes + cached_bytes) over the pool's lifetime */
+  std::size_t high_water_bytes;
+  std::size_t nallocations;
+  std::size_t ndeallocations;
+  /* allocations satisfied from a free list */
+  std::size_t nreuses;
+  /* allocations that had to go to the underlying allocator */
+  std::size_t nunderlying_allocations;
+};
+
+/* (used_bytes - requested_bytes) / used_bytes */
+double internal_fragmentation(PoolStats const& stats);
+/* cached_bytes / (used_bytes + cached_bytes) */
+double cached_fraction(PoolStats const& stats);
+void print_pool_stats(std::ostream& stream, PoolStats const& stats);
+
+struct PoolBlock {
+  std::size_t size_class;
+  std::size_t requested_size;
+};
+
 struct Pool {
   Pool(MallocFunc, FreeFunc);
   ~Pool();
@@ -18,14 +63,20 @@ struct Pool {
   Pool(Pool&&) = delete;
   Pool& operator=(Pool const&) = delete;
   Pool& operator=(Pool&&) = delete;
-  BlockList used_blocks[64];
-  BlockList free_blocks[64];
+  /* ownership of live blocks, for O(1) deallocation */
+  std::unordered_map<VoidPtr, PoolBlock> used_blocks;
+  BlockList free_blocks[pool_nclasses];
+  PoolStats stats;
   MallocFunc underlying_malloc;
   FreeFunc underlying_free;
+#ifdef OMEGA_H_USE_OPENMP
+  std::mutex mutex;
+#endif
 };
 
 void* allocate(Pool&, std::size_t);
 void deallocate(Pool&, void*, std::size_t);
+PoolStats get_stats(Pool&);
 }  // namespace Omega_h
 
 #endif
@@ -18,7 +18,8 @@ OMEGA_H_DLL History* global_singleton_history = nullptr;
 
 History::History(CommPtr comm_in, bool dopercent, double chop_in, bool add_filename_in) : 
   current_frame(invalid), last_root(invalid), start_time(now()), 
-  do_percent(dopercent), chop(chop_in), add_filename(add_filename_in), comm(comm_in) {}
+  do_percent(dopercent), chop(chop_in), add_filename(add_filename_in), comm(comm_in),
+  thread(std::this_thread::get_id()) {}
 
 History::History(const History& h) {
   start_time = h.start_time;
@@ -26,6 +27,7 @@ History::History(const History& h) {
   chop = h.chop;
   add_filename = h.add_filename;
   comm = h.comm;
+  thread = h.thread;
 }
 
 std::size_t History::first(std::size_t parent_index) const {
@@ -68,6 +70,20 @@ std::size_t History::calls(std::size_t frame) const {
   return frames[frame].number_of_calls;
 }
 
+double total_time(History const& h, char const* name) {
+  double result = 0.0;
+  for (std::size_t frame = 0; frame < h.frames.size(); ++frame) {
+    if (0 != std::strcmp(h.get_name(frame), name)) continue;
+    /* recursive calls are already included in the outer ones */
+    bool nested = false;
+    for (auto p = h.parent(frame); p != invalid; p = h.parent(p)) {
+      if (0 == std::strcmp(h.get_name(p), name)) nested = true;
+    }
+    if (!nested) result += h.time(frame);
+  }
+  return result;
+}
+
 struct PreOrderIterator {
   using reference = std::size_t;
   PreOrderIterator& operator++() {
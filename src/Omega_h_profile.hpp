@@ -6,6 +6,7 @@
 #include <cstring>
 #include <vector>
 #include <memory>
+#include <thread>
 #ifdef OMEGA_H_USE_KOKKOS
 #include <Omega_h_kokkos.hpp>
 #endif
@@ -54,6 +55,9 @@ struct History {
   double chop;
   bool add_filename;
   CommPtr comm;
+  /* the history is not thread safe, so only the thread that
+     created it records into it */
+  std::thread::id thread;
   History(CommPtr comm = nullptr, bool dopercent=false, double chop=0.0, bool add_filename=false);
   History(const History& h);
   inline const char* get_name(std::size_t frame) const {
@@ -176,17 +180,26 @@ History invert(History const& h);
 void print_time_sorted(History const& h);
 void print_top_down_and_bottom_up(History const& h, double total_runtime);
 void print_top_sorted(History const& h, double total_runtime);
+/* the time spent in all calls of the timer (name) on this rank,
+   wherever it was called from */
+double total_time(History const& h, char const* name);
 
 }  // namespace profile
 }  // namespace Omega_h
 
 namespace Omega_h {
 
+inline bool is_profiled_thread() {
+  return profile::global_singleton_history &&
+         profile::global_singleton_history->thread ==
+             std::this_thread::get_id();
+}
+
 inline void begin_code(char const* name, char const* file=0) {
 #ifdef OMEGA_H_USE_KOKKOS
   Kokkos::Profiling::pushRegion(name);
 #endif
-  if (profile::global_singleton_history) {
+  if (is_profiled_thread()) {
     if (file == 0) {
       file = "Omega_h";
     }
@@ -211,7 +224,7 @@ inline void end_code() {
 #ifdef OMEGA_H_USE_KOKKOS
   Kokkos::Profiling::popRegion();
 #endif
-  if (profile::global_singleton_history) {
+  if (is_profiled_thread()) {
     profile::global_singleton_history->stop();
   }
 }
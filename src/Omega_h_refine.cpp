@@ -14,7 +14,7 @@
 
 namespace Omega_h {
 
-static bool refine_ghosted(Mesh* mesh, AdaptOpts const& opts) {
+bool refine_ghosted(Mesh* mesh, AdaptOpts const& opts) {
   auto comm = mesh->comm();
   auto edges_are_cands = mesh->get_array<I8>(EDGE, "candidate");
   mesh->remove_tag(EDGE, "candidate");
@@ -53,6 +53,7 @@ static void refine_element_based(Mesh* mesh, AdaptOpts const& opts) {
   auto keys2midverts = LOs();
   auto old_verts2new_verts = LOs();
   auto old_lows2new_lows = LOs();
+  Few<LOs, 4> old_ents2new_ents_by_dim;
   for (Int ent_dim = 0; ent_dim <= mesh->dim(); ++ent_dim) {
     auto keys2prods = LOs();
     auto prod_verts2verts = LOs();
@@ -69,6 +70,9 @@ static void refine_element_based(Mesh* mesh, AdaptOpts const& opts) {
     modify_ents_adapt(mesh, &new_mesh, ent_dim, EDGE, keys2edges, keys2prods,
         prod_verts2verts, old_lows2new_lows, &prods2new_ents,
         &same_ents2old_ents, &same_ents2new_ents, &old_ents2new_ents);
+    old_ents2new_ents_by_dim[ent_dim] = old_ents2new_ents;
+    modify_adjs(mesh, &new_mesh, ent_dim, old_ents2new_ents_by_dim,
+        prods2new_ents);
     if (ent_dim == VERT) {
       keys2midverts = prods2new_ents;
       old_verts2new_verts = old_ents2new_ents;
@@ -93,7 +97,8 @@ bool refine_by_size(Mesh* mesh, AdaptOpts const& opts) {
   OMEGA_H_TIME_FUNCTION;
   auto comm = mesh->comm();
   auto lengths = mesh->ask_lengths();
-  auto edge_is_cand = each_gt(lengths, opts.max_length_desired);
+  auto edge_is_cand = restrict_to_region(
+      mesh, opts, EDGE, each_gt(lengths, opts.max_length_desired));
   if (get_max(comm, edge_is_cand) != 1) return false;
   mesh->add_tag(EDGE, "candidate", 1, edge_is_cand);
   return refine(mesh, opts);
@@ -7,6 +7,10 @@ namespace Omega_h {
 
 bool refine_by_size(Mesh* mesh, AdaptOpts const& opts);
 
+/* on a ghosted mesh, chooses and tags as "key" the edges to split
+   among those tagged "candidate" */
+bool refine_ghosted(Mesh* mesh, AdaptOpts const& opts);
+
 }  // end namespace Omega_h
 
 #endif
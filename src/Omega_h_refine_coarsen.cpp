@@ -0,0 +1,248 @@
+#include "Omega_h_refine_coarsen.hpp"
+
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "Omega_h_array_ops.hpp"
+#include "Omega_h_coarsen.hpp"
+#include "Omega_h_map.hpp"
+#include "Omega_h_mark.hpp"
+#include "Omega_h_mesh.hpp"
+#include "Omega_h_modify.hpp"
+#include "Omega_h_profile.hpp"
+#include "Omega_h_refine.hpp"
+#include "Omega_h_refine_topology.hpp"
+#include "Omega_h_transfer.hpp"
+
+namespace Omega_h {
+
+/* the transfer functions each build whole new tags, so the values
+   transfer_refine gave to the split cavities are set aside and
+   written back over whatever transfer_coarsen leaves there.
+   a tag transfer_coarsen does not rebuild is one the coarsening
+   pass would have dropped, so it is removed */
+template <typename T>
+static std::function<void()> save_refined(
+    Mesh* new_mesh, Int ent_dim, std::string const& name, LOs prods2new_ents) {
+  auto refined = new_mesh->get_array<T>(ent_dim, name);
+  auto ncomps = new_mesh->get_tagbase(ent_dim, name)->ncomps();
+  return [=]() {
+    auto coarsened = new_mesh->get_array<T>(ent_dim, name);
+    if (coarsened.data() == refined.data()) {
+      new_mesh->remove_tag(ent_dim, name);
+      return;
+    }
+    auto merged = deep_copy(coarsened);
+    auto prod_data = read(unmap(prods2new_ents, refined, ncomps));
+    map_into(prod_data, prods2new_ents, merged, ncomps);
+    new_mesh->set_tag(ent_dim, name, read(merged), true);
+  };
+}
+
+static std::vector<std::function<void()>> save_refined_tags(Mesh* new_mesh,
+    Int ent_dim, std::vector<std::string> const& old_names,
+    LOs prods2new_ents) {
+  std::vector<std::function<void()>> restores;
+  for (Int i = 0; i < new_mesh->ntags(ent_dim); ++i) {
+    auto tagbase = new_mesh->get_tag(ent_dim, i);
+    auto& name = tagbase->name();
+    bool is_old = false;
+    for (auto& old_name : old_names) is_old = is_old || (old_name == name);
+    if (is_old) continue;
+    switch (tagbase->type()) {
+      case OMEGA_H_I8:
+        restores.push_back(
+            save_refined<I8>(new_mesh, ent_dim, name, prods2new_ents));
+        break;
+      case OMEGA_H_I32:
+        restores.push_back(
+            save_refined<I32>(new_mesh, ent_dim, name, prods2new_ents));
+        break;
+      case OMEGA_H_I64:
+        restores.push_back(
+            save_refined<I64>(new_mesh, ent_dim, name, prods2new_ents));
+        break;
+      case OMEGA_H_F64:
+        restores.push_back(
+            save_refined<Real>(new_mesh, ent_dim, name, prods2new_ents));
+        break;
+    }
+  }
+  return restores;
+}
+
+static LOs concat_lists(LOs a, LOs b) {
+  Write<LO> out(a.size() + b.size());
+  map_into_range(a, 0, a.size(), out, 1);
+  map_into_range(b, a.size(), out.size(), out, 1);
+  return out;
+}
+
+static void refine_coarsen_element_based(
+    Mesh* mesh, AdaptOpts const& opts, bool do_refine, bool do_coarsen) {
+  auto comm = mesh->comm();
+  auto dim = mesh->dim();
+  auto keys2edges = LOs({});
+  if (do_refine) {
+    keys2edges = collect_marked(mesh->get_array<I8>(EDGE, "key"));
+  }
+  auto keys2verts = LOs({});
+  auto rails2edges = LOs();
+  auto rail_col_dirs = Read<I8>();
+  HostFew<Read<I8>, 4> dead_ents;
+  auto keys2verts_onto = LOs();
+  if (do_coarsen) {
+    auto verts_are_keys = mesh->get_array<I8>(VERT, "key");
+    auto vert_rails = mesh->get_array<GO>(VERT, "collapse_rail");
+    mesh->remove_tag(VERT, "collapse_rail");
+    keys2verts = collect_marked(verts_are_keys);
+    find_rails(mesh, keys2verts, vert_rails, &rails2edges, &rail_col_dirs);
+    dead_ents = mark_dead_ents(mesh, rails2edges, rail_col_dirs);
+    keys2verts_onto = get_verts_onto(mesh, rails2edges, rail_col_dirs);
+  }
+  if (opts.verbosity >= EACH_REBUILD) {
+    auto nsplits = comm->allreduce(GO(keys2edges.size()), OMEGA_H_SUM);
+    auto ncollapses = comm->allreduce(GO(keys2verts.size()), OMEGA_H_SUM);
+    if (comm->rank() == 0) {
+      std::cout << "refining " << nsplits << " edges and coarsening "
+                << ncollapses << " vertices\n";
+    }
+  }
+  /* which old entities either operation replaces, by dimension */
+  Few<Bytes, 4> mds_are_mods;
+  auto edges_are_keys = mark_image(keys2edges, mesh->nedges());
+  auto verts_are_keys = mark_image(keys2verts, mesh->nverts());
+  mds_are_mods[VERT] = verts_are_keys;
+  mds_are_mods[EDGE] =
+      lor_each(edges_are_keys, mark_up(mesh, VERT, EDGE, verts_are_keys));
+  for (Int mod_dim = EDGE + 1; mod_dim <= dim; ++mod_dim) {
+    mds_are_mods[mod_dim] =
+        lor_each(mark_up(mesh, EDGE, mod_dim, edges_are_keys),
+            mark_up(mesh, VERT, mod_dim, verts_are_keys));
+  }
+  Few<LOs, 4> mods2mds;
+  if (do_coarsen) mods2mds[VERT] = keys2verts;
+  if (do_refine) mods2mds[EDGE] = keys2edges;
+  auto new_mesh = mesh->copy_meta();
+  auto keys2midverts = LOs();
+  auto old_verts2new_verts = LOs();
+  auto old_lows2new_lows = LOs();
+  Few<LOs, 4> old_ents2new_ents_by_dim;
+  for (Int ent_dim = 0; ent_dim <= dim; ++ent_dim) {
+    /* the collapse products are numbered first, then the splits */
+    auto c_keys2prods = LOs();
+    auto c_prod_verts2verts = LOs({});
+    auto keys2doms = Adj();
+    if (do_coarsen && ent_dim == VERT) {
+      c_keys2prods = LOs(keys2verts.size() + 1, 0);
+    } else if (do_coarsen) {
+      keys2doms =
+          find_coarsen_domains(mesh, keys2verts, ent_dim, dead_ents[ent_dim]);
+      c_keys2prods = keys2doms.a2ab;
+      c_prod_verts2verts = coarsen_topology(
+          mesh, keys2verts_onto, ent_dim, keys2doms, old_verts2new_verts);
+    }
+    auto r_keys2prods = LOs();
+    auto r_prod_verts2verts = LOs({});
+    if (do_refine && ent_dim == VERT) {
+      r_keys2prods = LOs(keys2edges.size() + 1, 0, 1);
+    } else if (do_refine) {
+      refine_products(mesh, ent_dim, keys2edges, keys2midverts,
+          old_verts2new_verts, r_keys2prods, r_prod_verts2verts);
+    }
+    LO nc_prods = do_coarsen ? c_keys2prods.last() : 0;
+    Few<LOs, 4> mods2prods;
+    if (do_coarsen) mods2prods[VERT] = c_keys2prods;
+    if (do_refine) mods2prods[EDGE] = add_to_each(r_keys2prods, nc_prods);
+    auto prod_verts2verts = LOs();
+    if (ent_dim != VERT) {
+      prod_verts2verts = concat_lists(c_prod_verts2verts, r_prod_verts2verts);
+    }
+    auto prods2new_ents = LOs();
+    auto same_ents2old_ents = LOs();
+    auto same_ents2new_ents = LOs();
+    auto old_ents2new_ents = LOs();
+    modify_ents(mesh, &new_mesh, ent_dim, mods2mds, mds_are_mods, mods2prods,
+        prod_verts2verts, old_lows2new_lows, /*keep_mods*/ false,
+        /*mods_can_be_shared*/ false, &prods2new_ents, &same_ents2old_ents,
+        &same_ents2new_ents, &old_ents2new_ents);
+    old_ents2new_ents_by_dim[ent_dim] = old_ents2new_ents;
+    modify_adjs(mesh, &new_mesh, ent_dim, old_ents2new_ents_by_dim,
+        prods2new_ents);
+    auto nprods = prods2new_ents.size();
+    auto c_prods2new_ents = unmap_range(0, nc_prods, prods2new_ents, 1);
+    auto r_prods2new_ents = unmap_range(nc_prods, nprods, prods2new_ents, 1);
+    if (ent_dim == VERT) {
+      keys2midverts = r_prods2new_ents;
+      old_verts2new_verts = old_ents2new_ents;
+    }
+    std::vector<std::string> old_names;
+    for (Int i = 0; i < new_mesh.ntags(ent_dim); ++i) {
+      old_names.push_back(new_mesh.get_tag(ent_dim, i)->name());
+    }
+    if (do_refine) {
+      transfer_refine(mesh, opts.xfer_opts, &new_mesh, keys2edges,
+          keys2midverts, ent_dim, r_keys2prods, r_prods2new_ents,
+          same_ents2old_ents, same_ents2new_ents);
+    }
+    if (do_refine && do_coarsen) {
+      auto restores = save_refined_tags(
+          &new_mesh, ent_dim, old_names, r_prods2new_ents);
+      transfer_coarsen(mesh, opts.xfer_opts, &new_mesh, keys2verts, keys2doms,
+          ent_dim, c_prods2new_ents, same_ents2old_ents, same_ents2new_ents);
+      for (auto& restore : restores) restore();
+    } else if (do_coarsen) {
+      transfer_coarsen(mesh, opts.xfer_opts, &new_mesh, keys2verts, keys2doms,
+          ent_dim, c_prods2new_ents, same_ents2old_ents, same_ents2new_ents);
+    }
+    old_lows2new_lows = old_ents2new_ents;
+  }
+  *mesh = new_mesh;
+}
+
+/* the transfers that spread corrections beyond the cavities, and
+   user transfers, expect one kind of modification per rebuild */
+static bool can_fuse(Mesh* mesh, AdaptOpts const& opts) {
+  return !(opts.xfer_opts.user_xfer ||
+           should_conserve_any(mesh, opts.xfer_opts) ||
+           has_momentum_velocity(mesh, opts.xfer_opts));
+}
+
+bool refine_coarsen_by_size(Mesh* mesh, AdaptOpts const& opts) {
+  OMEGA_H_TIME_FUNCTION;
+  if (!can_fuse(mesh, opts)) {
+    auto did_refine = opts.should_refine && refine_by_size(mesh, opts);
+    auto did_coarsen = opts.should_coarsen && coarsen_by_size(mesh, opts);
+    return did_refine || did_coarsen;
+  }
+  auto comm = mesh->comm();
+  auto dim = mesh->dim();
+  bool may_refine = false;
+  if (opts.should_refine) {
+    auto edge_is_cand = restrict_to_region(mesh, opts, EDGE,
+        each_gt(mesh->ask_lengths(), opts.max_length_desired));
+    may_refine = (get_max(comm, edge_is_cand) == 1);
+    if (may_refine) mesh->add_tag(EDGE, "candidate", 1, edge_is_cand);
+  }
+  bool may_coarsen = opts.should_coarsen && mark_coarsen_by_size(mesh, opts);
+  if (!may_refine && !may_coarsen) return false;
+  mesh->set_parting(OMEGA_H_GHOSTED);
+  bool do_refine = may_refine && refine_ghosted(mesh, opts);
+  if (may_refine && !do_refine) mesh->remove_tag(EDGE, "candidate");
+  /* no collapse cavity may share an element with a split cavity */
+  auto verts_are_blocked = Read<I8>(mesh->nverts(), 0);
+  if (do_refine) {
+    auto elems_are_split =
+        mark_up(mesh, EDGE, dim, mesh->get_array<I8>(EDGE, "key"));
+    verts_are_blocked = mark_down(mesh, dim, VERT, elems_are_split);
+  }
+  bool do_coarsen =
+      may_coarsen && coarsen_by_size_ghosted(mesh, opts, verts_are_blocked);
+  if (!do_refine && !do_coarsen) return false;
+  mesh->set_parting(OMEGA_H_ELEM_BASED, false);
+  refine_coarsen_element_based(mesh, opts, do_refine, do_coarsen);
+  return true;
+}
+
+}  // end namespace Omega_h
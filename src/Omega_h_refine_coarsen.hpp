@@ -0,0 +1,17 @@
+#ifndef OMEGA_H_REFINE_COARSEN_HPP
+#define OMEGA_H_REFINE_COARSEN_HPP
+
+#include <Omega_h_adapt.hpp>
+
+namespace Omega_h {
+
+/* splits long edges and collapses short ones in a single rebuild
+   of the mesh, keeping the collapse cavities away from the split
+   ones. falls back to refine_by_size then coarsen_by_size when
+   the transfers need the two kept apart.
+   returns false if the mesh was not modified */
+bool refine_coarsen_by_size(Mesh* mesh, AdaptOpts const& opts);
+
+}  // end namespace Omega_h
+
+#endif
@@ -55,7 +55,19 @@ Alloc::Alloc(std::size_t size_in, std::string&& name_in)
   init();
 }
 
+Alloc::Alloc(std::size_t size_in, std::string const& name_in, void* ptr_in,
+    std::shared_ptr<void> owner_in)
+    : size(size_in),
+      name(name_in),
+      ptr(ptr_in),
+      use_count(1),
+      prev(nullptr),
+      next(nullptr),
+      owner(std::move(owner_in)) {}
+
 OMEGA_H_DLL Alloc::~Alloc() {
+  /* external memory is neither freed nor tracked here */
+  if (owner) return;
   ::Omega_h::maybe_pooled_device_free(ptr, size);
   auto ga = global_allocs;
   if (ga) {
@@ -124,6 +136,12 @@ SharedAlloc::SharedAlloc(std::size_t size_in, std::string&& name_in) {
 
 SharedAlloc::SharedAlloc(std::size_t size_in) : SharedAlloc(size_in, "") {}
 
+SharedAlloc::SharedAlloc(std::size_t size_in, std::string const& name_in,
+    void* ptr_in, std::shared_ptr<void> owner_in) {
+  alloc = new Alloc(size_in, name_in, ptr_in, std::move(owner_in));
+  direct_ptr = alloc->ptr;
+}
+
 SharedAlloc SharedAlloc::identity(std::size_t size_in) {
   SharedAlloc out;
   out.direct_ptr = nullptr;
@@ -3,6 +3,7 @@
 
 #include <Omega_h_macros.h>
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -25,8 +26,13 @@ struct Alloc {
   int use_count;
   Alloc* prev;
   Alloc* next;
+  /* if set, (ptr) points into memory kept alive by (owner)
+     rather than memory obtained from the (pooled) allocator */
+  std::shared_ptr<void> owner;
   Alloc(std::size_t size_in, std::string const& name_in);
   Alloc(std::size_t size_in, std::string&& name_in);
+  Alloc(std::size_t size_in, std::string const& name_in, void* ptr_in,
+      std::shared_ptr<void> owner_in);
   OMEGA_H_DLL ~Alloc();
   Alloc(Alloc const&) = delete;
   Alloc(Alloc&&) = delete;
@@ -55,6 +61,8 @@ struct SharedAlloc {
   SharedAlloc(std::size_t size_in, std::string const& name_in);
   SharedAlloc(std::size_t size_in, std::string&& name_in);
   SharedAlloc(std::size_t size_in);
+  SharedAlloc(std::size_t size_in, std::string const& name_in, void* ptr_in,
+      std::shared_ptr<void> owner_in);
   enum : std::uintptr_t {
     FREE_BIT1 = 0x1,
     FREE_BIT2 = 0x2,
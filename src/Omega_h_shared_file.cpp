@@ -0,0 +1,537 @@
+#include "Omega_h_file.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "Omega_h_align.hpp"
+#include "Omega_h_array_ops.hpp"
+#include "Omega_h_build.hpp"
+#include "Omega_h_element.hpp"
+#include "Omega_h_for.hpp"
+#include "Omega_h_linpart.hpp"
+#include "Omega_h_map.hpp"
+#include "Omega_h_mesh.hpp"
+#include "Omega_h_owners.hpp"
+#include "Omega_h_profile.hpp"
+
+namespace Omega_h {
+
+namespace binary {
+
+namespace {
+
+#ifdef OMEGA_H_USE_MPI
+#define CALL(f)                                                                \
+  {                                                                            \
+    int omega_h_mpi_error = (f);                                               \
+    OMEGA_H_CHECK(MPI_SUCCESS == omega_h_mpi_error);                           \
+  }
+#endif
+
+/* A shared file holds the whole mesh, regardless of how many ranks
+   wrote it:
+
+   magic, format version, header size,
+   family, dimension, global number of entities of each dimension,
+   name, type and width of each tag of each dimension,
+   class sets,
+   (padding up to the header size)
+   element-to-vertex connectivity,
+   element-to-entity connectivity of each intermediate dimension,
+   each tag of each dimension.
+
+   Each array after the header is a section holding the rows of all
+   entities of its dimension.
+   Entities are numbered by the rank that owns them, then by their
+   local index on that rank, and connectivity refers to these numbers.
+   "global" tags are not stored, since the numbering replaces them:
+   a mesh read from the file is numbered the same way. */
+
+unsigned char const shared_magic[2] = {0xa1, 0x1b};
+constexpr I32 shared_version = 1;
+constexpr I64 shared_alignment = 64;
+constexpr std::size_t shared_prefix_bytes =
+    sizeof(shared_magic) + sizeof(I32) + sizeof(I64);
+#ifdef OMEGA_H_USE_MPI
+/* MPI counts are ints, so big slices take several collective calls */
+constexpr std::size_t chunk_bytes = std::size_t(1) << 30;
+#endif
+
+struct SharedTagInfo {
+  std::string name;
+  Omega_h_Type type;
+  Int ncomps;
+};
+
+struct SharedHeader {
+  I64 nbytes;
+  Omega_h_Family family;
+  Int dim;
+  GO nglobal[4];
+  std::vector<SharedTagInfo> tags[4];
+};
+
+/* where each section starts */
+struct SharedLayout {
+  I64 elems2verts;
+  I64 elems2ents[4];
+  std::vector<I64> tags[4];
+};
+
+class SharedFile {
+  CommPtr comm_;
+#ifdef OMEGA_H_USE_MPI
+  MPI_File file_;
+#else
+  std::fstream file_;
+#endif
+
+ public:
+  SharedFile(CommPtr comm, filesystem::path const& path, bool is_writing)
+      : comm_(comm) {
+#ifdef OMEGA_H_USE_MPI
+    auto const mode =
+        is_writing ? (MPI_MODE_CREATE | MPI_MODE_WRONLY) : MPI_MODE_RDONLY;
+    auto const err = MPI_File_open(comm_->get_impl(),
+        const_cast<char*>(path.c_str()), mode, MPI_INFO_NULL, &file_);
+    if (err != MPI_SUCCESS) {
+      Omega_h_fail("couldn't open shared file \"%s\"\n", path.c_str());
+    }
+    if (is_writing) CALL(MPI_File_set_size(file_, 0));
+#else
+    auto const mode = is_writing ? (std::ios::out | std::ios::trunc)
+                                 : std::ios::in;
+    file_.open(path.c_str(), mode | std::ios::binary);
+    if (!file_.is_open()) {
+      Omega_h_fail("couldn't open shared file \"%s\"\n", path.c_str());
+    }
+#endif
+  }
+  ~SharedFile() {
+#ifdef OMEGA_H_USE_MPI
+    MPI_File_close(&file_);
+#endif
+  }
+  SharedFile(SharedFile const&) = delete;
+  SharedFile& operator=(SharedFile const&) = delete;
+  /* collective: every rank writes its own (possibly empty) range */
+  void write_at(I64 offset, void const* data, std::size_t nbytes) {
+#ifdef OMEGA_H_USE_MPI
+    auto const bytes = static_cast<char const*>(data);
+    auto const nchunks = comm_->allreduce(
+        I64((nbytes + chunk_bytes - 1) / chunk_bytes), OMEGA_H_MAX);
+    for (I64 i = 0; i < nchunks; ++i) {
+      auto const begin = std::min(nbytes, std::size_t(i) * chunk_bytes);
+      auto const n = std::min(std::size_t(chunk_bytes), nbytes - begin);
+      MPI_Status status;
+      CALL(MPI_File_write_at_all(file_, MPI_Offset(offset + I64(begin)),
+          const_cast<char*>(bytes) + begin, int(n), MPI_BYTE, &status));
+    }
+#else
+    file_.seekp(std::streamoff(offset));
+    file_.write(static_cast<char const*>(data), std::streamsize(nbytes));
+    OMEGA_H_CHECK(file_.good());
+#endif
+  }
+  /* collective: every rank reads its own (possibly empty) range */
+  void read_at(I64 offset, void* data, std::size_t nbytes) {
+#ifdef OMEGA_H_USE_MPI
+    auto const bytes = static_cast<char*>(data);
+    auto const nchunks = comm_->allreduce(
+        I64((nbytes + chunk_bytes - 1) / chunk_bytes), OMEGA_H_MAX);
+    for (I64 i = 0; i < nchunks; ++i) {
+      auto const begin = std::min(nbytes, std::size_t(i) * chunk_bytes);
+      auto const n = std::min(std::size_t(chunk_bytes), nbytes - begin);
+      MPI_Status status;
+      CALL(MPI_File_read_at_all(file_, MPI_Offset(offset + I64(begin)),
+          bytes + begin, int(n), MPI_BYTE, &status));
+    }
+#else
+    file_.seekg(std::streamoff(offset));
+    file_.read(static_cast<char*>(data), std::streamsize(nbytes));
+    OMEGA_H_CHECK(file_.good());
+#endif
+  }
+};
+
+I64 get_type_size(Omega_h_Type type) {
+  switch (type) {
+    case OMEGA_H_I8:
+      return I64(sizeof(I8));
+    case OMEGA_H_I32:
+      return I64(sizeof(I32));
+    case OMEGA_H_I64:
+      return I64(sizeof(I64));
+    case OMEGA_H_F64:
+      return I64(sizeof(Real));
+  }
+  OMEGA_H_NORETURN(0);
+}
+
+bool is_stored_tag(TagBase const* tag) { return tag->name() != "global"; }
+
+std::string write_shared_header(
+    Mesh* mesh, GO const nglobal[], bool needs_swapping) {
+  std::ostringstream body;
+  write_value(body, I8(mesh->family()), needs_swapping);
+  write_value(body, I8(mesh->dim()), needs_swapping);
+  for (Int d = 0; d <= mesh->dim(); ++d) {
+    write_value(body, I64(nglobal[d]), needs_swapping);
+  }
+  for (Int d = 0; d <= mesh->dim(); ++d) {
+    I32 ntags = 0;
+    for (Int i = 0; i < mesh->ntags(d); ++i) {
+      if (is_stored_tag(mesh->get_tag(d, i))) ++ntags;
+    }
+    write_value(body, ntags, needs_swapping);
+    for (Int i = 0; i < mesh->ntags(d); ++i) {
+      auto const tag = mesh->get_tag(d, i);
+      if (!is_stored_tag(tag)) continue;
+      write(body, tag->name(), needs_swapping);
+      write_value(body, I8(tag->type()), needs_swapping);
+      write_value(body, I8(tag->ncomps()), needs_swapping);
+    }
+  }
+  write_sets(body, mesh, needs_swapping);
+  auto const body_bytes = body.str();
+  auto const unpadded = I64(shared_prefix_bytes + body_bytes.size());
+  auto const nbytes =
+      (unpadded + shared_alignment - 1) / shared_alignment * shared_alignment;
+  std::ostringstream stream;
+  stream.write(reinterpret_cast<const char*>(shared_magic),
+      sizeof(shared_magic));
+  write_value(stream, shared_version, needs_swapping);
+  write_value(stream, nbytes, needs_swapping);
+  stream << body_bytes;
+  stream << std::string(std::size_t(nbytes - unpadded), '\0');
+  return stream.str();
+}
+
+/* leaves (stream) at the class sets */
+SharedHeader read_shared_header(std::istream& stream, bool needs_swapping) {
+  unsigned char magic_in[2];
+  stream.read(reinterpret_cast<char*>(magic_in), sizeof(magic_in));
+  OMEGA_H_CHECK(magic_in[0] == shared_magic[0]);
+  OMEGA_H_CHECK(magic_in[1] == shared_magic[1]);
+  I32 version;
+  read_value(stream, version, needs_swapping);
+  OMEGA_H_CHECK(1 <= version && version <= shared_version);
+  SharedHeader header;
+  read_value(stream, header.nbytes, needs_swapping);
+  I8 family;
+  read_value(stream, family, needs_swapping);
+  header.family = Omega_h_Family(family);
+  I8 dim;
+  read_value(stream, dim, needs_swapping);
+  OMEGA_H_CHECK(1 <= dim && dim <= 3);
+  header.dim = Int(dim);
+  for (Int d = 0; d <= header.dim; ++d) {
+    I64 nglobal;
+    read_value(stream, nglobal, needs_swapping);
+    header.nglobal[d] = GO(nglobal);
+  }
+  for (Int d = 0; d <= header.dim; ++d) {
+    I32 ntags;
+    read_value(stream, ntags, needs_swapping);
+    for (I32 i = 0; i < ntags; ++i) {
+      SharedTagInfo info;
+      read(stream, info.name, needs_swapping);
+      I8 type;
+      read_value(stream, type, needs_swapping);
+      info.type = Omega_h_Type(type);
+      I8 ncomps;
+      read_value(stream, ncomps, needs_swapping);
+      info.ncomps = Int(ncomps);
+      header.tags[d].push_back(info);
+    }
+  }
+  return header;
+}
+
+SharedLayout get_shared_layout(SharedHeader const& header) {
+  SharedLayout layout;
+  auto offset = header.nbytes;
+  auto const dim = header.dim;
+  auto const nelems = I64(header.nglobal[dim]);
+  layout.elems2verts = offset;
+  offset +=
+      nelems * element_degree(header.family, dim, VERT) * I64(sizeof(GO));
+  for (Int d = 1; d < dim; ++d) {
+    layout.elems2ents[d] = offset;
+    offset += nelems * element_degree(header.family, dim, d) * I64(sizeof(GO));
+  }
+  for (Int d = 0; d <= dim; ++d) {
+    for (auto& info : header.tags[d]) {
+      layout.tags[d].push_back(offset);
+      offset += I64(header.nglobal[d]) * info.ncomps * get_type_size(info.type);
+    }
+  }
+  return layout;
+}
+
+/* writes rows [first, first + rows.size() / width) of a section */
+template <typename T>
+void write_rows(SharedFile* file, I64 section, GO first, Read<T> rows,
+    Int width, bool needs_swapping) {
+  HostRead<T> host_rows(swap_bytes(rows, needs_swapping));
+  auto const offset = section + I64(first) * width * I64(sizeof(T));
+  file->write_at(offset, host_rows.data(),
+      std::size_t(host_rows.size()) * sizeof(T));
+}
+
+template <typename T>
+Read<T> read_rows(SharedFile* file, I64 section, GO first, LO nrows,
+    Int width, bool needs_swapping) {
+  HostWrite<T> host_rows(nrows * width);
+  auto const offset = section + I64(first) * width * I64(sizeof(T));
+  file->read_at(offset, host_rows.data(),
+      std::size_t(host_rows.size()) * sizeof(T));
+  return swap_bytes(Read<T>(host_rows.write()), needs_swapping);
+}
+
+template <typename T>
+void write_tag_rows(SharedFile* file, I64 section, GO first, Mesh* mesh,
+    Int ent_dim, SharedTagInfo const& info, LOs owned2ents,
+    bool needs_swapping) {
+  auto const array = mesh->get_array<T>(ent_dim, info.name);
+  write_rows(file, section, first, read(unmap(owned2ents, array, info.ncomps)),
+      info.ncomps, needs_swapping);
+}
+
+void write_tag_rows(SharedFile* file, I64 section, GO first, Mesh* mesh,
+    Int ent_dim, SharedTagInfo const& info, LOs owned2ents,
+    bool needs_swapping) {
+  if (!mesh->has_tag(ent_dim, info.name)) {
+    Omega_h_fail("rank %d has no %s tag \"%s\" to write\n",
+        mesh->comm()->rank(), dimensional_singular_name(ent_dim),
+        info.name.c_str());
+  }
+  auto const tag = mesh->get_tagbase(ent_dim, info.name);
+  OMEGA_H_CHECK(tag->type() == info.type);
+  OMEGA_H_CHECK(tag->ncomps() == info.ncomps);
+  switch (info.type) {
+    case OMEGA_H_I8:
+      write_tag_rows<I8>(file, section, first, mesh, ent_dim, info,
+          owned2ents, needs_swapping);
+      return;
+    case OMEGA_H_I32:
+      write_tag_rows<I32>(file, section, first, mesh, ent_dim, info,
+          owned2ents, needs_swapping);
+      return;
+    case OMEGA_H_I64:
+      write_tag_rows<I64>(file, section, first, mesh, ent_dim, info,
+          owned2ents, needs_swapping);
+      return;
+    case OMEGA_H_F64:
+      write_tag_rows<Real>(file, section, first, mesh, ent_dim, info,
+          owned2ents, needs_swapping);
+      return;
+  }
+}
+
+/* (slice2ents) sends rows of this rank's slice to the entities */
+template <typename T>
+void read_tag_rows(SharedFile* file, I64 section, GO first, LO nrows,
+    Mesh* mesh, Int ent_dim, SharedTagInfo const& info, Dist const& slice2ents,
+    bool needs_swapping) {
+  auto const rows =
+      read_rows<T>(file, section, first, nrows, info.ncomps, needs_swapping);
+  mesh->add_tag(
+      ent_dim, info.name, info.ncomps, slice2ents.exch(rows, info.ncomps));
+}
+
+void read_tag_rows(SharedFile* file, I64 section, GO first, LO nrows,
+    Mesh* mesh, Int ent_dim, SharedTagInfo const& info, Dist const& slice2ents,
+    bool needs_swapping) {
+  switch (info.type) {
+    case OMEGA_H_I8:
+      read_tag_rows<I8>(file, section, first, nrows, mesh, ent_dim, info,
+          slice2ents, needs_swapping);
+      return;
+    case OMEGA_H_I32:
+      read_tag_rows<I32>(file, section, first, nrows, mesh, ent_dim, info,
+          slice2ents, needs_swapping);
+      return;
+    case OMEGA_H_I64:
+      read_tag_rows<I64>(file, section, first, nrows, mesh, ent_dim, info,
+          slice2ents, needs_swapping);
+      return;
+    case OMEGA_H_F64:
+      read_tag_rows<Real>(file, section, first, nrows, mesh, ent_dim, info,
+          slice2ents, needs_swapping);
+      return;
+  }
+}
+
+/* the number in the file of each entity of (ent_dim), found through
+   the downward connectivity stored for one of its adjacent elements */
+GOs get_file_numbers(Mesh* mesh, Int ent_dim, GOs elems2file_ents) {
+  auto const up = mesh->ask_up(ent_dim, mesh->dim());
+  auto const a2ab = up.a2ab;
+  auto const ab2b = up.ab2b;
+  auto const codes = up.codes;
+  auto const deg = element_degree(mesh->family(), mesh->dim(), ent_dim);
+  Write<GO> out(mesh->nents(ent_dim));
+  auto f = OMEGA_H_LAMBDA(LO ent) {
+    auto const use = a2ab[ent];
+    auto const elem = ab2b[use];
+    auto const which = code_which_down(codes[use]);
+    out[ent] = elems2file_ents[elem * deg + which];
+  };
+  parallel_for(out.size(), std::move(f));
+  return out;
+}
+
+std::string read_shared_header_bytes(
+    SharedFile* file, CommPtr comm, bool needs_swapping) {
+  std::string bytes;
+  auto const is_root = (comm->rank() == 0);
+  char prefix[shared_prefix_bytes];
+  file->read_at(0, prefix, is_root ? sizeof(prefix) : 0);
+  if (is_root) {
+    I64 nbytes;
+    std::memcpy(&nbytes, prefix + sizeof(shared_magic) + sizeof(I32),
+        sizeof(nbytes));
+    if (needs_swapping) swap_bytes(nbytes);
+    OMEGA_H_CHECK(nbytes >= I64(shared_prefix_bytes));
+    bytes.resize(std::size_t(nbytes));
+  }
+  file->read_at(0, &bytes[0], bytes.size());
+  comm->bcast_string(bytes);
+  return bytes;
+}
+
+}  // end anonymous namespace
+
+void write_shared(filesystem::path const& path, Mesh* mesh) {
+  ScopedTimer timer("binary::write_shared");
+  auto const comm = mesh->comm();
+  auto const dim = mesh->dim();
+  bool const needs_swapping = !is_little_endian_cpu();
+  LOs owned2ents[4];
+  GO firsts[4];
+  GO nglobal[4];
+  for (Int d = 0; d <= dim; ++d) {
+    owned2ents[d] = collect_marked(mesh->owned(d));
+    auto const nowned = GO(owned2ents[d].size());
+    firsts[d] = comm->exscan(nowned, OMEGA_H_SUM);
+    nglobal[d] = comm->allreduce(nowned, OMEGA_H_SUM);
+  }
+  /* rank 0's header decides the order of the tags */
+  std::string header_bytes;
+  if (comm->rank() == 0) {
+    header_bytes = write_shared_header(mesh, nglobal, needs_swapping);
+  }
+  comm->bcast_string(header_bytes);
+  std::istringstream header_stream(header_bytes);
+  auto const header = read_shared_header(header_stream, needs_swapping);
+  auto const layout = get_shared_layout(header);
+  SharedFile file(comm, path, true);
+  file.write_at(0, header_bytes.data(),
+      (comm->rank() == 0) ? header_bytes.size() : std::size_t(0));
+  auto const owned_elems = owned2ents[dim];
+  auto const vert_numbers = globals_from_owners(mesh, VERT);
+  auto const elems2verts = unmap(owned_elems, mesh->ask_elem_verts(),
+      element_degree(mesh->family(), dim, VERT));
+  write_rows(&file, layout.elems2verts, firsts[dim],
+      read(unmap(elems2verts, vert_numbers, 1)),
+      element_degree(mesh->family(), dim, VERT), needs_swapping);
+  for (Int d = 1; d < dim; ++d) {
+    auto const deg = element_degree(mesh->family(), dim, d);
+    auto const ent_numbers = globals_from_owners(mesh, d);
+    auto const elems2ents =
+        unmap(owned_elems, mesh->ask_down(dim, d).ab2b, deg);
+    write_rows(&file, layout.elems2ents[d], firsts[dim],
+        read(unmap(elems2ents, ent_numbers, 1)), deg, needs_swapping);
+  }
+  for (Int d = 0; d <= dim; ++d) {
+    for (std::size_t i = 0; i < header.tags[d].size(); ++i) {
+      write_tag_rows(&file, layout.tags[d][i], firsts[d], mesh, d,
+          header.tags[d][i], owned2ents[d], needs_swapping);
+    }
+  }
+}
+
+Mesh read_shared(filesystem::path const& path, CommPtr comm) {
+  ScopedTimer timer("binary::read_shared");
+  bool const needs_swapping = !is_little_endian_cpu();
+  SharedFile file(comm, path, false);
+  auto const header_bytes =
+      read_shared_header_bytes(&file, comm, needs_swapping);
+  std::istringstream header_stream(header_bytes);
+  auto const header = read_shared_header(header_stream, needs_swapping);
+  auto const layout = get_shared_layout(header);
+  auto const family = header.family;
+  auto const dim = header.dim;
+  GO firsts[4];
+  LO nslice[4];
+  for (Int d = 0; d <= dim; ++d) {
+    GO end;
+    suggest_slices(
+        header.nglobal[d], comm->size(), comm->rank(), &firsts[d], &end);
+    nslice[d] = LO(end - firsts[d]);
+  }
+  auto const& vert_tags = header.tags[VERT];
+  auto const coords_it = std::find_if(vert_tags.begin(), vert_tags.end(),
+      [](SharedTagInfo const& info) { return info.name == "coordinates"; });
+  OMEGA_H_CHECK(coords_it != vert_tags.end());
+  OMEGA_H_CHECK(coords_it->type == OMEGA_H_F64 && coords_it->ncomps == dim);
+  auto const coords_section =
+      layout.tags[VERT][std::size_t(coords_it - vert_tags.begin())];
+  auto const slice_coords = read_rows<Real>(
+      &file, coords_section, firsts[VERT], nslice[VERT], dim, needs_swapping);
+  auto const deg = element_degree(family, dim, VERT);
+  auto const slice_elems2verts = read_rows<GO>(&file, layout.elems2verts,
+      firsts[dim], nslice[dim], deg, needs_swapping);
+  Dist slice_elems2elems;
+  Dist slice_verts2verts;
+  LOs elems2verts;
+  assemble_slices(comm, family, dim, header.nglobal[dim], firsts[dim],
+      slice_elems2verts, header.nglobal[VERT], firsts[VERT], slice_coords,
+      &slice_elems2elems, &elems2verts, &slice_verts2verts);
+  auto const vert_numbers = slice_verts2verts.exch(
+      GOs(nslice[VERT], firsts[VERT], 1, "slice vert numbers"), 1);
+  Mesh mesh(comm->library());
+  build_from_elems2verts(&mesh, comm, family, dim, elems2verts, vert_numbers);
+  Dist slice2ents[4];
+  slice2ents[VERT] = slice_verts2verts;
+  slice2ents[dim] = slice_elems2elems;
+  for (Int d = 1; d < dim; ++d) {
+    auto const ent_deg = element_degree(family, dim, d);
+    auto const slice_elems2ents = read_rows<GO>(&file, layout.elems2ents[d],
+        firsts[dim], nslice[dim], ent_deg, needs_swapping);
+    auto const elems2ents = slice_elems2elems.exch(slice_elems2ents, ent_deg);
+    auto const ent_numbers = get_file_numbers(&mesh, d, elems2ents);
+    auto const ents2slice = Dist(comm,
+        globals_to_linear_owners(comm, ent_numbers, header.nglobal[d]),
+        nslice[d]);
+    slice2ents[d] = ents2slice.invert();
+  }
+  /* every entity keeps its number in the file, as the vertices
+     already do, so that reading onto any number of ranks gives
+     the same global numbering */
+  for (Int d = 1; d <= dim; ++d) {
+    mesh.set_tag(d, "global",
+        slice2ents[d].exch(GOs(nslice[d], firsts[d], 1), 1));
+  }
+  for (Int d = 0; d <= dim; ++d) {
+    for (std::size_t i = 0; i < header.tags[d].size(); ++i) {
+      auto const& info = header.tags[d][i];
+      if (d == VERT && info.name == "coordinates") {
+        mesh.add_tag(VERT, info.name, dim,
+            slice2ents[VERT].exch(slice_coords, dim));
+        continue;
+      }
+      read_tag_rows(&file, layout.tags[d][i], firsts[d], nslice[d], &mesh, d,
+          info, slice2ents[d], needs_swapping);
+    }
+  }
+  read_sets(header_stream, &mesh, needs_swapping);
+  return mesh;
+}
+
+}  // end namespace binary
+
+}  // end namespace Omega_h
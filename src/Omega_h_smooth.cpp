@@ -0,0 +1,206 @@
+#include "Omega_h_smooth.hpp"
+
+#include <iostream>
+
+#include "Omega_h_align.hpp"
+#include "Omega_h_array_ops.hpp"
+#include "Omega_h_for.hpp"
+#include "Omega_h_indset.hpp"
+#include "Omega_h_map.hpp"
+#include "Omega_h_mark.hpp"
+#include "Omega_h_mesh.hpp"
+#include "Omega_h_metric.hpp"
+#include "Omega_h_profile.hpp"
+#include "Omega_h_quality.hpp"
+#include "Omega_h_shape.hpp"
+#include "Omega_h_transfer.hpp"
+
+namespace Omega_h {
+
+/* for each candidate vertex, the best of a few steps towards its
+   target: the minimum quality of its elements after the step, the
+   old element holding its new position and the barycentric
+   coordinates there. the element is -1 if no step helps enough */
+template <Int mesh_dim, Int metric_dim>
+static void smooth_candidates_tmpl(Mesh* mesh, AdaptOpts const& opts,
+    LOs cands2verts, Write<Real> cand_quals, Write<LO> cand_elems,
+    Write<Real> cand_barys) {
+  OMEGA_H_CHECK(mesh->dim() == mesh_dim);
+  constexpr Int nverts_per_elem = mesh_dim + 1;
+  auto coords = mesh->coords();
+  auto metrics = mesh->get_array<Real>(VERT, "metric");
+  auto lin_metrics = linearize_metrics(mesh->nverts(), metrics);
+  auto lengths = mesh->ask_lengths();
+  auto elem_quals = mesh->ask_qualities();
+  auto ev2v = mesh->ask_verts_of(EDGE);
+  auto v2e = mesh->ask_up(VERT, EDGE);
+  auto kv2v = mesh->ask_elem_verts();
+  auto v2k = mesh->ask_up(VERT, mesh_dim);
+  auto max_length = opts.max_length_allowed;
+  Real const min_improvement = 1e-3;
+  Real const inside_tol = 1e-10;
+  auto f = OMEGA_H_LAMBDA(LO cand) {
+    auto v = cands2verts[cand];
+    auto x = get_vector<mesh_dim>(coords, v);
+    /* the average of the points at unit metric length from each
+       neighbor along the edge joining it to (v) */
+    auto target = zero_vector<mesh_dim>();
+    for (auto ve = v2e.a2ab[v]; ve < v2e.a2ab[v + 1]; ++ve) {
+      auto e = v2e.ab2b[ve];
+      auto u = ev2v[e * 2 + (1 - code_which_down(v2e.codes[ve]))];
+      auto xu = get_vector<mesh_dim>(coords, u);
+      target = target + xu + (x - xu) / lengths[e];
+    }
+    target = target / Real(v2e.a2ab[v + 1] - v2e.a2ab[v]);
+    Real old_qual = 1.0;
+    for (auto vk = v2k.a2ab[v]; vk < v2k.a2ab[v + 1]; ++vk) {
+      old_qual = min2(old_qual, elem_quals[v2k.ab2b[vk]]);
+    }
+    auto best_qual = old_qual + min_improvement;
+    LO best_elem = -1;
+    auto best_bary = zero_vector<nverts_per_elem>();
+    Real step = 1.0;
+    for (Int i = 0; i < 3; ++i, step /= 2.0) {
+      auto p = x + (target - x) * step;
+      LO elem = -1;
+      auto bary = zero_vector<nverts_per_elem>();
+      for (auto vk = v2k.a2ab[v]; vk < v2k.a2ab[v + 1]; ++vk) {
+        auto k = v2k.ab2b[vk];
+        auto kp = gather_vectors<nverts_per_elem, mesh_dim>(
+            coords, gather_verts<nverts_per_elem>(kv2v, k));
+        auto b = barycentric_from_global<mesh_dim, mesh_dim>(p, kp);
+        if (reduce(b, minimum<Real>()) >= -inside_tol) {
+          elem = k;
+          bary = b;
+          break;
+        }
+      }
+      if (elem == -1) continue;
+      /* the metric at (p), interpolated in the old mesh */
+      auto lin_m = zero_matrix<metric_dim, metric_dim>();
+      for (Int j = 0; j < nverts_per_elem; ++j) {
+        auto w = kv2v[elem * nverts_per_elem + j];
+        lin_m = lin_m + get_symm<metric_dim>(lin_metrics, w) * bary[j];
+      }
+      auto m = delinearize_metric(lin_m);
+      Real qual = 1.0;
+      for (auto vk = v2k.a2ab[v]; vk < v2k.a2ab[v + 1]; ++vk) {
+        auto k = v2k.ab2b[vk];
+        auto kkv = code_which_down(v2k.codes[vk]);
+        auto kkv2v = gather_verts<nverts_per_elem>(kv2v, k);
+        Few<Vector<mesh_dim>, nverts_per_elem> kp =
+            gather_vectors<nverts_per_elem, mesh_dim>(coords, kkv2v);
+        auto kms = gather_symms<nverts_per_elem, metric_dim>(metrics, kkv2v);
+        kp[kkv] = p;
+        kms[kkv] = m;
+        qual = min2(qual, metric_element_quality(kp, maxdet_metric(kms)));
+      }
+      for (auto ve = v2e.a2ab[v]; ve < v2e.a2ab[v + 1]; ++ve) {
+        auto e = v2e.ab2b[ve];
+        auto u = ev2v[e * 2 + (1 - code_which_down(v2e.codes[ve]))];
+        Few<Vector<mesh_dim>, 2> ep;
+        ep[0] = p;
+        ep[1] = get_vector<mesh_dim>(coords, u);
+        Few<Tensor<metric_dim>, 2> ems;
+        ems[0] = m;
+        ems[1] = get_symm<metric_dim>(metrics, u);
+        if (metric_edge_length<mesh_dim, metric_dim>(ep, ems) > max_length) {
+          qual = -1.0;
+        }
+      }
+      if (qual >= best_qual) {
+        best_qual = qual;
+        best_elem = elem;
+        best_bary = bary;
+      }
+    }
+    cand_quals[cand] = best_qual;
+    cand_elems[cand] = best_elem;
+    for (Int j = 0; j < nverts_per_elem; ++j) {
+      cand_barys[cand * nverts_per_elem + j] = best_bary[j];
+    }
+  };
+  parallel_for(cands2verts.size(), f, "smooth_candidates");
+}
+
+static void smooth_candidates(Mesh* mesh, AdaptOpts const& opts,
+    LOs cands2verts, Write<Real> cand_quals, Write<LO> cand_elems,
+    Write<Real> cand_barys) {
+  auto metrics = mesh->get_array<Real>(VERT, "metric");
+  auto metric_dim = get_metrics_dim(mesh->nverts(), metrics);
+  if (mesh->dim() == 3 && metric_dim == 3) {
+    smooth_candidates_tmpl<3, 3>(
+        mesh, opts, cands2verts, cand_quals, cand_elems, cand_barys);
+  } else if (mesh->dim() == 2 && metric_dim == 2) {
+    smooth_candidates_tmpl<2, 2>(
+        mesh, opts, cands2verts, cand_quals, cand_elems, cand_barys);
+  } else if (mesh->dim() == 3 && metric_dim == 1) {
+    smooth_candidates_tmpl<3, 1>(
+        mesh, opts, cands2verts, cand_quals, cand_elems, cand_barys);
+  } else if (mesh->dim() == 2 && metric_dim == 1) {
+    smooth_candidates_tmpl<2, 1>(
+        mesh, opts, cands2verts, cand_quals, cand_elems, cand_barys);
+  } else {
+    OMEGA_H_NORETURN();
+  }
+}
+
+/* moving vertices changes element sizes, which the conservative
+   and momentum transfers have no way to account for, and user
+   transfers only know about topology changes */
+static bool can_smooth(Mesh* mesh, AdaptOpts const& opts) {
+  return mesh->dim() > 1 &&
+         !(opts.xfer_opts.user_xfer ||
+             should_conserve_any(mesh, opts.xfer_opts) ||
+             has_momentum_velocity(mesh, opts.xfer_opts));
+}
+
+bool smooth_verts(Mesh* mesh, AdaptOpts const& opts) {
+  OMEGA_H_TIME_FUNCTION;
+  if (!can_smooth(mesh, opts)) return false;
+  mesh->set_parting(OMEGA_H_GHOSTED);
+  auto comm = mesh->comm();
+  auto dim = mesh->dim();
+  auto nverts = mesh->nverts();
+  auto elems_are_bad =
+      each_lt(mesh->ask_qualities(), opts.min_quality_desired);
+  auto verts_are_cands = mark_down(mesh, dim, VERT, elems_are_bad);
+  /* only interior vertices move, and only on their owners, which
+     have all their elements */
+  verts_are_cands =
+      land_each(verts_are_cands, mark_by_class_dim(mesh, VERT, dim));
+  verts_are_cands = land_each(verts_are_cands, mesh->owned(VERT));
+  verts_are_cands = restrict_to_region(mesh, opts, VERT, verts_are_cands);
+  if (get_max(comm, verts_are_cands) != 1) return false;
+  auto cands2verts = collect_marked(verts_are_cands);
+  auto ncands = cands2verts.size();
+  auto nverts_per_elem = dim + 1;
+  Write<Real> cand_quals(ncands);
+  Write<LO> cand_elems(ncands);
+  Write<Real> cand_barys(ncands * nverts_per_elem);
+  smooth_candidates(
+      mesh, opts, cands2verts, cand_quals, cand_elems, cand_barys);
+  auto cands_move = each_geq_to(LOs(cand_elems), 0);
+  auto verts_move = map_onto(cands_move, cands2verts, nverts, I8(0), 1);
+  auto vert_quals = map_onto(Reals(cand_quals), cands2verts, nverts, -1.0, 1);
+  verts_move = mesh->sync_array(VERT, verts_move, 1);
+  if (get_max(comm, verts_move) != 1) return false;
+  vert_quals = mesh->sync_array(VERT, vert_quals, 1);
+  auto verts_are_keys = find_indset(mesh, VERT, vert_quals, verts_move);
+  auto cands_are_keys = read(unmap(cands2verts, verts_are_keys, 1));
+  auto keys2cands = collect_marked(cands_are_keys);
+  auto keys2verts = read(unmap(keys2cands, cands2verts, 1));
+  auto keys2elems = read(unmap(keys2cands, LOs(cand_elems), 1));
+  auto keys2barys =
+      read(unmap(keys2cands, Reals(cand_barys), nverts_per_elem));
+  if (opts.verbosity >= EACH_REBUILD) {
+    auto nkeys = comm->allreduce(GO(keys2verts.size()), OMEGA_H_SUM);
+    if (comm->rank() == 0) {
+      std::cout << "smoothing " << nkeys << " vertices\n";
+    }
+  }
+  transfer_smooth(mesh, opts.xfer_opts, keys2verts, keys2elems, keys2barys);
+  return true;
+}
+
+}  // end namespace Omega_h
@@ -0,0 +1,19 @@
+#ifndef OMEGA_H_SMOOTH_HPP
+#define OMEGA_H_SMOOTH_HPP
+
+#include <Omega_h_adapt.hpp>
+
+namespace Omega_h {
+
+/* moves interior vertices of elements below min_quality_desired
+   towards a metric-aware Laplacian target, keeping a move only if
+   it raises the minimum quality of the vertex's elements.
+   an independent set of the vertices moves at once, and vertex
+   fields are interpolated at their new positions in the old mesh.
+   the connectivity is not changed.
+   returns false if the mesh was not modified */
+bool smooth_verts(Mesh* mesh, AdaptOpts const& opts);
+
+}  // end namespace Omega_h
+
+#endif
@@ -3,6 +3,7 @@
 #include <Omega_h_sort.hpp>
 
 #include <algorithm>
+#include <type_traits>
 #include <vector>
 
 #if defined(OMEGA_H_USE_CUDA)
@@ -68,6 +69,162 @@ struct CompareKeySets {
   }
 };
 
+#if !defined(OMEGA_H_USE_CUDA)
+
+/* Least-significant-digit radix sort of key tuples.
+   Each column of the tuple is offset by its minimum value and
+   sorted one byte at a time, starting from the last column.
+   Each counting pass is stable, so the result is identical to
+   the one produced by a stable comparison sort.
+   The current column's digits travel alongside the permutation,
+   so each column is gathered once instead of once per comparison. */
+
+constexpr Int radix_bits = 8;
+constexpr LO radix_nbuckets = LO(1) << radix_bits;
+
+static Int get_radix_nthreads() {
+#if defined(OMEGA_H_USE_OPENMP)
+  return Int(omp_get_max_threads());
+#else
+  return 1;
+#endif
+}
+
+template <typename U>
+static Int count_radix_passes(U range) {
+  Int npasses = 0;
+  while (range != 0) {
+    ++npasses;
+    range = U(range >> radix_bits);
+  }
+  return npasses;
+}
+
+/* one stable counting-sort pass on the digit at (shift).
+   returns false if all items have the same digit, in which
+   case nothing is moved */
+template <typename U>
+static bool radix_pass(LO n, U const* keys_in, LO const* perm_in, U* keys_out,
+    LO* perm_out, Int shift, Int nthreads) {
+  std::vector<LO> counts(std::size_t(nthreads * radix_nbuckets), 0);
+  LO const chunk = (n + nthreads - 1) / nthreads;
+#if defined(OMEGA_H_USE_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+  for (Int t = 0; t < nthreads; ++t) {
+    LO* thread_counts = counts.data() + t * radix_nbuckets;
+    LO const b = min2(n, t * chunk);
+    LO const e = min2(n, b + chunk);
+    for (LO i = b; i < e; ++i) {
+      ++thread_counts[(keys_in[i] >> shift) & U(radix_nbuckets - 1)];
+    }
+  }
+  /* bucket-major, thread-minor offsets keep the pass stable */
+  LO sum = 0;
+  for (LO d = 0; d < radix_nbuckets; ++d) {
+    LO bucket_total = 0;
+    for (Int t = 0; t < nthreads; ++t) {
+      auto& count = counts[std::size_t(t * radix_nbuckets + d)];
+      auto const tmp = count;
+      count = sum;
+      sum += tmp;
+      bucket_total += tmp;
+    }
+    if (bucket_total == n) return false;
+  }
+#if defined(OMEGA_H_USE_OPENMP)
+#pragma omp parallel for schedule(static)
+#endif
+  for (Int t = 0; t < nthreads; ++t) {
+    LO* thread_offsets = counts.data() + t * radix_nbuckets;
+    LO const b = min2(n, t * chunk);
+    LO const e = min2(n, b + chunk);
+    for (LO i = b; i < e; ++i) {
+      auto const d = (keys_in[i] >> shift) & U(radix_nbuckets - 1);
+      auto const j = thread_offsets[d]++;
+      keys_out[j] = keys_in[i];
+      perm_out[j] = perm_in[i];
+    }
+  }
+  return true;
+}
+
+template <Int N, typename T>
+static void get_key_ranges(LO n, T const* keys, T mins[], T maxs[]) {
+  for (Int j = 0; j < N; ++j) {
+    T lo = ArithTraits<T>::max();
+    T hi = ArithTraits<T>::min();
+#if defined(OMEGA_H_USE_OPENMP)
+#pragma omp parallel for reduction(min : lo) reduction(max : hi)
+#endif
+    for (LO i = 0; i < n; ++i) {
+      auto const k = keys[i * N + j];
+      lo = min2(lo, k);
+      hi = max2(hi, k);
+    }
+    mins[j] = lo;
+    maxs[j] = hi;
+  }
+}
+
+/* Radix sorting costs one pass over the data per key byte,
+   while a comparison sort costs about log2(n) passes with
+   much more expensive (indirect) accesses. Only radix sort
+   when the keys' ranges are small enough to win. */
+static bool radix_sort_is_worthwhile(LO n, Int npasses) {
+  if (n < radix_nbuckets) return false;
+  Int log2_n = 0;
+  while ((LO(1) << log2_n) < n) ++log2_n;
+  return 2 * npasses <= log2_n;
+}
+
+template <Int N, typename T>
+static bool try_radix_sort(LO n, T const* keys, LO* perm) {
+  using U = typename std::make_unsigned<T>::type;
+  T mins[N];
+  T maxs[N];
+  get_key_ranges<N>(n, keys, mins, maxs);
+  U ranges[N];
+  Int npasses = 0;
+  for (Int j = 0; j < N; ++j) {
+    ranges[j] = U(U(maxs[j]) - U(mins[j]));
+    npasses += count_radix_passes(ranges[j]);
+  }
+  if (!radix_sort_is_worthwhile(n, npasses)) return false;
+  begin_code("radix_sort");
+  auto const nthreads = get_radix_nthreads();
+  std::vector<U> digits(static_cast<std::size_t>(n));
+  std::vector<U> digits_tmp(static_cast<std::size_t>(n));
+  std::vector<LO> perm_tmp(static_cast<std::size_t>(n));
+  U* keys_a = digits.data();
+  U* keys_b = digits_tmp.data();
+  LO* perm_a = perm;
+  LO* perm_b = perm_tmp.data();
+  for (Int j = N - 1; j >= 0; --j) {
+    if (ranges[j] == 0) continue;
+    auto const min_key = mins[j];
+#if defined(OMEGA_H_USE_OPENMP)
+#pragma omp parallel for
+#endif
+    for (LO i = 0; i < n; ++i) {
+      keys_a[i] = U(U(keys[perm_a[i] * N + j]) - U(min_key));
+    }
+    auto const column_passes = count_radix_passes(ranges[j]);
+    for (Int pass = 0; pass < column_passes; ++pass) {
+      if (radix_pass(n, keys_a, perm_a, keys_b, perm_b, pass * radix_bits,
+              nthreads)) {
+        std::swap(keys_a, keys_b);
+        std::swap(perm_a, perm_b);
+      }
+    }
+  }
+  if (perm_a != perm) std::copy(perm_a, perm_a + n, perm);
+  end_code();
+  return true;
+}
+
+#endif
+
 template <Int N, typename T>
 static LOs sort_by_keys_tmpl(Read<T> keys) {
   begin_code("sort_by_keys");
@@ -76,8 +233,11 @@ static LOs sort_by_keys_tmpl(Read<T> keys) {
   LO* begin = perm.data();
   LO* end = perm.data() + n;
   T const* keyptr = keys.data();
-  parallel_sort<LO, CompareKeySets<T, N>>(
-      begin, end, CompareKeySets<T, N>(keyptr));
+#if !defined(OMEGA_H_USE_CUDA)
+  if (!try_radix_sort<N>(n, keyptr, begin))
+#endif
+    parallel_sort<LO, CompareKeySets<T, N>>(
+        begin, end, CompareKeySets<T, N>(keyptr));
   end_code();
   return perm;
 }
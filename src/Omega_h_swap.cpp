@@ -18,6 +18,7 @@ bool swap_part1(Mesh* mesh, AdaptOpts const& opts) {
       mark_sliver_layers(mesh, opts.min_quality_desired, opts.nsliver_layers);
   OMEGA_H_CHECK(get_max(comm, elems_are_cands) == 1);
   auto edges_are_cands = mark_down(mesh, mesh->dim(), EDGE, elems_are_cands);
+  edges_are_cands = restrict_to_region(mesh, opts, EDGE, edges_are_cands);
   /* only swap interior edges */
   auto edges_are_inter = mark_by_class_dim(mesh, EDGE, mesh->dim());
   edges_are_cands = land_each(edges_are_cands, edges_are_inter);
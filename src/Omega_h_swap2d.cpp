@@ -52,6 +52,8 @@ static void swap2d_element_based(Mesh* mesh, AdaptOpts const& opts) {
   HostFew<LOs, 3> prod_verts2verts;
   swap2d_topology(mesh, keys2edges, &keys2prods, &prod_verts2verts);
   auto old_lows2new_lows = LOs(mesh->nverts(), 0, 1);
+  Few<LOs, 4> old_ents2new_ents_by_dim;
+  old_ents2new_ents_by_dim[VERT] = old_lows2new_lows;
   for (Int ent_dim = EDGE; ent_dim <= 2; ++ent_dim) {
     auto prods2new_ents = LOs();
     auto same_ents2old_ents = LOs();
@@ -61,6 +63,9 @@ static void swap2d_element_based(Mesh* mesh, AdaptOpts const& opts) {
         keys2prods[ent_dim], prod_verts2verts[ent_dim], old_lows2new_lows,
         &prods2new_ents, &same_ents2old_ents, &same_ents2new_ents,
         &old_ents2new_ents);
+    old_ents2new_ents_by_dim[ent_dim] = old_ents2new_ents;
+    modify_adjs(mesh, &new_mesh, ent_dim, old_ents2new_ents_by_dim,
+        prods2new_ents);
     transfer_swap(mesh, opts.xfer_opts, &new_mesh, ent_dim, keys2edges,
         keys2prods[ent_dim], prods2new_ents, same_ents2old_ents,
         same_ents2new_ents);
@@ -1,5 +1,7 @@
 #include "Omega_h_transfer.hpp"
 
+#include <vector>
+
 #include "Omega_h_affine.hpp"
 #include "Omega_h_conserve.hpp"
 #include "Omega_h_fit.hpp"
@@ -22,7 +24,7 @@ bool should_inherit(
   auto& name = tag->name();
   if (!(is_transfer_required(opts, name, OMEGA_H_INHERIT) ||
           name == "class_id" || name == "class_dim" ||
-          name == "momentum_velocity_fixed")) {
+          name == "momentum_velocity_fixed" || name == "adapt_region")) {
     return false;
   }
   for (Int i = 0; i <= mesh->dim(); ++i) {
@@ -652,6 +654,63 @@ void transfer_copy(
   if (opts.user_xfer) opts.user_xfer->swap_copy_verts(*old_mesh, *new_mesh);
 }
 
+static Reals interpolate_at_barys(Mesh* mesh, LOs keys2elems,
+    Reals keys2barys, Reals vert_data, Int ncomps) {
+  auto nkeys = keys2elems.size();
+  auto nverts_per_elem = mesh->dim() + 1;
+  auto kv2v = mesh->ask_elem_verts();
+  Write<Real> key_data(nkeys * ncomps);
+  auto f = OMEGA_H_LAMBDA(LO key) {
+    auto k = keys2elems[key];
+    for (Int c = 0; c < ncomps; ++c) {
+      Real sum = 0.0;
+      for (Int j = 0; j < nverts_per_elem; ++j) {
+        auto v = kv2v[k * nverts_per_elem + j];
+        auto w = keys2barys[key * nverts_per_elem + j];
+        sum += w * vert_data[v * ncomps + c];
+      }
+      key_data[key * ncomps + c] = sum;
+    }
+  };
+  parallel_for(nkeys, f, "interpolate_at_barys");
+  return key_data;
+}
+
+void transfer_smooth(Mesh* mesh, TransferOpts const& opts, LOs keys2verts,
+    LOs keys2elems, Reals keys2barys) {
+  begin_code("transfer_smooth");
+  auto nverts = mesh->nverts();
+  auto nkeys = keys2verts.size();
+  /* every new value is computed from the old ones before any is set,
+     since setting the coordinates or the metric drops the cached
+     lengths and qualities. they are synchronized together */
+  std::vector<std::string> names;
+  std::vector<Read<Real>> new_arrays;
+  std::vector<Int> widths;
+  for (Int i = 0; i < mesh->ntags(VERT); ++i) {
+    auto tagbase = mesh->get_tag(VERT, i);
+    auto metric = is_metric(mesh, opts, VERT, tagbase);
+    if (!metric && !should_interpolate(mesh, opts, VERT, tagbase)) continue;
+    auto const& name = tagbase->name();
+    auto ncomps = tagbase->ncomps();
+    auto old_data = mesh->get_array<Real>(VERT, name);
+    auto vert_data = metric ? linearize_metrics(nverts, old_data) : old_data;
+    auto key_data =
+        interpolate_at_barys(mesh, keys2elems, keys2barys, vert_data, ncomps);
+    if (metric) key_data = delinearize_metrics(nkeys, key_data);
+    auto new_data = deep_copy(old_data);
+    map_into(key_data, keys2verts, new_data, ncomps);
+    names.push_back(name);
+    new_arrays.push_back(new_data);
+    widths.push_back(ncomps);
+  }
+  new_arrays = mesh->sync_arrays(VERT, new_arrays, widths);
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    mesh->set_tag(VERT, names[i], new_arrays[i]);
+  }
+  end_code();
+}
+
 template <typename T>
 static void transfer_inherit_swap_tmpl(Mesh* old_mesh, Mesh* new_mesh,
     Int prod_dim, LOs keys2edges, LOs keys2prods, LOs prods2new_ents,
@@ -47,6 +47,12 @@ void transfer_swap(Mesh* old_mesh, TransferOpts const& opts, Mesh* new_mesh,
 void transfer_copy(
     Mesh* old_mesh, TransferOpts const& opts, Mesh* new_mesh, Int prod_dim);
 
+/* moves each of (keys2verts) to the point with barycentric coordinates
+   (keys2barys) in (keys2elems), interpolating the vertex fields
+   there. the keys must be owned */
+void transfer_smooth(Mesh* mesh, TransferOpts const& opts, LOs keys2verts,
+    LOs keys2elems, Reals keys2barys);
+
 template <typename T>
 void transfer_common3(
     Mesh* new_mesh, Int ent_dim, TagBase const* tagbase, Write<T> new_data);
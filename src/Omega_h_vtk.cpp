@@ -14,6 +14,7 @@
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_base64.hpp"
 #include "Omega_h_build.hpp"
+#include "Omega_h_compress.hpp"
 #include "Omega_h_element.hpp"
 #include "Omega_h_file.hpp"
 #include "Omega_h_mesh.hpp"
@@ -123,7 +124,7 @@ static bool read_array_start_tag(std::istream& stream, Omega_h_Type* type_out,
 
 template <typename T_osh, typename T_vtk>
 void write_array(std::ostream& stream, std::string const& name, Int ncomps,
-    Read<T_osh> array, bool compress) {
+    Read<T_osh> array, bool compress, Codec codec) {
   OMEGA_H_TIME_FUNCTION;
   if (!(array.exists())) {
     Omega_h_fail("vtk::write_array: \"%s\" doesn't exist\n", name.c_str());
@@ -140,25 +141,31 @@ void write_array(std::ostream& stream, std::string const& name, Int ncomps,
   std::string encoded;
 #ifdef OMEGA_H_USE_ZLIB
   if (compress) {
+    /* VTK readers can't unshuffle, every other codec is plain zlib */
+    if (codec == CODEC_SHUFFLE_ZLIB) codec = CODEC_ZLIB;
     begin_code("zlib");
-    uLong source_bytes = uncompressed_bytes;
-    uLong dest_bytes = ::compressBound(source_bytes);
-    auto compressed = new ::Bytef[dest_bytes];
-    int ret = ::compress2(compressed, &dest_bytes,
-        reinterpret_cast<const ::Bytef*>(nonnull(uncompressed.data())),
-        source_bytes, Z_BEST_SPEED);
+    auto const blocks = compress_blocks(nonnull(uncompressed.data()),
+        uncompressed_bytes, sizeof(T_osh), codec);
     end_code();
-    OMEGA_H_CHECK(ret == Z_OK);
     begin_code("base64");
-    encoded = base64::encode(compressed, dest_bytes);
-    delete[] compressed;
-    std::uint64_t header[4] = {
-        1, uncompressed_bytes, uncompressed_bytes, dest_bytes};
-    enc_header = base64::encode(header, sizeof(header));
+    encoded = base64::encode(blocks.data.data(), blocks.data.size());
+    /* the multi-block header of vtkZLibDataCompressor:
+       number of blocks, uncompressed block size,
+       uncompressed size of the last block if it is partial (else zero),
+       then the compressed size of each block */
+    auto const nblocks = blocks.sizes.size();
+    auto last_partial_bytes = uncompressed_bytes;
+    if (nblocks > 1) last_partial_bytes %= blocks.block_bytes;
+    std::vector<std::uint64_t> header = {
+        nblocks, blocks.block_bytes, last_partial_bytes};
+    header.insert(header.end(), blocks.sizes.begin(), blocks.sizes.end());
+    enc_header = base64::encode(
+        header.data(), header.size() * sizeof(std::uint64_t));
     end_code();
   } else
 #else
   OMEGA_H_CHECK(!compress);
+  (void)codec;
 #endif
   {
     begin_code("base64 bulk");
@@ -178,6 +185,43 @@ void write_array(std::ostream& stream, std::string const& name, Int ncomps,
   end_code();
 }
 
+#ifdef OMEGA_H_USE_ZLIB
+/* reads the multi-block header of vtkZLibDataCompressor,
+   of which the header written by older versions (one block) is
+   a special case */
+static CompressedBlocks read_compressed_header(std::string const& enc_both,
+    bool needs_swapping, std::uint64_t* uncompressed_bytes_out,
+    std::size_t* nheader_chars_out) {
+  /* the first three entries are whole base64 quads on their own */
+  std::uint64_t prefix[3];
+  auto nheader_chars = base64::encoded_size(sizeof(prefix));
+  base64::decode(enc_both.substr(0, nheader_chars), prefix, sizeof(prefix));
+  auto nblocks = prefix[0];
+  if (needs_swapping) binary::swap_bytes(nblocks);
+  OMEGA_H_CHECK(nblocks >= 1);
+  std::vector<std::uint64_t> header(3 + nblocks);
+  auto const header_bytes = header.size() * sizeof(std::uint64_t);
+  nheader_chars = base64::encoded_size(header_bytes);
+  auto const enc_header = enc_both.substr(0, nheader_chars);
+  base64::decode(enc_header, header.data(), header_bytes);
+  if (needs_swapping) {
+    for (auto& value : header) binary::swap_bytes(value);
+  }
+  CompressedBlocks blocks;
+  blocks.block_bytes = header[1];
+  auto const last_partial_bytes = header[2];
+  blocks.sizes.assign(header.begin() + 3, header.end());
+  if (last_partial_bytes) {
+    *uncompressed_bytes_out =
+        (nblocks - 1) * blocks.block_bytes + last_partial_bytes;
+  } else {
+    *uncompressed_bytes_out = nblocks * blocks.block_bytes;
+  }
+  *nheader_chars_out = nheader_chars;
+  return blocks;
+}
+#endif
+
 template <typename T>
 static Read<T> read_array(
     std::istream& stream, LO size, bool needs_swapping, bool is_compressed) {
@@ -185,20 +229,12 @@ static Read<T> read_array(
   std::uint64_t uncompressed_bytes;
   std::string encoded;
 #ifdef OMEGA_H_USE_ZLIB
-  std::uint64_t compressed_bytes;
+  CompressedBlocks blocks;
   if (is_compressed) {
-    std::uint64_t header[4];
-    auto nheader_chars = base64::encoded_size(sizeof(header));
-    auto enc_header = enc_both.substr(0, nheader_chars);
-    base64::decode(enc_header, header, sizeof(header));
-    if (needs_swapping) {
-      for (std::uint64_t i = 0; i < 4; ++i) {
-        binary::swap_bytes(header[i]);
-      }
-    }
+    std::size_t nheader_chars;
+    blocks = read_compressed_header(
+        enc_both, needs_swapping, &uncompressed_bytes, &nheader_chars);
     encoded = enc_both.substr(nheader_chars);
-    uncompressed_bytes = header[2];
-    compressed_bytes = header[3];
   } else
 #else
   OMEGA_H_CHECK(is_compressed == false);
@@ -208,29 +244,18 @@ static Read<T> read_array(
     auto enc_header = enc_both.substr(0, nheader_chars);
     base64::decode(enc_header, &uncompressed_bytes, sizeof(uncompressed_bytes));
     if (needs_swapping) binary::swap_bytes(uncompressed_bytes);
-#ifdef OMEGA_H_USE_ZLIB
-    compressed_bytes = uncompressed_bytes;
-#endif
     encoded = enc_both.substr(nheader_chars);
   }
   OMEGA_H_CHECK(uncompressed_bytes == std::uint64_t(size) * sizeof(T));
   HostWrite<T> uncompressed(size);
 #ifdef OMEGA_H_USE_ZLIB
   if (is_compressed) {
-    auto compressed = new ::Bytef[compressed_bytes];
-    base64::decode(encoded, compressed, compressed_bytes);
-    uLong dest_bytes = static_cast<uLong>(uncompressed_bytes);
-    uLong source_bytes = static_cast<uLong>(compressed_bytes);
-    ::Bytef* uncompressed_ptr =
-        reinterpret_cast< ::Bytef*>(nonnull(uncompressed.data()));
-    int ret =
-        ::uncompress(uncompressed_ptr, &dest_bytes, compressed, source_bytes);
-    if (ret != Z_OK) {
-      Omega_h_fail(
-          "code %d: couln't decompress \"%s\"\n", ret, encoded.c_str());
-    }
-    OMEGA_H_CHECK(dest_bytes == static_cast<uLong>(uncompressed_bytes));
-    delete[] compressed;
+    std::uint64_t compressed_bytes = 0;
+    for (auto const block_size : blocks.sizes) compressed_bytes += block_size;
+    blocks.data.resize(compressed_bytes);
+    base64::decode(encoded, blocks.data.data(), compressed_bytes);
+    decompress_blocks(blocks, sizeof(T), CODEC_ZLIB,
+        nonnull(uncompressed.data()), uncompressed_bytes);
   } else
 #endif
   {
@@ -239,18 +264,18 @@ static Read<T> read_array(
   return binary::swap_bytes(Read<T>(uncompressed.write()), needs_swapping);
 }
 
-void write_tag(
-    std::ostream& stream, TagBase const* tag, Int space_dim, bool compress) {
+void write_tag(std::ostream& stream, TagBase const* tag, Int space_dim,
+    bool compress, Codec codec) {
   OMEGA_H_TIME_FUNCTION;
   if (is<I8>(tag)) {
-    write_array(
-        stream, tag->name(), tag->ncomps(), as<I8>(tag)->array(), compress);
+    write_array(stream, tag->name(), tag->ncomps(), as<I8>(tag)->array(),
+        compress, codec);
   } else if (is<I32>(tag)) {
-    write_array(
-        stream, tag->name(), tag->ncomps(), as<I32>(tag)->array(), compress);
+    write_array(stream, tag->name(), tag->ncomps(), as<I32>(tag)->array(),
+        compress, codec);
   } else if (is<I64>(tag)) {
-    write_array(
-        stream, tag->name(), tag->ncomps(), as<I64>(tag)->array(), compress);
+    write_array(stream, tag->name(), tag->ncomps(), as<I64>(tag)->array(),
+        compress, codec);
   } else if (is<Real>(tag)) {
     Reals array = as<Real>(tag)->array();
     if (1 < space_dim && space_dim < 3) {
@@ -260,17 +285,18 @@ void write_tag(
         // this filter adds a 3rd zero component to any
         // fields with 2 components for 2D meshes
         write_array(stream, tag->name(), 3, resize_vectors(array, space_dim, 3),
-            compress);
+            compress, codec);
       } else if (tag->ncomps() == symm_ncomps(space_dim)) {
         // Likewise, ParaView has component names specially set up for
         // 3D symmetric tensors
         write_array(stream, tag->name(), symm_ncomps(3),
-            resize_symms(array, space_dim, 3), compress);
+            resize_symms(array, space_dim, 3), compress, codec);
       } else {
-        write_array(stream, tag->name(), tag->ncomps(), array, compress);
+        write_array(
+            stream, tag->name(), tag->ncomps(), array, compress, codec);
       }
     } else {
-      write_array(stream, tag->name(), tag->ncomps(), array, compress);
+      write_array(stream, tag->name(), tag->ncomps(), array, compress, codec);
     }
   } else {
     Omega_h_fail("unknown tag type in write_tag");
@@ -392,17 +418,17 @@ static void read_piece_start_tag(
   *ncells_out = std::stoi(st.attribs["NumberOfCells"]);
 }
 
-static void write_connectivity(
-    std::ostream& stream, Mesh* mesh, Int cell_dim, bool compress) {
+static void write_connectivity(std::ostream& stream, Mesh* mesh, Int cell_dim,
+    bool compress, Codec codec) {
   Read<I8> types(mesh->nents(cell_dim), vtk_type(mesh->family(), cell_dim));
-  write_array(stream, "types", 1, types, compress);
+  write_array(stream, "types", 1, types, compress, codec);
   LOs ev2v = mesh->ask_verts_of(cell_dim);
   auto deg = element_degree(mesh->family(), cell_dim, VERT);
   /* starts off already at the end of the first entity's adjacencies,
      increments by a constant value */
   LOs ends(mesh->nents(cell_dim), deg, deg);
-  write_array(stream, "connectivity", 1, ev2v, compress);
-  write_array(stream, "offsets", 1, ends, compress);
+  write_array(stream, "connectivity", 1, ev2v, compress, codec);
+  write_array(stream, "offsets", 1, ends, compress, codec);
 }
 
 static void read_connectivity(std::istream& stream, CommPtr comm, LO ncells,
@@ -444,35 +470,36 @@ static void read_connectivity(std::istream& stream, CommPtr comm, LO ncells,
       stream, "offsets", ncells, 1, needs_swapping, is_compressed);
 }
 
-static void write_locals(
-    std::ostream& stream, Mesh* mesh, Int ent_dim, bool compress) {
-  write_array(
-      stream, "local", 1, Read<LO>(mesh->nents(ent_dim), 0, 1), compress);
+static void write_locals(std::ostream& stream, Mesh* mesh, Int ent_dim,
+    bool compress, Codec codec) {
+  write_array(stream, "local", 1, Read<LO>(mesh->nents(ent_dim), 0, 1),
+      compress, codec);
 }
 
-static void write_owners(
-    std::ostream& stream, Mesh* mesh, Int ent_dim, bool compress) {
+static void write_owners(std::ostream& stream, Mesh* mesh, Int ent_dim,
+    bool compress, Codec codec) {
   if (mesh->comm()->size() == 1) return;
-  write_array(stream, "owner", 1, mesh->ask_owners(ent_dim).ranks, compress);
+  write_array(stream, "owner", 1, mesh->ask_owners(ent_dim).ranks, compress,
+      codec);
 }
 
-static void write_vtk_ghost_types(
-    std::ostream& stream, Mesh* mesh, Int ent_dim, bool compress) {
+static void write_vtk_ghost_types(std::ostream& stream, Mesh* mesh,
+    Int ent_dim, bool compress, Codec codec) {
   if (mesh->comm()->size() == 1) return;
   const auto owned = mesh->owned(ent_dim);
   auto ghost_types = each_eq_to(owned, static_cast<I8>(0));
   write_array<I8, std::uint8_t>(
-      stream, "vtkGhostType", 1, ghost_types, compress);
+      stream, "vtkGhostType", 1, ghost_types, compress, codec);
 }
 
 static void write_locals_and_owners(std::ostream& stream, Mesh* mesh,
-    Int ent_dim, TagSet const& tags, bool compress) {
+    Int ent_dim, TagSet const& tags, bool compress, Codec codec) {
   OMEGA_H_TIME_FUNCTION;
   if (tags[size_t(ent_dim)].count("local")) {
-    write_locals(stream, mesh, ent_dim, compress);
+    write_locals(stream, mesh, ent_dim, compress, codec);
   }
   if (tags[size_t(ent_dim)].count("owner")) {
-    write_owners(stream, mesh, ent_dim, compress);
+    write_owners(stream, mesh, ent_dim, compress, codec);
   }
 }
 
@@ -600,7 +627,7 @@ void write_vtkfile_vtu_start_tag(std::ostream& stream, bool compress) {
 }
 
 void write_vtu(std::ostream& stream, Mesh* mesh, Int cell_dim,
-    TagSet const& tags, bool compress) {
+    TagSet const& tags, bool compress, Codec codec) {
   OMEGA_H_TIME_FUNCTION;
   default_dim(mesh, &cell_dim);
   verify_vtk_tagset(mesh, cell_dim, tags);
@@ -608,24 +635,25 @@ void write_vtu(std::ostream& stream, Mesh* mesh, Int cell_dim,
   stream << "<UnstructuredGrid>\n";
   write_piece_start_tag(stream, mesh, cell_dim);
   stream << "<Cells>\n";
-  write_connectivity(stream, mesh, cell_dim, compress);
+  write_connectivity(stream, mesh, cell_dim, compress, codec);
   stream << "</Cells>\n";
   stream << "<Points>\n";
   auto coords = mesh->coords();
   write_array(stream, "coordinates", 3, resize_vectors(coords, mesh->dim(), 3),
-      compress);
+      compress, codec);
   stream << "</Points>\n";
   stream << "<PointData>\n";
   /* globals go first so read_vtu() knows where to find them */
   if (mesh->has_tag(VERT, "global") && tags[VERT].count("global")) {
-    write_tag(stream, mesh->get_tag<GO>(VERT, "global"), mesh->dim(), compress);
+    write_tag(stream, mesh->get_tag<GO>(VERT, "global"), mesh->dim(), compress,
+        codec);
   }
-  write_locals_and_owners(stream, mesh, VERT, tags, compress);
+  write_locals_and_owners(stream, mesh, VERT, tags, compress, codec);
   for (Int i = 0; i < mesh->ntags(VERT); ++i) {
     auto tag = mesh->get_tag(VERT, i);
     if (tag->name() != "coordinates" && tag->name() != "global" &&
         tags[VERT].count(tag->name())) {
-      write_tag(stream, tag, mesh->dim(), compress);
+      write_tag(stream, tag, mesh->dim(), compress, codec);
     }
   }
   stream << "</PointData>\n";
@@ -633,17 +661,17 @@ void write_vtu(std::ostream& stream, Mesh* mesh, Int cell_dim,
   /* globals go first so read_vtu() knows where to find them */
   if (mesh->has_tag(cell_dim, "global") &&
       tags[size_t(cell_dim)].count("global")) {
-    write_tag(
-        stream, mesh->get_tag<GO>(cell_dim, "global"), mesh->dim(), compress);
+    write_tag(stream, mesh->get_tag<GO>(cell_dim, "global"), mesh->dim(),
+        compress, codec);
   }
-  write_locals_and_owners(stream, mesh, cell_dim, tags, compress);
+  write_locals_and_owners(stream, mesh, cell_dim, tags, compress, codec);
   if (tags[size_t(cell_dim)].count("vtkGhostType")) {
-    write_vtk_ghost_types(stream, mesh, cell_dim, compress);
+    write_vtk_ghost_types(stream, mesh, cell_dim, compress, codec);
   }
   for (Int i = 0; i < mesh->ntags(cell_dim); ++i) {
     auto tag = mesh->get_tag(cell_dim, i);
     if (tag->name() != "global" && tags[size_t(cell_dim)].count(tag->name())) {
-      write_tag(stream, tag, mesh->dim(), compress);
+      write_tag(stream, tag, mesh->dim(), compress, codec);
     }
   }
   stream << "</CellData>\n";
@@ -722,11 +750,11 @@ void read_vtu_ents(std::istream& stream, Mesh* mesh) {
 }
 
 void write_vtu(filesystem::path const& filename, Mesh* mesh, Int cell_dim,
-    TagSet const& tags, bool compress) {
+    TagSet const& tags, bool compress, Codec codec) {
   std::ofstream file(filename.c_str());
   OMEGA_H_CHECK(file.is_open());
   ask_for_mesh_tags(mesh, tags);
-  write_vtu(file, mesh, cell_dim, tags, compress);
+  write_vtu(file, mesh, cell_dim, tags, compress, codec);
 }
 
 void write_vtu(
@@ -855,7 +883,7 @@ void read_pvtu(filesystem::path const& pvtupath, CommPtr comm, I32* npieces_out,
 }
 
 void write_parallel(filesystem::path const& path, Mesh* mesh, Int cell_dim,
-    TagSet const& tags, bool compress) {
+    TagSet const& tags, bool compress, Codec codec) {
   ScopedTimer timer("vtk::write_parallel");
   default_dim(mesh, &cell_dim);
   ask_for_mesh_tags(mesh, tags);
@@ -875,7 +903,8 @@ void write_parallel(filesystem::path const& path, Mesh* mesh, Int cell_dim,
     auto const relative_piecepath = filesystem::path("pieces") / "piece";
     write_pvtu(pvtuname, mesh, cell_dim, relative_piecepath, tags);
   }
-  write_vtu(piece_filename(piecepath, rank), mesh, cell_dim, tags, compress);
+  write_vtu(
+      piece_filename(piecepath, rank), mesh, cell_dim, tags, compress, codec);
 }
 
 void write_parallel(
@@ -1004,15 +1033,17 @@ Writer::Writer()
       root_path_("/not-set"),
       cell_dim_(-1),
       compress_(OMEGA_H_DEFAULT_COMPRESS),
+      codec_(CODEC_ZLIB),
       step_(-1),
       pvd_pos_(0) {}
 
 Writer::Writer(filesystem::path const& root_path, Mesh* mesh, Int cell_dim,
-    Real restart_time, bool compress)
+    Real restart_time, bool compress, Codec codec)
     : mesh_(mesh),
       root_path_(root_path),
       cell_dim_(cell_dim),
       compress_(compress),
+      codec_(codec),
       step_(0),
       pvd_pos_(0) {
   default_dim(mesh_, &cell_dim_);
@@ -1034,8 +1065,8 @@ Writer::Writer(filesystem::path const& root_path, Mesh* mesh, Int cell_dim,
 
 void Writer::write(I64 step, Real time, TagSet const& tags) {
   step_ = step;
-  write_parallel(
-      get_step_path(root_path_, step_), mesh_, cell_dim_, tags, compress_);
+  write_parallel(get_step_path(root_path_, step_), mesh_, cell_dim_, tags,
+      compress_, codec_);
   if (mesh_->comm()->rank() == 0) {
     update_pvd(root_path_, &pvd_pos_, step_, time);
   }
@@ -1053,7 +1084,7 @@ void Writer::write(Real time) {
 void Writer::write() { this->write(Real(step_)); }
 
 FullWriter::FullWriter(filesystem::path const& root_path, Mesh* mesh,
-    Real restart_time, bool compress) {
+    Real restart_time, bool compress, Codec codec) {
   auto const comm = mesh->comm();
   auto const rank = comm->rank();
   if (rank == 0) {
@@ -1062,7 +1093,7 @@ FullWriter::FullWriter(filesystem::path const& root_path, Mesh* mesh,
   comm->barrier();
   for (Int i = EDGE; i <= mesh->dim(); ++i) {
     writers_.push_back(Writer(root_path / dimensional_plural_name(i), mesh, i,
-        restart_time, compress));
+        restart_time, compress, codec));
   }
 }
 
@@ -1078,7 +1109,7 @@ void FullWriter::write() {
   template void write_p_data_array<T>(                                         \
       std::ostream & stream, std::string const& name, Int ncomps);             \
   template void write_array(std::ostream& stream, std::string const& name,     \
-      Int ncomps, Read<T> array, bool compress);
+      Int ncomps, Read<T> array, bool compress, Codec codec);
 OMEGA_H_EXPL_INST(I8)
 OMEGA_H_EXPL_INST(I32)
 OMEGA_H_EXPL_INST(I64)
@@ -1086,7 +1117,8 @@ OMEGA_H_EXPL_INST(Real)
 #undef OMEGA_H_EXPL_INST
 
 template void write_array<Real, std::uint8_t>(std::ostream& stream,
-    std::string const& name, Int ncomps, Read<Real> array, bool compress);
+    std::string const& name, Int ncomps, Read<Real> array, bool compress,
+    Codec codec);
 
 }  // end namespace vtk
 
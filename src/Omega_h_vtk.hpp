@@ -55,8 +55,8 @@ void write_vtkfile_vtu_start_tag(std::ostream& stream, bool compress);
 
 void write_p_tag(std::ostream& stream, TagBase const* tag, Int space_dim);
 
-void write_tag(
-    std::ostream& stream, TagBase const* tag, Int space_dim, bool compress);
+void write_tag(std::ostream& stream, TagBase const* tag, Int space_dim,
+    bool compress, Codec codec = CODEC_ZLIB);
 
 template <typename T>
 void write_p_data_array(
@@ -64,13 +64,14 @@ void write_p_data_array(
 
 template <typename T_osh, typename T_vtk = T_osh>
 void write_array(std::ostream& stream, std::string const& name, Int ncomps,
-    Read<T_osh> array, bool compress);
+    Read<T_osh> array, bool compress, Codec codec = CODEC_ZLIB);
 
 #define OMEGA_H_EXPL_INST_DECL(T)                                              \
   extern template void write_p_data_array<T>(                                  \
       std::ostream & stream, std::string const& name, Int ncomps);             \
   extern template void write_array(std::ostream& stream,                       \
-      std::string const& name, Int ncomps, Read<T> array, bool compress);
+      std::string const& name, Int ncomps, Read<T> array, bool compress,       \
+      Codec codec);
 OMEGA_H_EXPL_INST_DECL(I8)
 OMEGA_H_EXPL_INST_DECL(I32)
 OMEGA_H_EXPL_INST_DECL(I64)
@@ -78,7 +79,8 @@ OMEGA_H_EXPL_INST_DECL(Real)
 #undef OMEGA_H_EXPL_INST_DECL
 
 extern template void write_array<Real, std::uint8_t>(std::ostream& stream,
-    std::string const& name, Int ncomps, Read<Real> array, bool compress);
+    std::string const& name, Int ncomps, Read<Real> array, bool compress,
+    Codec codec);
 
 }  // namespace vtk
 
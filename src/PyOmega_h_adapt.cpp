@@ -36,6 +36,8 @@ void pybind11_adapt(py::module& module) {
       .def_readwrite("max_gradation_rate", &MetricInput::max_gradation_rate)
       .def_readwrite("gradation_convergence_tolerance",
           &MetricInput::gradation_convergence_tolerance)
+      .def_readwrite("should_limit_gradation_by_front",
+          &MetricInput::should_limit_gradation_by_front)
       .def_readwrite("should_limit_element_count",
           &MetricInput::should_limit_element_count)
       .def_readwrite("max_element_count", &MetricInput::max_element_count)
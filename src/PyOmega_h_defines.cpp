@@ -15,6 +15,12 @@ void pybind11_defines(py::module& module) {
       .value("GHOSTED", OMEGA_H_GHOSTED)
       .value("VERT_BASED", OMEGA_H_VERT_BASED)
       .export_values();
+  py::enum_<Omega_h_Balancer>(
+      module, "Balancer", "The partitioner used to balance a mesh")
+      .value("RIB", OMEGA_H_RIB)
+      .value("MULTILEVEL", OMEGA_H_MULTILEVEL)
+      .value("HILBERT", OMEGA_H_HILBERT)
+      .export_values();
   py::enum_<Omega_h_Source>(
       module, "Source", "The type of source of a metric field")
       .value("CONSTANT", OMEGA_H_CONSTANT)
@@ -21,6 +21,8 @@ void pybind11_mesh(py::module& module) {
   OMEGA_H_DECL_TYPE(Real, float64)
   void (Mesh::*set_parting)(Omega_h_Parting, Int, bool) = &Mesh::set_parting;
   void (Mesh::*balance)(bool) = &Mesh::balance;
+  void (Mesh::*balance_with)(Omega_h_Balancer, bool) = &Mesh::balance;
+  void (Mesh::*balance_masses)(Reals, Omega_h_Balancer) = &Mesh::balance;
   py::class_<Omega_h::Mesh>(module, "Mesh")
       .def("dim", &Omega_h::Mesh::dim)
       .def("nents", &Omega_h::Mesh::nents)
@@ -31,7 +33,11 @@ void pybind11_mesh(py::module& module) {
               OMEGA_H_DEF_TYPE(Real, float64)
       .def("min_quality", &Omega_h::Mesh::min_quality)
       .def("max_length", &Omega_h::Mesh::max_length)
-      .def("balance", balance, py::arg("predictive") = false);
+      .def("balance", balance, py::arg("predictive") = false)
+      .def("balance", balance_with, py::arg("balancer"),
+          py::arg("predictive") = false)
+      .def("balance", balance_masses, py::arg("masses"),
+          py::arg("balancer") = OMEGA_H_RIB);
   module.def(
       "new_empty_mesh", []() { return Mesh(pybind11_global_library.get()); });
 }
@@ -212,7 +212,7 @@ static void run_case(Library* lib, Case const& c, Int niters) {
       map_into(obj_motion, ov2v, motion_w, mesh.dim());
     }
     auto motion = Reals(motion_w);
-    motion = solve_laplacian(&mesh, motion, mesh.dim(), 1e-2);
+    motion = solve_laplacian(&mesh, motion, mesh.dim(), 1e-4);
     mesh.add_tag(VERT, "warp", mesh.dim(), motion);
     // auto metrics = mesh.get_array<Real>(VERT, "metric");
     // auto lengths = lengths_from_isos(metrics);
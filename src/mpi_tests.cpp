@@ -1,12 +1,24 @@
 #include <Omega_h_array_ops.hpp>
 #include <Omega_h_bipart.hpp>
 #include <Omega_h_build.hpp>
+#include <Omega_h_coarsen.hpp>
+#include <Omega_h_comm_stats.hpp>
 #include <Omega_h_compare.hpp>
+#include <Omega_h_filesystem.hpp>
 #include <Omega_h_for.hpp>
+#include <Omega_h_ghost.hpp>
 #include <Omega_h_inertia.hpp>
+#include <Omega_h_laplace.hpp>
+#include <Omega_h_mark.hpp>
+#include <Omega_h_metric.hpp>
+#include <Omega_h_multilevel.hpp>
 #include <Omega_h_owners.hpp>
+#include <Omega_h_profile.hpp>
+#include <Omega_h_refine.hpp>
+#include <Omega_h_refine_coarsen.hpp>
 #include <Omega_h_vtk.hpp>
 
+#include <fstream>
 #include <sstream>
 
 using namespace Omega_h;
@@ -80,6 +92,18 @@ static void test_two_ranks_dist(CommPtr comm) {
   }
   auto c = dist.invert().exch(b, 1);
   OMEGA_H_CHECK(c == a);
+  /* repeated exchanges go through the persistent plan and
+     must neither alias nor disturb earlier results */
+  dist.keep_plans();
+  auto copy = dist;
+  auto b2 = copy.exch(a, 1);
+  auto b3 = dist.exch(multiply_each_by(a, 2.), 1);
+  OMEGA_H_CHECK(b2 == b);
+  OMEGA_H_CHECK(b3 == multiply_each_by(b, 2.));
+  for (Int i = 0; i < 3; ++i) {
+    auto c2 = dist.invert().exch(b, 1);
+    OMEGA_H_CHECK(c2 == a);
+  }
 }
 
 static void test_two_ranks_dist_for_two_variable_sized_actors(CommPtr comm) {
@@ -363,6 +387,321 @@ static void test_binary_io(Library* lib, CommPtr comm) {
       OMEGA_H_SAME == compare_meshes(&mesh0, &mesh2, opts, true, true));
 }
 
+static void test_unghost(CommPtr comm) {
+  auto mesh0 = build_box(comm, OMEGA_H_SIMPLEX, 1., 1., 1., 2, 2, 2);
+  mesh0.set_parting(OMEGA_H_ELEM_BASED);
+  auto mesh1 = mesh0;
+  mesh1.set_parting(OMEGA_H_GHOSTED, 2, false);
+  OMEGA_H_CHECK(mesh1.nelems() > mesh0.nelems());
+  mesh1.set_parting(OMEGA_H_ELEM_BASED);
+  auto opts = MeshCompareOpts::init(&mesh0, VarCompareOpts::zero_tolerance());
+  OMEGA_H_CHECK(
+      OMEGA_H_SAME == compare_meshes(&mesh0, &mesh1, opts, true, true));
+  for (Int d = 0; d <= mesh1.dim(); ++d) {
+    auto nowned = get_sum(comm, mesh1.owned(d));
+    OMEGA_H_CHECK(nowned == mesh1.nglobal_ents(d));
+  }
+}
+
+/* checks that (a) and (b) have the same copies in the same order */
+static void check_same_copies(Mesh* a, Mesh* b) {
+  for (Int d = 0; d <= a->dim(); ++d) {
+    OMEGA_H_CHECK(a->nents(d) == b->nents(d));
+    OMEGA_H_CHECK(a->globals(d) == b->globals(d));
+    OMEGA_H_CHECK(a->ask_owners(d).ranks == b->ask_owners(d).ranks);
+    OMEGA_H_CHECK(a->ask_owners(d).idxs == b->ask_owners(d).idxs);
+    if (d == VERT) continue;
+    OMEGA_H_CHECK(a->ask_down(d, d - 1).ab2b == b->ask_down(d, d - 1).ab2b);
+    if (d == EDGE) continue;
+    OMEGA_H_CHECK(
+        a->ask_down(d, d - 1).codes == b->ask_down(d, d - 1).codes);
+  }
+  OMEGA_H_CHECK(*a == *b);
+}
+
+/* after refining around one corner and coarsening around the other,
+   ghosting from what was kept of the last ghost layer gives the same
+   mesh as ghosting from scratch */
+static void test_incremental_ghosting(CommPtr comm) {
+  auto mesh = build_box(comm, OMEGA_H_SIMPLEX, 1., 1., 1., 4, 4, 4);
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  auto set_metric = [&](Vector<3> spot, Real spot_h) {
+    auto coords = mesh.coords();
+    Write<Real> metrics(mesh.nverts());
+    auto f = OMEGA_H_LAMBDA(LO v) {
+      auto near = norm(get_vector<3>(coords, v) - spot) < 0.3;
+      metrics[v] = metric_eigenvalue_from_length(near ? spot_h : 0.32);
+    };
+    parallel_for(mesh.nverts(), f);
+    mesh.add_tag(VERT, "metric", 1, Reals(metrics));
+  };
+  auto check_ghosting = [&]() {
+    OMEGA_H_CHECK(mesh.ghost_history());
+    auto full = mesh;
+    full.set_ghost_history(Mesh::GhostHistoryPtr());
+    full.set_parting(OMEGA_H_GHOSTED);
+    mesh.set_parting(OMEGA_H_GHOSTED);
+    check_same_copies(&mesh, &full);
+  };
+  set_metric(vector_3(0., 0., 0.), 0.1);
+  OMEGA_H_CHECK(refine_by_size(&mesh, opts));
+  check_ghosting();
+  set_metric(vector_3(1., 1., 1.), 2.0);
+  OMEGA_H_CHECK(coarsen_by_size(&mesh, opts));
+  check_ghosting();
+}
+
+static void test_laplacian(CommPtr comm) {
+  auto mesh = build_box(comm, OMEGA_H_SIMPLEX, 1., 1., 0., 8, 8, 0);
+  mesh.set_parting(OMEGA_H_GHOSTED);
+  auto coords = mesh.coords();
+  auto interior = mark_by_class_dim(&mesh, VERT, 2);
+  auto initial_w = Write<Real>(mesh.nverts());
+  auto expected_w = Write<Real>(mesh.nverts());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<2>(coords, v);
+    expected_w[v] = 3.0 * x[0] - x[1];
+    initial_w[v] = interior[v] ? 0.0 : expected_w[v];
+  };
+  parallel_for(mesh.nverts(), f);
+  auto solution = solve_laplacian(&mesh, initial_w, 1, 1e-10);
+  OMEGA_H_CHECK(are_close(solution, Reals(expected_w), 1e-8, 1e-8));
+  OMEGA_H_CHECK(mesh.sync_array(VERT, solution, 1) == solution);
+}
+
+static void test_gradation_front(CommPtr comm) {
+  auto mesh = build_box(comm, OMEGA_H_SIMPLEX, 1., 1., 0., 8, 8, 0);
+  mesh.set_parting(OMEGA_H_GHOSTED);
+  auto coords = mesh.coords();
+  /* one small size in a corner, which limiting spreads outward */
+  auto isos_w = Write<Real>(mesh.nverts());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<2>(coords, v);
+    isos_w[v] = (norm(x) < 1e-6) ? 1e-3 : 1.0;
+  };
+  parallel_for(mesh.nverts(), f);
+  auto metrics = metrics_from_isos(2, read(isos_w));
+  auto expected = limit_metric_gradation(&mesh, metrics, 1.0, 1e-6, false);
+  auto front =
+      limit_metric_gradation_front(&mesh, metrics, 1.0, 1e-6, false);
+  OMEGA_H_CHECK(are_close(front, expected, 1e-4));
+  OMEGA_H_CHECK(mesh.sync_array(VERT, front, 3) == front);
+}
+
+static void test_refine_coarsen(CommPtr comm) {
+  auto mesh = build_box(comm, OMEGA_H_SIMPLEX, 1., 1., 0., 8, 8, 0);
+  mesh.set_parting(OMEGA_H_ELEM_BASED);
+  /* small elements wanted on the left half, large ones on the right,
+     so every pass both splits and collapses */
+  auto coords = mesh.coords();
+  auto metrics_w = Write<Real>(mesh.nverts());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto h = (coords[v * 2 + 0] < 0.5) ? 0.06 : 0.5;
+    metrics_w[v] = metric_eigenvalue_from_length(h);
+  };
+  parallel_for(mesh.nverts(), f);
+  mesh.add_tag(VERT, "metric", 1, Reals(metrics_w));
+  mesh.add_tag(VERT, "u", 1, get_component(coords, 2, 0));
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  opts.should_fuse_refine_coarsen = true;
+  opts.xfer_opts.type_map["u"] = OMEGA_H_LINEAR_INTERP;
+  auto nelems = mesh.nglobal_ents(FACE);
+  Int npasses = 0;
+  while (refine_coarsen_by_size(&mesh, opts)) {
+    ++npasses;
+    auto x = get_component(mesh.coords(), 2, 0);
+    OMEGA_H_CHECK(are_close(mesh.get_array<Real>(VERT, "u"), x));
+    OMEGA_H_CHECK(get_min(comm, mesh.ask_qualities()) > 0.0);
+  }
+  OMEGA_H_CHECK(npasses > 0);
+  OMEGA_H_CHECK(mesh.nglobal_ents(FACE) > nelems);
+  mesh.set_parting(OMEGA_H_GHOSTED);
+  auto u = mesh.get_array<Real>(VERT, "u");
+  OMEGA_H_CHECK(mesh.sync_array(VERT, u, 1) == u);
+}
+
+static void test_sync_batched(CommPtr comm) {
+  auto mesh = build_box(comm, OMEGA_H_SIMPLEX, 1., 1., 0., 4, 4, 0);
+  mesh.set_parting(OMEGA_H_ELEM_BASED);
+  auto nverts = mesh.nverts();
+  auto globals = mesh.globals(VERT);
+  auto owned = mesh.owned(VERT);
+  Write<I8> a_w(nverts);
+  Write<I32> b_w(nverts * 2);
+  Write<Real> c_w(nverts * 3);
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto g = globals[v];
+    auto o = owned[v];
+    a_w[v] = o ? I8(g % 100) : I8(-1);
+    for (Int j = 0; j < 2; ++j) b_w[v * 2 + j] = o ? I32(g * 2 + j) : -1;
+    for (Int j = 0; j < 3; ++j) c_w[v * 3 + j] = o ? Real(g) + 0.25 * j : -1.;
+  };
+  parallel_for(nverts, f);
+  mesh.add_tag<I8>(VERT, "a", 1, read(a_w));
+  mesh.add_tag<I32>(VERT, "b", 2, read(b_w));
+  mesh.add_tag<GO>(VERT, "c", 1, globals);
+  mesh.add_tag<Real>(VERT, "d", 3, read(c_w));
+  auto a = mesh.sync_array(VERT, read(a_w), 1);
+  auto b = mesh.sync_array(VERT, read(b_w), 2);
+  auto c = mesh.sync_array(VERT, read(c_w), 3);
+  mesh.sync_tags(VERT, {"a", "b", "c", "d"});
+  OMEGA_H_CHECK(mesh.get_array<I8>(VERT, "a") == a);
+  OMEGA_H_CHECK(mesh.get_array<I32>(VERT, "b") == b);
+  OMEGA_H_CHECK(mesh.get_array<GO>(VERT, "c") == globals);
+  OMEGA_H_CHECK(mesh.get_array<Real>(VERT, "d") == c);
+  auto bs = mesh.sync_arrays<I32>(
+      VERT, {read(b_w), LOs(nverts, 1), read(b_w)}, {2, 1, 2});
+  OMEGA_H_CHECK(bs.size() == 3);
+  OMEGA_H_CHECK(bs[0] == b && bs[1] == LOs(nverts, 1) && bs[2] == b);
+  auto sums = mesh.reduce_arrays<Real>(
+      VERT, {read(c_w), Reals(nverts, 1.)}, {3, 1}, OMEGA_H_SUM);
+  OMEGA_H_CHECK(sums.size() == 2);
+  OMEGA_H_CHECK(
+      sums[0] == mesh.reduce_array(VERT, read(c_w), 3, OMEGA_H_SUM));
+  OMEGA_H_CHECK(
+      sums[1] == mesh.reduce_array(VERT, Reals(nverts, 1.), 1, OMEGA_H_SUM));
+}
+
+static void test_balance(CommPtr comm, Omega_h_Balancer balancer) {
+  auto rib = build_box(comm, OMEGA_H_SIMPLEX, 1., 1., 1., 4, 4, 4);
+  auto mesh = rib;
+  mesh.balance(balancer);
+  OMEGA_H_CHECK(mesh.parting() == OMEGA_H_ELEM_BASED);
+  OMEGA_H_CHECK(mesh.nelems() > 0);
+  OMEGA_H_CHECK(mesh.imbalance() < 1.05);
+  auto opts = MeshCompareOpts::init(&rib, VarCompareOpts::zero_tolerance());
+  OMEGA_H_CHECK(
+      OMEGA_H_SAME == compare_meshes(&rib, &mesh, opts, true, true));
+}
+
+static void test_weighted_balance(CommPtr comm, Omega_h_Balancer balancer) {
+  auto mesh = build_box(comm, OMEGA_H_SIMPLEX, 1., 1., 1., 4, 4, 4);
+  auto dim = mesh.dim();
+  auto centroids = average_field(&mesh, dim, dim, mesh.coords());
+  Write<Real> costs(mesh.nelems());
+  auto f = OMEGA_H_LAMBDA(LO e) {
+    costs[e] = (centroids[e * dim] < 0.5) ? 3.0 : 1.0;
+  };
+  parallel_for(mesh.nelems(), f);
+  /* carried along by the migration */
+  mesh.add_tag(dim, "cost", 1, Reals(costs));
+  mesh.balance(mesh.get_array<Real>(dim, "cost"), balancer);
+  OMEGA_H_CHECK(mesh.imbalance(mesh.get_array<Real>(dim, "cost")) < 1.05);
+  /* a rank that took three times as long gets three times the weight */
+  auto time = Real(1 + 2 * comm->rank());
+  auto masses = time_weighted_masses(&mesh, Reals(mesh.nelems(), 1.0), time);
+  auto share = get_sum(masses) / get_sum(comm, masses);
+  OMEGA_H_CHECK(are_close(share, time / comm->allreduce(time, OMEGA_H_SUM)));
+  mesh.balance(masses, balancer);
+  OMEGA_H_CHECK(mesh.nelems() > 0);
+}
+
+/* with one part per rank, the cut is the number of interior sides
+   whose elements are on different ranks, and each such side has
+   only one element on its owner */
+static void test_edge_cut(CommPtr comm) {
+  auto mesh = build_box(comm, OMEGA_H_SIMPLEX, 1., 1., 1., 4, 4, 4);
+  auto dim = mesh.dim();
+  auto sides2elems = mesh.ask_up(dim - 1, dim).a2ab;
+  auto sides_are_interior = mark_by_class_dim(&mesh, dim - 1, dim);
+  auto sides_are_owned = mesh.owned(dim - 1);
+  Write<LO> sides_are_cut(mesh.nents(dim - 1));
+  auto f = OMEGA_H_LAMBDA(LO s) {
+    sides_are_cut[s] = sides_are_interior[s] && sides_are_owned[s] &&
+                       (sides2elems[s + 1] - sides2elems[s] == 1);
+  };
+  parallel_for(mesh.nents(dim - 1), f);
+  auto expected = GO(get_sum(comm, LOs(sides_are_cut)));
+  OMEGA_H_CHECK((expected > 0) == (comm->size() > 1));
+  auto parts = Read<I32>(mesh.nelems(), comm->rank());
+  OMEGA_H_CHECK(multilevel::edge_cut(&mesh, parts) == expected);
+}
+
+static void test_comm_stats(CommPtr comm) {
+  auto other = 1 - comm->rank();
+  auto dist = Dist(comm, Remotes(Read<I32>(3, other), LOs(3, 0, 1)), 3);
+  comm_stats::Stats stats(comm);
+  comm_stats::global_singleton_stats = &stats;
+  /* the second exchange goes through a persistent plan */
+  dist.keep_plans();
+  dist.exch(Reals(6, 1.0), 2);
+  dist.exch(Reals(6, 1.0), 2);
+  comm->allreduce(I32(1), OMEGA_H_SUM);
+  comm_stats::global_singleton_stats = nullptr;
+  OMEGA_H_CHECK(stats.sites.size() == 3);
+  for (auto op : {"Comm::alltoallv", "AlltoallvPlan::exch"}) {
+    auto& site = stats.sites.at(op);
+    OMEGA_H_CHECK(site.calls == 1);
+    OMEGA_H_CHECK(site.messages == 1);
+    OMEGA_H_CHECK(site.neighbors == 1);
+    OMEGA_H_CHECK(site.bytes_sent == 48.0);
+    OMEGA_H_CHECK(site.bytes_received == 48.0);
+  }
+  OMEGA_H_CHECK(stats.sites.at("Comm::allreduce").bytes_sent == 4.0);
+  OMEGA_H_CHECK(stats.traffic.size() == 1);
+  OMEGA_H_CHECK(stats.traffic.at(other) == 96.0);
+  OMEGA_H_CHECK(
+      dist.comm()->world_destinations(comm) == std::vector<I32>({other}));
+  auto const traffic_path =
+      filesystem::temp_directory_path() / "omega_h_comm_traffic.csv";
+  comm_stats::write_traffic(stats, traffic_path.string());
+  if (comm->rank() == 0) {
+    std::ifstream file(traffic_path.c_str());
+    std::string line;
+    std::getline(file, line);
+    OMEGA_H_CHECK(line == "source,destination,bytes");
+    std::getline(file, line);
+    OMEGA_H_CHECK(line == "0,1,96");
+    std::getline(file, line);
+    OMEGA_H_CHECK(line == "1,0,96");
+    file.close();
+    filesystem::remove(traffic_path);
+  }
+  /* a Dist that does not keep plans never builds one */
+  auto once = Dist(comm, Remotes(Read<I32>(3, other), LOs(3, 0, 1)), 3);
+  comm_stats::Stats once_stats(comm);
+  comm_stats::global_singleton_stats = &once_stats;
+  once.exch(Reals(6, 1.0), 2);
+  once.exch(Reals(6, 1.0), 2);
+  comm_stats::global_singleton_stats = nullptr;
+  OMEGA_H_CHECK(once_stats.sites.at("Comm::alltoallv").calls == 2);
+  OMEGA_H_CHECK(!once_stats.sites.count("AlltoallvPlan::exch"));
+  /* a caller whose name only contains that of a communication
+     frame is still named as the site */
+  if (!profile::global_singleton_history) {
+    profile::History history;
+    profile::global_singleton_history = &history;
+    comm_stats::Stats named_stats(comm);
+    comm_stats::global_singleton_stats = &named_stats;
+    {
+      ScopedTimer timer("exchange_fields");
+      comm->allreduce(I32(1), OMEGA_H_SUM);
+    }
+    comm_stats::global_singleton_stats = nullptr;
+    profile::global_singleton_history = nullptr;
+    OMEGA_H_CHECK(named_stats.sites.count("exchange_fields: Comm::allreduce"));
+  }
+}
+
+static void test_shared_memory_exchange(Library* lib, CommPtr comm) {
+  auto const was_shared = lib->shared_memory_exchange_;
+  lib->shared_memory_exchange_ = true;
+  test_two_ranks_dist(comm);
+  /* alternate exchanges use alternate halves of the window,
+     so run enough of them to reuse both */
+  auto other = 1 - comm->rank();
+  auto dist = Dist(comm, Remotes(Read<I32>(3, other), LOs(3, 0, 1)), 3);
+  dist.keep_plans();
+  for (Int i = 0; i < 5; ++i) {
+    auto a = Reals(3, Real(i + comm->rank()));
+    auto b = dist.exch(a, 1);
+    OMEGA_H_CHECK(b == Reals(3, Real(i + other)));
+  }
+  lib->shared_memory_exchange_ = was_shared;
+}
+
 static void test_two_ranks(Library* lib, CommPtr comm) {
   test_two_ranks_dist(comm);
   test_two_ranks_dist_for_two_variable_sized_actors(comm);
@@ -374,6 +713,19 @@ static void test_two_ranks(Library* lib, CommPtr comm) {
   test_construct(lib, comm);
   test_read_vtu(lib, comm);
   test_binary_io(lib, comm);
+  test_unghost(comm);
+  test_sync_batched(comm);
+  test_incremental_ghosting(comm);
+  test_laplacian(comm);
+  test_gradation_front(comm);
+  test_refine_coarsen(comm);
+  test_comm_stats(comm);
+  test_shared_memory_exchange(lib, comm);
+  test_balance(comm, OMEGA_H_MULTILEVEL);
+  test_balance(comm, OMEGA_H_HILBERT);
+  test_weighted_balance(comm, OMEGA_H_RIB);
+  test_weighted_balance(comm, OMEGA_H_HILBERT);
+  test_edge_cut(comm);
 }
 
 void test_rib(CommPtr comm) {
@@ -425,4 +777,6 @@ int main(int argc, char** argv) {
   }
   world->barrier();
   test_rib(world);
+  test_edge_cut(world);
+  if (world->size() % 2 == 0) test_incremental_ghosting(world);
 }
@@ -0,0 +1,710 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Omega_h_adapt.hpp>
+#include <Omega_h_adj.hpp>
+#include <Omega_h_array_ops.hpp>
+#include <Omega_h_build.hpp>
+#include <Omega_h_cmdline.hpp>
+#include <Omega_h_coarsen.hpp>
+#include <Omega_h_eigen.hpp>
+#include <Omega_h_fence.hpp>
+#include <Omega_h_file.hpp>
+#include <Omega_h_for.hpp>
+#include <Omega_h_ghost.hpp>
+#include <Omega_h_library.hpp>
+#include <Omega_h_mesh.hpp>
+#include <Omega_h_metric.hpp>
+#include <Omega_h_multilevel.hpp>
+#include <Omega_h_refine.hpp>
+#include <Omega_h_sort.hpp>
+#include <Omega_h_swap.hpp>
+#include <Omega_h_timer.hpp>
+
+#ifdef OMEGA_H_USE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace Omega_h;
+
+/* osh_perf reproduces (and extends) the table in misc/typical_perf.txt.
+   Every measurement is printed as a human-readable line and, if requested,
+   collected into a JSON document so results can be compared across builds
+   and machines. */
+
+namespace {
+
+struct PerfResult {
+  std::string name;
+  std::string description;
+  GO size;
+  Int repeats;
+  Real seconds;
+};
+
+struct PerfLog {
+  CommPtr comm;
+  std::vector<PerfResult> results;
+  PerfLog(CommPtr comm_in) : comm(comm_in) {}
+  Now start() {
+    fence();
+    comm->barrier();
+    return now();
+  }
+  /* the time of a measurement is the time of the slowest rank */
+  void stop(Now t0, std::string const& name, std::string const& description,
+      GO size, Int repeats) {
+    fence();
+    auto t1 = now();
+    auto seconds = comm->allreduce(Real(t1 - t0), OMEGA_H_MAX);
+    if (comm->rank() == 0) {
+      std::cout << description << " takes " << seconds << " seconds\n";
+    }
+    results.push_back({name, description, size, repeats, seconds});
+  }
+};
+
+std::string json_escape(std::string const& s) {
+  std::string out;
+  for (auto c : s) {
+    if (c == '"' || c == '\\') out.push_back('\\');
+    out.push_back(c);
+  }
+  return out;
+}
+
+void write_json(PerfLog const& log, std::string const& path) {
+  std::ofstream file(path.c_str());
+  OMEGA_H_CHECK(file.is_open());
+  file << std::setprecision(9);
+  file << "{\n";
+  file << "  \"version\": \"" << json_escape(Library::static_version())
+       << "\",\n";
+  file << "  \"commit\": \"" << json_escape(Library::static_commit_id())
+       << "\",\n";
+  file << "  \"nranks\": " << log.comm->size() << ",\n";
+#ifdef OMEGA_H_USE_OPENMP
+  file << "  \"backend\": \"openmp\",\n";
+  file << "  \"nthreads\": " << omp_get_max_threads() << ",\n";
+#elif defined(OMEGA_H_USE_CUDA)
+  file << "  \"backend\": \"cuda\",\n";
+  file << "  \"nthreads\": 1,\n";
+#else
+  file << "  \"backend\": \"serial\",\n";
+  file << "  \"nthreads\": 1,\n";
+#endif
+  file << "  \"benchmarks\": [\n";
+  for (std::size_t i = 0; i < log.results.size(); ++i) {
+    auto& r = log.results[i];
+    file << "    {\"name\": \"" << json_escape(r.name) << "\", ";
+    file << "\"description\": \"" << json_escape(r.description) << "\", ";
+    file << "\"size\": " << r.size << ", ";
+    file << "\"repeats\": " << r.repeats << ", ";
+    file << "\"seconds\": " << r.seconds << "}";
+    if (i + 1 < log.results.size()) file << ",";
+    file << "\n";
+  }
+  file << "  ]\n";
+  file << "}\n";
+}
+
+std::string describe(std::string const& what, LO n, Int repeats) {
+  std::stringstream ss;
+  ss << what << " of " << n << " metric tensors " << repeats << " times";
+  return ss.str();
+}
+
+Reals random_metrics(LO n) {
+  Write<Real> metrics(n * symm_ncomps(3));
+  auto f = OMEGA_H_LAMBDA(LO i) {
+    auto angle = Real(i % 360) * (PI / 180.0);
+    auto axis = normalize(vector_3(1.0, Real(i % 7), Real(i % 11)));
+    auto r = rotate(angle, axis);
+    auto h = vector_3(1e-3, 1.0, 1e3);
+    set_symm(metrics, i, compose_metric(r, h));
+  };
+  parallel_for(n, f);
+  return metrics;
+}
+
+void perf_metric_decomposition(PerfLog& log, LO n) {
+  auto metrics = random_metrics(n);
+  Write<Real> out(n * symm_ncomps(3));
+  auto f = OMEGA_H_LAMBDA(LO i) {
+    auto dd = decompose_eigen(get_symm<3>(metrics, i));
+    set_symm(out, i, compose_ortho(dd.q, dd.l));
+  };
+  Int const nrepeats = 3;
+  auto t0 = log.start();
+  for (Int i = 0; i < nrepeats; ++i) parallel_for("perf", n, f);
+  log.stop(t0, "metric_decomposition",
+      describe("eigendecomposition", n, nrepeats), n, nrepeats);
+}
+
+/* the same work as perf_metric_decomposition(),
+   (eigen_pack_width) tensors at a time */
+void perf_metric_decomposition_batched(PerfLog& log, LO n) {
+  auto metrics = random_metrics(n);
+  Write<Real> out(n * symm_ncomps(3));
+  auto const npacks = (n + eigen_pack_width - 1) / eigen_pack_width;
+  auto f = OMEGA_H_LAMBDA(LO pack) {
+    auto const first = pack * eigen_pack_width;
+    auto const nlanes = min2(eigen_pack_width, n - first);
+    SymmPack<3> ms;
+    for (Int k = 0; k < eigen_pack_width; ++k) {
+      set_lane(ms, k, get_symm<3>(metrics, first + min2(k, nlanes - 1)));
+    }
+    auto const dds = decompose_symm_pack(ms);
+    for (Int k = 0; k < nlanes; ++k) {
+      auto const dd = get_lane(dds, k);
+      set_symm(out, first + k, compose_ortho(dd.q, dd.l));
+    }
+  };
+  Int const nrepeats = 3;
+  auto t0 = log.start();
+  for (Int i = 0; i < nrepeats; ++i) parallel_for("perf", npacks, f);
+  std::stringstream ss;
+  ss << "batched " << describe("eigendecomposition", n, nrepeats) << ", "
+     << eigen_pack_width << " per pack";
+  log.stop(t0, "metric_decomposition_batched", ss.str(), n, nrepeats);
+}
+
+void perf_linearize_metrics(PerfLog& log, LO n) {
+  auto metrics = random_metrics(n);
+  Write<Real> out(n * symm_ncomps(3));
+  auto f = OMEGA_H_LAMBDA(LO i) {
+    set_symm(out, i, linearize_metric(get_symm<3>(metrics, i)));
+  };
+  Int const nrepeats = 3;
+  auto t0 = log.start();
+  for (Int i = 0; i < nrepeats; ++i) parallel_for("perf", n, f);
+  log.stop(t0, "linearize_metrics_per_tensor",
+      describe("per-tensor logarithm", n, nrepeats), n, nrepeats);
+  auto t1 = log.start();
+  for (Int i = 0; i < nrepeats; ++i) linearize_metrics(n, metrics);
+  log.stop(t1, "linearize_metrics", describe("logarithm", n, nrepeats), n,
+      nrepeats);
+}
+
+void perf_metric_inversion(PerfLog& log, LO n) {
+  auto metrics = random_metrics(n);
+  Write<Real> out(n * symm_ncomps(3));
+  auto f = OMEGA_H_LAMBDA(LO i) {
+    set_symm(out, i, invert(get_symm<3>(metrics, i)));
+  };
+  Int const nrepeats = 30;
+  auto t0 = log.start();
+  for (Int i = 0; i < nrepeats; ++i) parallel_for("perf", n, f);
+  log.stop(t0, "metric_inversion", describe("inversion", n, nrepeats), n,
+      nrepeats);
+}
+
+void perf_sum(PerfLog& log, LO n) {
+  Write<Real> w(n);
+  auto f = OMEGA_H_LAMBDA(LO i) { w[i] = std::sqrt(Real(i + 1)); };
+  parallel_for(n, f);
+  Reals a(w);
+  Int const nrepeats = 100;
+  Real repro = 0.0;
+  auto t0 = log.start();
+  for (Int i = 0; i < nrepeats; ++i) repro = repro_sum(a);
+  std::stringstream ss;
+  ss << "reproducibly adding " << n << " reals " << nrepeats << " times";
+  log.stop(t0, "repro_sum", ss.str(), n, nrepeats);
+  Real naive = 0.0;
+  t0 = log.start();
+  for (Int i = 0; i < nrepeats; ++i) naive = get_sum(a);
+  ss.str("");
+  ss << "adding " << n << " reals " << nrepeats << " times";
+  log.stop(t0, "sum", ss.str(), n, nrepeats);
+  if (repro == naive && log.comm->rank() == 0) {
+    std::cout << "warning: the naive sum gave the same answer\n";
+  }
+}
+
+void perf_sort_by_keys(PerfLog& log, LO n, Int width) {
+  Write<LO> keys(n * width);
+  auto f = OMEGA_H_LAMBDA(LO i) {
+    for (Int j = 0; j < width; ++j) {
+      auto h = std::uint32_t(i * width + j) * 2654435761u;
+      keys[i * width + j] = LO(h % std::uint32_t(n));
+    }
+  };
+  parallel_for(n, f);
+  LOs read_keys(keys);
+  Int const nrepeats = 5;
+  auto t0 = log.start();
+  for (Int i = 0; i < nrepeats; ++i) sort_by_keys(read_keys, width);
+  std::stringstream ss;
+  ss << "sorting " << n << " sets of " << width << " integers " << nrepeats
+     << " times";
+  log.stop(t0, "sort_by_keys_" + std::to_string(width), ss.str(), n,
+      nrepeats);
+}
+
+Mesh perf_build_box(PerfLog& log, Library* lib, LO nx) {
+  auto t0 = log.start();
+  auto mesh = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 1., nx, nx, nx);
+  std::stringstream ss;
+  ss << "building a " << nx << "x" << nx << "x" << nx << " box";
+  log.stop(t0, "build_box", ss.str(), mesh.nglobal_ents(3), 1);
+  return mesh;
+}
+
+void perf_reorder(PerfLog& log, Mesh* mesh) {
+  auto t0 = log.start();
+  reorder_by_hilbert(mesh);
+  std::stringstream ss;
+  ss << "reordering a " << mesh->nelems() << " tet mesh";
+  log.stop(t0, "reorder_by_hilbert", ss.str(), mesh->nelems(), 1);
+}
+
+void perf_ask_verts(PerfLog& log, Mesh* mesh) {
+  auto t0 = log.start();
+  mesh->ask_verts_of(REGION);
+  mesh->ask_verts_of(FACE);
+  std::stringstream ss;
+  ss << "asking tet->vert and tri->vert of a " << mesh->nelems()
+     << " tet mesh";
+  log.stop(t0, "ask_verts_of", ss.str(), mesh->nelems(), 1);
+}
+
+void perf_invert_adj(PerfLog& log, Mesh* mesh) {
+  auto tets2verts = mesh->ask_down(REGION, VERT);
+  Int const nrepeats = 5;
+  auto t0 = log.start();
+  for (Int i = 0; i < nrepeats; ++i) {
+    invert_adj(tets2verts, 4, mesh->nverts(), REGION, VERT);
+  }
+  std::stringstream ss;
+  ss << "inverting " << mesh->nelems() << " tets -> verts " << nrepeats
+     << " times";
+  log.stop(t0, "invert_adj", ss.str(), mesh->nelems(), nrepeats);
+}
+
+void perf_reflect_down(PerfLog& log, Mesh* mesh) {
+  auto tets2verts = mesh->ask_verts_of(REGION);
+  auto tris2verts = mesh->ask_verts_of(FACE);
+  auto verts2tris = mesh->ask_up(VERT, FACE);
+  Int const nrepeats = 2;
+  auto t0 = log.start();
+  for (Int i = 0; i < nrepeats; ++i) {
+    reflect_down(
+        tets2verts, tris2verts, verts2tris, mesh->family(), REGION, FACE);
+  }
+  std::stringstream ss;
+  ss << "reflect_down " << mesh->nelems() << " tets -> tris by only upward "
+     << nrepeats << " times";
+  log.stop(t0, "reflect_down", ss.str(), mesh->nelems(), nrepeats);
+}
+
+void perf_find_unique(PerfLog& log, Mesh* mesh) {
+  auto tets2verts = mesh->ask_verts_of(REGION);
+  Int const nrepeats = 2;
+  UniqueMethod const methods[] = {
+      UNIQUE_BY_SORTING, UNIQUE_BY_HASHING, UNIQUE_BY_HASHING_IN_USE_ORDER};
+  char const* const names[] = {
+      "find_unique_sort", "find_unique_hash", "find_unique_hash_use_order"};
+  for (Int m = 0; m < 3; ++m) {
+    auto const method = methods[m];
+    auto const name = names[m];
+    auto t0 = log.start();
+    for (Int i = 0; i < nrepeats; ++i) {
+      Adj tets2tris;
+      find_unique(
+          tets2verts, mesh->family(), REGION, FACE, &tets2tris, method);
+    }
+    std::stringstream ss;
+    ss << name << " " << mesh->nelems() << " tets -> tris and tets2tris "
+       << nrepeats << " times";
+    log.stop(t0, name, ss.str(), mesh->nelems(), nrepeats);
+  }
+}
+
+/* one exchange per tag against a single batched exchange of all of them,
+   counting the messages sent over all ranks */
+void perf_sync_tags(PerfLog& log, Mesh* mesh) {
+  auto comm = mesh->comm();
+  auto nverts = mesh->nverts();
+  mesh->add_tag(VERT, "sync_i8", 1, Read<I8>(nverts, 1));
+  mesh->add_tag(VERT, "sync_i32", 2, Read<I32>(nverts * 2, 1));
+  mesh->add_tag(VERT, "sync_i64", 1, Read<I64>(nverts, 1));
+  mesh->add_tag(VERT, "sync_scalar", 1, Reals(nverts, 1.));
+  mesh->add_tag(VERT, "sync_vector", 3, Reals(nverts * 3, 1.));
+  mesh->add_tag(VERT, "sync_tensor", 6, Reals(nverts * 6, 1.));
+  std::vector<std::string> names = {"sync_i8", "sync_i32", "sync_i64",
+      "sync_scalar", "sync_vector", "sync_tensor"};
+  GO nmsgs = 0;
+  if (mesh->could_be_shared(VERT)) {
+    auto nneighbors = mesh->ask_dist(VERT).invert().msgs2ranks().size();
+    nmsgs = comm->allreduce(GO(nneighbors), OMEGA_H_SUM);
+  }
+  Int const nrepeats = 10;
+  auto ntags = GO(names.size());
+  {
+    auto t0 = log.start();
+    for (Int i = 0; i < nrepeats; ++i) {
+      for (auto& name : names) mesh->sync_tag(VERT, name);
+    }
+    std::stringstream ss;
+    ss << "syncing " << ntags << " vertex tags one at a time ("
+       << ntags * nmsgs << " messages) " << nrepeats << " times";
+    log.stop(t0, "sync_tag", ss.str(), nverts, nrepeats);
+  }
+  {
+    auto t0 = log.start();
+    for (Int i = 0; i < nrepeats; ++i) mesh->sync_tags(VERT, names);
+    std::stringstream ss;
+    ss << "syncing " << ntags << " vertex tags together (" << nmsgs
+       << " messages) " << nrepeats << " times";
+    log.stop(t0, "sync_tags", ss.str(), nverts, nrepeats);
+  }
+  for (auto& name : names) mesh->remove_tag(VERT, name);
+}
+
+void perf_ghost(PerfLog& log, Mesh* mesh) {
+  auto t0 = log.start();
+  ghost_mesh(mesh, 1, false);
+  std::stringstream ss;
+  ss << "ghosting a " << mesh->nglobal_ents(mesh->dim()) << " tet mesh";
+  log.stop(t0, "ghost_mesh", ss.str(), mesh->nelems(), 1);
+}
+
+/* ghosting again after refining around one corner, from what was
+   kept of the last ghost layer against from scratch */
+void perf_reghost(PerfLog& log, Mesh const& base, LO nx) {
+  auto mesh = base;
+  auto dim = mesh.dim();
+  mesh.set_parting(OMEGA_H_GHOSTED);
+  mesh.set_parting(OMEGA_H_ELEM_BASED);
+  auto coords = mesh.coords();
+  auto h = 0.5 / Real(nx);
+  Write<Real> metrics(mesh.nverts());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto near = norm(get_vector<3>(coords, v)) < 0.25;
+    metrics[v] = metric_eigenvalue_from_length(near ? h : 1.0);
+  };
+  parallel_for(mesh.nverts(), f);
+  mesh.add_tag(VERT, "metric", 1, Reals(metrics));
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  auto nelems = mesh.nglobal_ents(dim);
+  refine_by_size(&mesh, opts);
+  auto nnew = mesh.nglobal_ents(dim) - nelems;
+  mesh.ask_up(VERT, dim);
+  auto full = mesh;
+  full.set_ghost_history(Mesh::GhostHistoryPtr());
+  {
+    auto t0 = log.start();
+    full.set_parting(OMEGA_H_GHOSTED);
+    std::stringstream ss;
+    ss << "ghosting from scratch after refining to " << nnew
+       << " more elements";
+    log.stop(t0, "reghost_full", ss.str(), full.nelems(), 1);
+  }
+  {
+    auto t0 = log.start();
+    mesh.set_parting(OMEGA_H_GHOSTED);
+    std::stringstream ss;
+    ss << "ghosting from the last ghost layer after refining to " << nnew
+       << " more elements";
+    log.stop(t0, "reghost_incremental", ss.str(), mesh.nelems(), 1);
+  }
+}
+
+/* limiting the gradation of a metric that is fine in one corner,
+   sweeping every vertex each step against sweeping the front */
+void perf_gradation(PerfLog& log, Mesh* mesh) {
+  mesh->set_parting(OMEGA_H_GHOSTED);
+  auto dim = mesh->dim();
+  auto coords = mesh->coords();
+  auto isos_w = Write<Real>(mesh->nverts());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    Real r = 0.0;
+    for (Int i = 0; i < dim; ++i) r += square(coords[v * dim + i]);
+    isos_w[v] = (r < 0.01) ? 1e-3 : 1.0;
+  };
+  parallel_for(mesh->nverts(), f);
+  auto metrics = metrics_from_isos(dim, read(isos_w));
+  {
+    auto t0 = log.start();
+    limit_metric_gradation(mesh, metrics, 1.0, 1e-3, false);
+    log.stop(t0, "limit_metric_gradation", "limiting gradation sweeping all",
+        mesh->nverts(), 1);
+  }
+  {
+    auto t0 = log.start();
+    limit_metric_gradation_front(mesh, metrics, 1.0, 1e-3, false);
+    log.stop(t0, "limit_metric_gradation_front",
+        "limiting gradation sweeping the front", mesh->nverts(), 1);
+  }
+}
+
+/* besides the time, reports the dual graph edges the partition
+   cuts, the vertex copies a sync_array fills in and the ghosted
+   ratio once a layer of ghosts is added, which is what the
+   partition costs every later exchange */
+void perf_balance(PerfLog& log, Mesh* mesh, Omega_h_Balancer balancer) {
+  auto comm = mesh->comm();
+  auto balanced = *mesh;
+  char const* name = "RIB";
+  if (balancer == OMEGA_H_MULTILEVEL) name = "multilevel";
+  if (balancer == OMEGA_H_HILBERT) name = "Hilbert";
+  auto t0 = log.start();
+  balanced.balance(balancer);
+  std::stringstream ss;
+  ss << "balancing a " << mesh->nglobal_ents(mesh->dim()) << " tet mesh with "
+     << name;
+  log.stop(t0, std::string("balance_") + name, ss.str(), mesh->nelems(), 1);
+  auto cut = multilevel::edge_cut(
+      &balanced, Read<I32>(balanced.nelems(), comm->rank()));
+  auto nshared = comm->allreduce(
+      GO(balanced.nverts() - balanced.nents_owned(VERT)), OMEGA_H_SUM);
+  auto imbalance = balanced.imbalance();
+  ghost_mesh(&balanced, 1, false);
+  auto ghosted_ratio =
+      comm->allreduce(balanced.ghosted_ratio(balanced.dim()), OMEGA_H_MAX);
+  if (comm->rank() == 0) {
+    std::cout << "  " << name << " partition: edge cut " << cut
+              << ", shared vertex copies " << nshared << ", imbalance "
+              << imbalance << ", max ghosted ratio " << ghosted_ratio << '\n';
+  }
+}
+
+std::string get_codec_suffix(Codec codec) {
+  switch (codec) {
+    case CODEC_ZLIB:
+      return "";
+    case CODEC_SHUFFLE_ZLIB:
+      return "_shuffle";
+    case CODEC_ZLIB_HUFFMAN:
+      return "_huffman";
+  }
+  return "";
+}
+
+std::string get_codec_adjective(Codec codec) {
+  switch (codec) {
+    case CODEC_ZLIB:
+      return "";
+    case CODEC_SHUFFLE_ZLIB:
+      return "shuffled ";
+    case CODEC_ZLIB_HUFFMAN:
+      return "Huffman-coded ";
+  }
+  return "";
+}
+
+void perf_binary_io(
+    PerfLog& log, Mesh* mesh, bool compress, Codec codec = CODEC_ZLIB) {
+  std::string const path = "osh_perf_tmp.osh";
+  std::string const suffix =
+      compress ? get_codec_suffix(codec) : "_uncompressed";
+  std::string const kind =
+      compress ? "a " + get_codec_adjective(codec) : "an uncompressed ";
+  auto t0 = log.start();
+  binary::write(path, mesh, compress, codec);
+  std::stringstream ss;
+  ss << "writing " << kind << mesh->nglobal_ents(mesh->dim()) << " tet mesh";
+  log.stop(t0, "binary_write" + suffix, ss.str(), mesh->nelems(), 1);
+  t0 = log.start();
+  auto mesh2 = binary::read(path, mesh->comm());
+  ss.str("");
+  ss << "reading " << kind << mesh->nglobal_ents(mesh->dim()) << " tet mesh";
+  log.stop(t0, "binary_read" + suffix, ss.str(), mesh2.nelems(), 1);
+  if (mesh->comm()->rank() == 0) filesystem::remove_all(path);
+  mesh->comm()->barrier();
+}
+
+/* the time the caller spends in AsyncWriter::write,
+   and the time it then waits for the background write */
+void perf_async_binary_write(PerfLog& log, Mesh* mesh) {
+  std::string const path = "osh_perf_tmp.osh";
+  binary::AsyncWriter writer;
+  auto t0 = log.start();
+  writer.write(path, mesh);
+  std::stringstream ss;
+  ss << "queueing a write of a " << mesh->nglobal_ents(mesh->dim())
+     << " tet mesh";
+  log.stop(t0, "async_binary_write", ss.str(), mesh->nelems(), 1);
+  t0 = log.start();
+  writer.wait();
+  ss.str("");
+  ss << "waiting for a write of a " << mesh->nglobal_ents(mesh->dim())
+     << " tet mesh";
+  log.stop(t0, "async_binary_wait", ss.str(), mesh->nelems(), 1);
+  mesh->comm()->barrier();
+  if (mesh->comm()->rank() == 0) filesystem::remove_all(path);
+  mesh->comm()->barrier();
+}
+
+#ifdef OMEGA_H_USE_ZLIB
+void perf_vtk_write(PerfLog& log, Mesh* mesh, Codec codec) {
+  std::string const path = "osh_perf_tmp_vtk";
+  auto t0 = log.start();
+  vtk::write_parallel(path, mesh, mesh->dim(),
+      vtk::get_all_vtk_tags(mesh, mesh->dim()), true, codec);
+  std::stringstream ss;
+  ss << "writing a " << get_codec_adjective(codec) << "VTK file of a "
+     << mesh->nglobal_ents(mesh->dim()) << " tet mesh";
+  log.stop(
+      t0, "vtk_write" + get_codec_suffix(codec), ss.str(), mesh->nelems(), 1);
+  if (mesh->comm()->rank() == 0) filesystem::remove_all(path);
+  mesh->comm()->barrier();
+}
+#endif
+
+/* isotropic size field that asks for finer elements near x = 0 */
+void add_graded_metric(Mesh* mesh, Real h_fine, Real h_coarse) {
+  auto coords = mesh->coords();
+  Write<Real> metrics(mesh->nverts());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<3>(coords, v);
+    auto h = h_fine + (h_coarse - h_fine) * x[0];
+    metrics[v] = metric_eigenvalue_from_length(h);
+  };
+  parallel_for(mesh->nverts(), f);
+  mesh->add_tag(VERT, "metric", 1, Reals(metrics));
+}
+
+Mesh build_adapt_box(Library* lib, LO nx) {
+  auto mesh = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 1., nx, nx, nx);
+  mesh.set_parting(OMEGA_H_GHOSTED);
+  return mesh;
+}
+
+void perf_modifiers(PerfLog& log, Library* lib, LO nx) {
+  auto const h = 1.0 / Real(nx);
+  {
+    auto mesh = build_adapt_box(lib, nx);
+    mesh.add_tag(VERT, "metric", 1,
+        Reals(mesh.nverts(), metric_eigenvalue_from_length(h / 2.0)));
+    auto opts = AdaptOpts(&mesh);
+    opts.verbosity = SILENT;
+    auto nelems = mesh.nglobal_ents(mesh.dim());
+    auto t0 = log.start();
+    refine_by_size(&mesh, opts);
+    std::stringstream ss;
+    ss << "refine_by_size of a " << nelems << " tet mesh";
+    log.stop(t0, "refine_by_size", ss.str(), nelems, 1);
+    /* make every element a swap candidate so all interior edges are tried */
+    opts.min_quality_desired = 1.0;
+    t0 = log.start();
+    swap_edges(&mesh, opts);
+    ss.str("");
+    ss << "swap_edges of a " << mesh.nglobal_ents(mesh.dim()) << " tet mesh";
+    log.stop(t0, "swap_edges", ss.str(), mesh.nglobal_ents(mesh.dim()), 1);
+  }
+  {
+    auto mesh = build_adapt_box(lib, nx);
+    mesh.add_tag(VERT, "metric", 1,
+        Reals(mesh.nverts(), metric_eigenvalue_from_length(h * 2.0)));
+    auto opts = AdaptOpts(&mesh);
+    opts.verbosity = SILENT;
+    auto nelems = mesh.nglobal_ents(mesh.dim());
+    auto t0 = log.start();
+    coarsen_by_size(&mesh, opts);
+    std::stringstream ss;
+    ss << "coarsen_by_size of a " << nelems << " tet mesh";
+    log.stop(t0, "coarsen_by_size", ss.str(), nelems, 1);
+  }
+  {
+    auto mesh = build_adapt_box(lib, nx);
+    add_graded_metric(&mesh, h / 2.0, h * 2.0);
+    auto opts = AdaptOpts(&mesh);
+    opts.verbosity = SILENT;
+    auto nelems = mesh.nglobal_ents(mesh.dim());
+    auto t0 = log.start();
+    adapt(&mesh, opts);
+    std::stringstream ss;
+    ss << "adapting a " << nelems << " tet mesh to a graded size field";
+    log.stop(t0, "adapt", ss.str(), nelems, 1);
+  }
+  {
+    auto mesh = build_adapt_box(lib, nx);
+    add_graded_metric(&mesh, h / 2.0, h * 2.0);
+    auto opts = AdaptOpts(&mesh);
+    opts.verbosity = SILENT;
+    opts.should_fuse_refine_coarsen = true;
+    auto nelems = mesh.nglobal_ents(mesh.dim());
+    auto t0 = log.start();
+    adapt(&mesh, opts);
+    std::stringstream ss;
+    ss << "adapting a " << nelems
+       << " tet mesh to a graded size field, fusing refine and coarsen";
+    log.stop(t0, "adapt_fused", ss.str(), nelems, 1);
+  }
+}
+
+}  // end anonymous namespace
+
+int main(int argc, char** argv) {
+  auto lib = Library(&argc, &argv);
+  auto world = lib.world();
+  CmdLine cmdline;
+  auto& n_flag = cmdline.add_flag("--n", "number of tensors/keys/reals");
+  n_flag.add_arg<int>("value");
+  auto& box_flag = cmdline.add_flag("--box", "divisions of the box mesh");
+  box_flag.add_arg<int>("value");
+  auto& adapt_box_flag =
+      cmdline.add_flag("--adapt-box", "divisions of the box to adapt");
+  adapt_box_flag.add_arg<int>("value");
+  auto& json_flag =
+      cmdline.add_flag("--json", "write machine-readable results to a file");
+  json_flag.add_arg<std::string>("path");
+  if (!cmdline.parse_final(world, &argc, argv)) return -1;
+  LO n = 1000 * 1000;
+  LO nx = 42;
+  LO adapt_nx = 12;
+  if (cmdline.parsed("--n")) n = cmdline.get<int>("--n", "value");
+  if (cmdline.parsed("--box")) nx = cmdline.get<int>("--box", "value");
+  if (cmdline.parsed("--adapt-box")) {
+    adapt_nx = cmdline.get<int>("--adapt-box", "value");
+  }
+  PerfLog log(world);
+  perf_metric_decomposition(log, n);
+  perf_metric_decomposition_batched(log, n);
+  perf_linearize_metrics(log, n);
+  perf_metric_inversion(log, n);
+  perf_sum(log, n);
+  for (Int width = 1; width <= 3; ++width) perf_sort_by_keys(log, n, width);
+  {
+    auto mesh = perf_build_box(log, &lib, nx);
+    /* reordering is only defined on a single rank */
+    if (world->size() == 1) perf_reorder(log, &mesh);
+    perf_ask_verts(log, &mesh);
+    perf_invert_adj(log, &mesh);
+    perf_reflect_down(log, &mesh);
+    perf_find_unique(log, &mesh);
+    perf_sync_tags(log, &mesh);
+    if (world->size() > 1) {
+      /* recursive inertial bisection needs a power of two ranks */
+      if (!(world->size() & (world->size() - 1))) {
+        perf_balance(log, &mesh, OMEGA_H_RIB);
+      }
+      perf_balance(log, &mesh, OMEGA_H_MULTILEVEL);
+      perf_balance(log, &mesh, OMEGA_H_HILBERT);
+    }
+    if (world->size() > 1) perf_reghost(log, mesh, nx);
+    perf_ghost(log, &mesh);
+    perf_gradation(log, &mesh);
+#ifdef OMEGA_H_USE_ZLIB
+    for (auto codec : {CODEC_ZLIB, CODEC_SHUFFLE_ZLIB, CODEC_ZLIB_HUFFMAN}) {
+      perf_binary_io(log, &mesh, true, codec);
+    }
+    perf_vtk_write(log, &mesh, CODEC_ZLIB);
+    perf_vtk_write(log, &mesh, CODEC_ZLIB_HUFFMAN);
+#endif
+    perf_binary_io(log, &mesh, false);
+    perf_async_binary_write(log, &mesh);
+  }
+  perf_modifiers(log, &lib, adapt_nx);
+  if (cmdline.parsed("--json") && world->rank() == 0) {
+    write_json(log, cmdline.get<std::string>("--json", "path"));
+  }
+  return 0;
+}
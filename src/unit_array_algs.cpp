@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <vector>
+
 #include "Omega_h_adj.hpp"
 #include "Omega_h_align.hpp"
 #include "Omega_h_array_ops.hpp"
@@ -8,6 +11,7 @@
 #include "Omega_h_linpart.hpp"
 #include "Omega_h_map.hpp"
 #include "Omega_h_mark.hpp"
+#include "Omega_h_pool.hpp"
 #include "Omega_h_sort.hpp"
 
 using namespace Omega_h;
@@ -56,6 +60,40 @@ static void test_sort() {
   }
 }
 
+template <typename T>
+static void test_sort_against_stable(LO n, Int width, T range, T offset) {
+  HostWrite<T> h_keys(n * width);
+  std::uint64_t state = 42;
+  for (LO i = 0; i < n * width; ++i) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    h_keys[i] = T(offset + T((state >> 33) % std::uint64_t(range)));
+  }
+  std::vector<LO> expected(static_cast<std::size_t>(n));
+  for (LO i = 0; i < n; ++i) expected[std::size_t(i)] = i;
+  std::stable_sort(expected.begin(), expected.end(), [&](LO a, LO b) {
+    for (Int j = 0; j < width; ++j) {
+      if (h_keys[a * width + j] != h_keys[b * width + j]) {
+        return h_keys[a * width + j] < h_keys[b * width + j];
+      }
+    }
+    return false;
+  });
+  auto perm = HostRead<LO>(sort_by_keys(Read<T>(h_keys.write()), width));
+  for (LO i = 0; i < n; ++i) {
+    OMEGA_H_CHECK(perm[i] == expected[std::size_t(i)]);
+  }
+}
+
+static void test_sort_large() {
+  for (Int width = 1; width <= 3; ++width) {
+    /* small ranges take the radix path, huge ranges the comparison path */
+    test_sort_against_stable<LO>(5000, width, 300, -100);
+    test_sort_against_stable<LO>(5000, width, 7, 0);
+    test_sort_against_stable<GO>(5000, width, 1000, GO(1) << 40);
+    test_sort_against_stable<GO>(5000, width, GO(1) << 50, -(GO(1) << 49));
+  }
+}
+
 static void test_sort_small_range() {
   Read<I32> in({10, 100, 1000, 10, 100, 1000, 10, 100, 1000});
   LOs perm;
@@ -72,6 +110,40 @@ static void test_sort_small_range() {
   OMEGA_H_CHECK(uniq == Read<I32>({}));
 }
 
+static void test_pool_classes() {
+  for (std::size_t size = 1; size < 100000; ++size) {
+    auto const size_class = get_pool_class(size);
+    auto const class_size = get_pool_class_size(size_class);
+    OMEGA_H_CHECK(class_size >= size);
+    OMEGA_H_CHECK(4 * class_size <= 5 * size + 4);
+    OMEGA_H_CHECK(
+        size_class == 1 || get_pool_class_size(size_class - 1) < size);
+  }
+  OMEGA_H_CHECK(get_pool_class(~std::size_t(0)) < pool_nclasses);
+}
+
+static void test_pool() {
+  Pool pool([](std::size_t size) { return std::malloc(size); },
+      [](void* ptr, std::size_t) { std::free(ptr); });
+  auto a = allocate(pool, 1000);
+  auto b = allocate(pool, 1000);
+  OMEGA_H_CHECK(a != b);
+  deallocate(pool, a, 1000);
+  auto c = allocate(pool, 1010);
+  OMEGA_H_CHECK(c == a);
+  deallocate(pool, b, 1000);
+  deallocate(pool, c, 1010);
+  auto stats = get_stats(pool);
+  OMEGA_H_CHECK(stats.nallocations == 3);
+  OMEGA_H_CHECK(stats.ndeallocations == 3);
+  OMEGA_H_CHECK(stats.nreuses == 1);
+  OMEGA_H_CHECK(stats.used_bytes == 0);
+  OMEGA_H_CHECK(stats.requested_bytes == 0);
+  OMEGA_H_CHECK(
+      stats.cached_bytes == 2 * get_pool_class_size(get_pool_class(1000)));
+  OMEGA_H_CHECK(stats.high_water_bytes == stats.cached_bytes);
+}
+
 static void test_scan() {
   {
     LOs scanned = offset_scan(LOs(3, 1));
@@ -147,6 +219,21 @@ static void test_invert_adj() {
           make_code(0, 0, 2), make_code(0, 0, 0), make_code(0, 0, 1)}));
 }
 
+static void test_patch_up_adj() {
+  Adj old_tris2verts(LOs({0, 1, 2, 2, 3, 0}));
+  auto old_verts2tris = invert_adj(old_tris2verts, 3, 4, 2, 0);
+  /* the second triangle is split about a new vertex and
+     the first one is numbered between the products */
+  Adj prods2verts(LOs({2, 3, 4, 3, 0, 4}));
+  auto new_verts2tris = patch_up_adj(old_verts2tris, LOs({0, 1, 2, 3}),
+      LOs({1, -1}), prods2verts, LOs({0, 2}), 3, 5, 2, 0);
+  Adj new_tris2verts(LOs({2, 3, 4, 0, 1, 2, 3, 0, 4}));
+  auto derived = invert_adj(new_tris2verts, 3, 5, 2, 0);
+  OMEGA_H_CHECK(new_verts2tris.a2ab == derived.a2ab);
+  OMEGA_H_CHECK(new_verts2tris.ab2b == derived.ab2b);
+  OMEGA_H_CHECK(new_verts2tris.codes == derived.codes);
+}
+
 static void test_injective_map() {
   LOs primes2ints({2, 3, 5, 7});
   LOs ints2primes = invert_injective_map(primes2ints, 8);
@@ -316,12 +403,16 @@ int main(int argc, char** argv) {
   test_int128();
   test_repro_sum();
   test_sort();
+  test_sort_large();
   test_sort_small_range();
+  test_pool_classes();
+  test_pool();
   test_scan();
   test_fan_and_funnel();
   test_permute();
   test_invert_map();
   test_invert_adj();
+  test_patch_up_adj();
   test_injective_map();
   test_binary_search();
   test_is_sorted();
@@ -1,10 +1,14 @@
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_build.hpp"
 #include "Omega_h_compare.hpp"
+#include "Omega_h_for.hpp"
+#include "Omega_h_map.hpp"
+#include "Omega_h_owners.hpp"
 #include "Omega_h_vtk.hpp"
 #include "Omega_h_xml_lite.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -898,7 +902,8 @@ $Elements
 $EndElements
 )GMSH";
 
-static void test_file_components(bool is_compressed, bool needs_swapping) {
+static void test_file_components(
+    bool is_compressed, bool needs_swapping, Codec codec = CODEC_ZLIB) {
   using namespace binary;
   std::stringstream stream;
   std::string s = "foo";
@@ -912,13 +917,13 @@ static void test_file_components(bool is_compressed, bool needs_swapping) {
   Real d = 4.2;
   write_value(stream, d, needs_swapping);
   Read<I8> aa(n, 0, a);
-  write_array(stream, aa, is_compressed, needs_swapping);
+  write_array(stream, aa, is_compressed, needs_swapping, codec);
   Read<I32> ab(n, 0, b);
-  write_array(stream, ab, is_compressed, needs_swapping);
+  write_array(stream, ab, is_compressed, needs_swapping, codec);
   Read<I64> ac(n, 0, c);
-  write_array(stream, ac, is_compressed, needs_swapping);
+  write_array(stream, ac, is_compressed, needs_swapping, codec);
   Read<Real> ad(n, 0, d);
-  write_array(stream, ad, is_compressed, needs_swapping);
+  write_array(stream, ad, is_compressed, needs_swapping, codec);
   write(stream, s, needs_swapping);
   I8 a2;
   read_value(stream, a2, needs_swapping);
@@ -953,18 +958,45 @@ static void test_file_components() {
   test_file_components(false, false);
   test_file_components(false, true);
 #ifdef OMEGA_H_USE_ZLIB
-  test_file_components(true, false);
-  test_file_components(true, true);
+  for (auto codec : {CODEC_ZLIB, CODEC_SHUFFLE_ZLIB, CODEC_ZLIB_HUFFMAN}) {
+    test_file_components(true, false, codec);
+    test_file_components(true, true, codec);
+  }
 #endif
 }
 
+#ifdef OMEGA_H_USE_ZLIB
+/* small blocks, so that there are many of them and the last is partial */
+static void test_compressed_blocks(Codec codec) {
+  std::vector<Real> data(1000);
+  for (std::size_t i = 0; i < data.size(); ++i) data[i] = std::sqrt(Real(i));
+  auto const nbytes = data.size() * sizeof(Real);
+  auto const blocks =
+      compress_blocks(data.data(), nbytes, sizeof(Real), codec, 96 * 8);
+  OMEGA_H_CHECK(blocks.block_bytes == 96 * 8);
+  OMEGA_H_CHECK(blocks.sizes.size() == 11);
+  std::vector<Real> data2(data.size());
+  decompress_blocks(blocks, sizeof(Real), codec, data2.data(), nbytes);
+  OMEGA_H_CHECK(data == data2);
+  auto const empty = compress_blocks(nullptr, 0, sizeof(Real), codec);
+  OMEGA_H_CHECK(empty.sizes.size() == 1);
+  decompress_blocks(empty, sizeof(Real), codec, nullptr, 0);
+}
+
+static void test_compressed_blocks() {
+  for (auto codec : {CODEC_ZLIB, CODEC_SHUFFLE_ZLIB, CODEC_ZLIB_HUFFMAN}) {
+    test_compressed_blocks(codec);
+  }
+}
+#endif
+
 static void build_empty_mesh(Mesh* mesh, Int dim) {
   build_from_elems_and_coords(mesh, OMEGA_H_SIMPLEX, dim, LOs({}), Reals({}));
 }
 
-static void test_file(Library* lib, Mesh* mesh0) {
+static void test_file(Library* lib, Mesh* mesh0, Codec codec = CODEC_ZLIB) {
   std::stringstream stream;
-  binary::write(stream, mesh0);
+  binary::write(stream, mesh0, OMEGA_H_DEFAULT_COMPRESS, codec);
   Mesh mesh1(lib);
   mesh1.set_comm(lib->self());
   binary::read(stream, &mesh1, binary::latest_version);
@@ -974,10 +1006,169 @@ static void test_file(Library* lib, Mesh* mesh0) {
   OMEGA_H_CHECK(*mesh0 == mesh1);
 }
 
+/* uncompressed files are mapped into memory when read,
+   and the mesh read from them must survive the file being rewritten */
+static void test_mapped_file(Library* lib) {
+  auto mesh0 = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 1., 2, 2, 2);
+  binary::write("unit_io_mapped.osh", &mesh0, false);
+  auto mesh1 = binary::read("unit_io_mapped.osh", lib->world());
+  OMEGA_H_CHECK(mesh0 == mesh1);
+  auto mesh2 = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 1., 1, 1, 1);
+  binary::write("unit_io_mapped.osh", &mesh2, false);
+  OMEGA_H_CHECK(mesh0 == mesh1);
+  auto mesh3 = binary::read("unit_io_mapped.osh", lib->world());
+  OMEGA_H_CHECK(mesh2 == mesh3);
+  filesystem::remove_all("unit_io_mapped.osh");
+}
+
+/* the meshes must be written as they were when write() was called,
+   even if they change or go away before the writes complete */
+static void test_async_writer(Library* lib) {
+  auto mesh0 = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 1., 2, 2, 2);
+  auto mesh1 = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 1., 1, 1, 1);
+  {
+    binary::AsyncWriter writer(1);
+    {
+      auto mesh2 = mesh0;
+      writer.write("unit_io_async0.osh", &mesh2);
+      mesh2.add_tag(VERT, "foo", 1, Reals(mesh2.nverts(), 1.0));
+    }
+    writer.write("unit_io_async1.osh", &mesh1, false);
+    writer.wait();
+    OMEGA_H_CHECK(writer.completed());
+    writer.write("unit_io_async2.osh", &mesh1, OMEGA_H_DEFAULT_COMPRESS,
+        CODEC_SHUFFLE_ZLIB);
+  }
+  auto mesh3 = binary::read("unit_io_async0.osh", lib->world());
+  OMEGA_H_CHECK(mesh0 == mesh3);
+  auto mesh4 = binary::read("unit_io_async1.osh", lib->world());
+  OMEGA_H_CHECK(mesh1 == mesh4);
+  auto mesh5 = binary::read("unit_io_async2.osh", lib->world());
+  OMEGA_H_CHECK(mesh1 == mesh5);
+  filesystem::remove_all("unit_io_async0.osh");
+  filesystem::remove_all("unit_io_async1.osh");
+  filesystem::remove_all("unit_io_async2.osh");
+}
+
+#ifdef OMEGA_H_THROW
+/* a part file that cannot be written fails on the background
+   thread, and the failure must come out of wait() */
+static void test_async_writer_failure(Library* lib) {
+  auto mesh = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 0., 1, 1, 0);
+  filesystem::path path = "unit_io_async_fail.osh";
+  auto blocker = path;
+  blocker /= std::to_string(lib->world()->rank()) + ".osh.tmp";
+  filesystem::create_directory(path);
+  filesystem::create_directory(blocker);
+  bool threw = false;
+  {
+    binary::AsyncWriter writer;
+    writer.write(path, &mesh);
+    try {
+      writer.wait();
+    } catch (Omega_h::exception const&) {
+      threw = true;
+    }
+    OMEGA_H_CHECK(writer.completed());
+  }
+  OMEGA_H_CHECK(threw);
+  filesystem::remove_all(path);
+}
+#endif
+
+static LOs globals_to_los(GOs globals) {
+  Write<LO> out(globals.size());
+  auto f = OMEGA_H_LAMBDA(LO i) { out[i] = LO(globals[i]); };
+  parallel_for(globals.size(), f);
+  return out;
+}
+
+template <typename T>
+static void compare_tag_to_whole(Mesh* part, Mesh* whole, Int ent_dim,
+    TagBase const* tagbase, LOs part2whole) {
+  auto const& name = tagbase->name();
+  auto const ncomps = tagbase->ncomps();
+  OMEGA_H_CHECK(part->has_tag(ent_dim, name));
+  auto const whole_data = whole->get_array<T>(ent_dim, name);
+  OMEGA_H_CHECK(part->get_array<T>(ent_dim, name) ==
+                read(unmap(part2whole, whole_data, ncomps)));
+}
+
+/* (part) is a piece of the mesh that (whole) holds all of, and each
+   of its entities must match the entity of (whole) with the same
+   global number in its element vertices and in every tag */
+static void compare_to_whole(Mesh* part, Mesh* whole) {
+  OMEGA_H_CHECK(part->dim() == whole->dim());
+  auto const dim = whole->dim();
+  for (Int d = 0; d <= dim; ++d) {
+    OMEGA_H_CHECK(part->nglobal_ents(d) == GO(whole->nents(d)));
+    auto const globals2whole =
+        invert_permutation(globals_to_los(whole->globals(d)));
+    auto const part2whole =
+        read(unmap(globals_to_los(part->globals(d)), globals2whole, 1));
+    if (d == dim) {
+      auto const deg = whole->ask_elem_verts().size() / whole->nelems();
+      auto const part_conn =
+          read(unmap(part->ask_elem_verts(), part->globals(VERT), 1));
+      auto const whole_conn =
+          read(unmap(whole->ask_elem_verts(), whole->globals(VERT), 1));
+      OMEGA_H_CHECK(part_conn == read(unmap(part2whole, whole_conn, deg)));
+    }
+    for (Int i = 0; i < whole->ntags(d); ++i) {
+      auto const tagbase = whole->get_tag(d, i);
+      switch (tagbase->type()) {
+        case OMEGA_H_I8:
+          compare_tag_to_whole<I8>(part, whole, d, tagbase, part2whole);
+          break;
+        case OMEGA_H_I32:
+          compare_tag_to_whole<I32>(part, whole, d, tagbase, part2whole);
+          break;
+        case OMEGA_H_I64:
+          compare_tag_to_whole<I64>(part, whole, d, tagbase, part2whole);
+          break;
+        case OMEGA_H_F64:
+          compare_tag_to_whole<Real>(part, whole, d, tagbase, part2whole);
+          break;
+      }
+    }
+  }
+}
+
+/* a shared file must read back onto a different number of ranks */
+static void test_shared_file(Library* lib) {
+  auto world = lib->world();
+  auto mesh0 = build_box(world, OMEGA_H_SIMPLEX, 1., 1., 1., 2, 2, 2);
+  /* values that differ for every entity, so that a read in the
+     wrong order shows */
+  mesh0.add_tag(VERT, "u", 1, get_component(mesh0.coords(), 3, 0));
+  mesh0.add_tag(REGION, "g", 1, mesh0.globals(REGION));
+  binary::write_shared("unit_io_shared.oshs", &mesh0);
+  /* the file numbers entities by owner, then by local index */
+  for (Int d = 0; d <= mesh0.dim(); ++d) {
+    mesh0.set_tag(d, "global", globals_from_owners(&mesh0, d));
+  }
+  auto mesh1 = read_mesh_file("unit_io_shared.oshs", world);
+  auto mesh2 = binary::read_shared("unit_io_shared.oshs", lib->self());
+  compare_to_whole(&mesh0, &mesh2);
+  compare_to_whole(&mesh1, &mesh2);
+  OMEGA_H_CHECK(mesh2.class_sets.size() == mesh0.class_sets.size());
+  for (auto& set : mesh0.class_sets) {
+    OMEGA_H_CHECK(mesh2.class_sets[set.first].size() == set.second.size());
+  }
+  world->barrier();
+  if (world->rank() == 0) filesystem::remove("unit_io_shared.oshs");
+}
+
 static void test_file(Library* lib) {
+  test_mapped_file(lib);
+  test_async_writer(lib);
+#ifdef OMEGA_H_THROW
+  test_async_writer_failure(lib);
+#endif
   {
     auto mesh0 = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 1., 1, 1, 1);
     test_file(lib, &mesh0);
+    test_file(lib, &mesh0, CODEC_SHUFFLE_ZLIB);
   }
   {
     Mesh mesh0(lib);
@@ -1134,10 +1325,11 @@ static void test_xml() {
   OMEGA_H_CHECK(tag.type == xml_lite::Tag::END);
 }
 
-static void test_read_vtu(Mesh* mesh0) {
+static void test_read_vtu(Mesh* mesh0, Codec codec = CODEC_ZLIB) {
   std::stringstream stream;
-  vtk::write_vtu(
-      stream, mesh0, mesh0->dim(), vtk::get_all_vtk_tags(mesh0, mesh0->dim()));
+  vtk::write_vtu(stream, mesh0, mesh0->dim(),
+      vtk::get_all_vtk_tags(mesh0, mesh0->dim()), OMEGA_H_DEFAULT_COMPRESS,
+      codec);
   Mesh mesh1(mesh0->library());
   vtk::read_vtu(stream, mesh0->comm(), &mesh1);
   auto opts = MeshCompareOpts::init(mesh0, VarCompareOpts::zero_tolerance());
@@ -1148,6 +1340,7 @@ static void test_read_vtu(Mesh* mesh0) {
 static void test_read_vtu(Library* lib) {
   auto mesh0 = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 1., 1, 1, 1);
   test_read_vtu(&mesh0);
+  test_read_vtu(&mesh0, CODEC_ZLIB_HUFFMAN);
 }
 
 int main(int argc, char** argv) {
@@ -1155,10 +1348,14 @@ int main(int argc, char** argv) {
   OMEGA_H_CHECK(std::string(lib.version()) == OMEGA_H_SEMVER);
   if (lib.world()->size() == 1) {
     test_file_components();
+#ifdef OMEGA_H_USE_ZLIB
+    test_compressed_blocks();
+#endif
     test_file(&lib);
     test_xml();
     test_read_vtu(&lib);
   }
+  test_shared_file(&lib);
   test_gmsh(&lib);
 #ifdef OMEGA_H_USE_GMSH
   test_gmsh_parallel(&lib);
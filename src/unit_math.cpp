@@ -6,6 +6,8 @@
 #include <Omega_h_shape.hpp>
 #include <Omega_h_svd.hpp>
 
+#include <vector>
+
 using namespace Omega_h;
 
 static void test_edge_length() {
@@ -484,6 +486,64 @@ static void test_quaternions() {
   test_quaternion(PI / 4.0, normalize(vector_3(-1.0, -1.0, -1.0)));
 }
 
+template <Int dim>
+static void test_eigen_pack(std::vector<Tensor<dim>> const& ms) {
+  for (std::size_t first = 0; first < ms.size(); first += eigen_pack_width) {
+    SymmPack<dim> pack;
+    for (Int k = 0; k < eigen_pack_width; ++k) {
+      set_lane(pack, k, ms[(first + std::size_t(k)) % ms.size()]);
+    }
+    auto const dds = decompose_symm_pack(pack);
+    for (Int k = 0; k < eigen_pack_width; ++k) {
+      auto const m = get_lane(pack, k);
+      auto const dd = get_lane(dds, k);
+      auto const tol = 1e-10 * max2(max_norm(m), 1.0);
+      OMEGA_H_CHECK(
+          are_close(transpose(dd.q) * dd.q, identity_matrix<dim, dim>()));
+      for (Int i = 0; i + 1 < dim; ++i) OMEGA_H_CHECK(dd.l[i] >= dd.l[i + 1]);
+      OMEGA_H_CHECK(max_norm(m - compose_ortho(dd.q, dd.l)) <= tol);
+      auto const expect = sort_by_magnitude(decompose_eigen_jacobi(m));
+      for (Int i = 0; i < dim; ++i) {
+        Real l = expect.l[i];
+        bool found = false;
+        for (Int j = 0; j < dim; ++j) {
+          found = found || are_close(dd.l[j], l, 1e-8, tol);
+        }
+        OMEGA_H_CHECK(found);
+      }
+    }
+  }
+}
+
+static void test_eigen_pack() {
+  auto const q =
+      rotate(PI / 4., vector_3(0, 0, 1)) * rotate(PI / 4., vector_3(0, 1, 0));
+  std::vector<Tensor<3>> ms3;
+  ms3.push_back(identity_matrix<3, 3>());
+  ms3.push_back(zero_matrix<3, 3>());
+  ms3.push_back(diagonal(vector_3(4, 4, 1)));
+  ms3.push_back(matrix_3x3(2, 0, 0, 0, 3, 4, 0, 4, 9));
+  ms3.push_back(-matrix_3x3(2, 0, 0, 0, 3, 4, 0, 4, 9));
+  for (auto h : {vector_3(1e+3, 1, 1), vector_3(1, 1e+3, 1e+3),
+           vector_3(1e-3, 1, 1), vector_3(1, 1e-3, 1e-3),
+           vector_3(1e-6, 1e-3, 1e-3), vector_3(1, 2, 3),
+           vector_3(1, 1, 1 + 1e-9)}) {
+    ms3.push_back(compose_ortho(q, metric_eigenvalues_from_lengths(h)));
+  }
+  test_eigen_pack(ms3);
+  std::vector<Tensor<2>> ms2;
+  ms2.push_back(identity_matrix<2, 2>());
+  ms2.push_back(zero_matrix<2, 2>());
+  ms2.push_back(matrix_2x2(2, 1, 1, 2));
+  ms2.push_back(matrix_2x2(-3, 1e-3, 1e-3, 5));
+  ms2.push_back(matrix_2x2(1e6, 0, 0, 1));
+  test_eigen_pack(ms2);
+  std::vector<Tensor<1>> ms1;
+  ms1.push_back(matrix_1x1(42.0));
+  ms1.push_back(matrix_1x1(0.0));
+  test_eigen_pack(ms1);
+}
+
 int main(int argc, char** argv) {
   auto lib = Library(&argc, &argv);
   OMEGA_H_CHECK(std::string(lib.version()) == OMEGA_H_SEMVER);
@@ -497,6 +557,7 @@ int main(int argc, char** argv) {
   test_eigen_quadratic();
   test_eigen_cubic();
   test_eigen_jacobi();
+  test_eigen_pack();
   test_most_normal();
   test_intersect_metrics();
   test_interpolate_metrics();
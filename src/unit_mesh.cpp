@@ -1,23 +1,37 @@
 #include "Omega_h_align.hpp"
 #include "Omega_h_array_ops.hpp"
 #include "Omega_h_bbox.hpp"
+#include "Omega_h_coarsen.hpp"
 #include "Omega_h_build.hpp"
 #include "Omega_h_compare.hpp"
 #include "Omega_h_confined.hpp"
+#include "Omega_h_element.hpp"
 #include "Omega_h_for.hpp"
 #include "Omega_h_hilbert.hpp"
 #include "Omega_h_hypercube.hpp"
+#include "Omega_h_indset.hpp"
 #include "Omega_h_inertia.hpp"
 #include "Omega_h_int_scan.hpp"
+#include "Omega_h_laplace.hpp"
+#include "Omega_h_map.hpp"
+#include "Omega_h_mark.hpp"
+#include "Omega_h_metric.hpp"
 #include "Omega_h_mesh.hpp"
+#include "Omega_h_multilevel.hpp"
+#include "Omega_h_profile.hpp"
 #include "Omega_h_quality.hpp"
 #include "Omega_h_recover.hpp"
+#include "Omega_h_refine.hpp"
 #include "Omega_h_refine_qualities.hpp"
 #include "Omega_h_shape.hpp"
+#include "Omega_h_smooth.hpp"
+#include "Omega_h_swap.hpp"
 #include "Omega_h_swap2d.hpp"
 #include "Omega_h_swap3d_choice.hpp"
 #include "Omega_h_swap3d_loop.hpp"
 
+#include <algorithm>
+#include <set>
 #include <sstream>
 
 using namespace Omega_h;
@@ -208,6 +222,29 @@ static void test_find_unique() {
                 LOs({0, 1, 3, 0, 1, 2, 2, 3}));
 }
 
+static void test_find_unique_methods(Library* lib, Omega_h_Family family) {
+  auto mesh = build_box(lib->world(), family, 1., 1., 1., 3, 3, 3);
+  auto const ev2v = mesh.ask_elem_verts();
+  for (Int ldim = 1; ldim < mesh.dim(); ++ldim) {
+    auto const sorted =
+        find_unique(ev2v, family, mesh.dim(), ldim, UNIQUE_BY_SORTING);
+    for (auto method : {UNIQUE_BY_SORTING, UNIQUE_BY_HASHING,
+             UNIQUE_BY_HASHING_IN_USE_ORDER}) {
+      Adj h2l;
+      auto const lv2v =
+          find_unique(ev2v, family, mesh.dim(), ldim, &h2l, method);
+      OMEGA_H_CHECK(lv2v.size() == sorted.size());
+      if (method != UNIQUE_BY_HASHING_IN_USE_ORDER) {
+        OMEGA_H_CHECK(lv2v == sorted);
+      }
+      auto const expected = reflect_down(
+          ev2v, lv2v, family, mesh.nverts(), mesh.dim(), ldim);
+      OMEGA_H_CHECK(h2l.ab2b == expected.ab2b);
+      OMEGA_H_CHECK(h2l.codes == expected.codes);
+    }
+  }
+}
+
 static void test_hilbert() {
   /* this is the original test from Skilling's paper */
   hilbert::coord_t X[3] = {5, 10, 20};  // any position in 32x32x32 cube
@@ -379,6 +416,25 @@ static void test_average_field(Library* lib) {
   OMEGA_H_CHECK(are_close(e2x, Reals({5. / 3., 7. / 3.})));
 }
 
+static void test_laplacian(Library* lib) {
+  auto mesh = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 0., 8, 8, 0);
+  auto coords = mesh.coords();
+  auto interior = mark_by_class_dim(&mesh, VERT, 2);
+  /* a linear field is harmonic on this grid, so it should be
+     recovered from its boundary values alone */
+  auto initial_w = Write<Real>(mesh.nverts() * 2);
+  auto expected_w = Write<Real>(mesh.nverts() * 2);
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<2>(coords, v);
+    auto y = vector_2(x[0] + 2.0 * x[1], 1.0 - x[0]);
+    set_vector(expected_w, v, y);
+    set_vector(initial_w, v, interior[v] ? zero_vector<2>() : y);
+  };
+  parallel_for(mesh.nverts(), f);
+  auto solution = solve_laplacian(&mesh, initial_w, 2, 1e-10);
+  OMEGA_H_CHECK(are_close(solution, Reals(expected_w), 1e-8, 1e-8));
+}
+
 static void test_refine_qualities(Library* lib) {
   auto mesh = Mesh(lib);
   build_box_internal(&mesh, OMEGA_H_SIMPLEX, 1., 1., 0., 1, 1, 0);
@@ -390,6 +446,238 @@ static void test_refine_qualities(Library* lib) {
       quals, Reals({0.494872, 0.494872, 0.866025, 0.494872, 0.494872}), 1e-4));
 }
 
+/* whatever adjacencies adaptation carried over must equal
+   those derived from scratch */
+static void check_modified_adjs(Mesh* mesh) {
+  auto const family = mesh->family();
+  for (Int high_dim = 2; high_dim <= mesh->dim(); ++high_dim) {
+    for (Int low_dim = high_dim - 2; low_dim >= 0; --low_dim) {
+      if (!mesh->has_adj(high_dim, low_dim)) continue;
+      auto const derived = transit(mesh->ask_down(high_dim, low_dim + 1),
+          mesh->ask_down(low_dim + 1, low_dim), family, high_dim, low_dim);
+      auto const carried = mesh->ask_down(high_dim, low_dim);
+      OMEGA_H_CHECK(carried.ab2b == derived.ab2b);
+      if (low_dim > VERT) OMEGA_H_CHECK(carried.codes == derived.codes);
+    }
+  }
+  for (Int high_dim = 1; high_dim <= mesh->dim(); ++high_dim) {
+    for (Int low_dim = 0; low_dim < high_dim; ++low_dim) {
+      OMEGA_H_CHECK(mesh->has_adj(low_dim, high_dim));
+      auto const deg = element_degree(family, high_dim, low_dim);
+      auto const derived = invert_adj(mesh->ask_down(high_dim, low_dim), deg,
+          mesh->nents(low_dim), high_dim, low_dim);
+      auto const patched = mesh->ask_up(low_dim, high_dim);
+      OMEGA_H_CHECK(patched.a2ab == derived.a2ab);
+      OMEGA_H_CHECK(patched.ab2b == derived.ab2b);
+      OMEGA_H_CHECK(patched.codes == derived.codes);
+    }
+  }
+}
+
+/* a box with all upward adjacencies, sized to fit a uniform length
+   (h) except at the vertex at (spot), which wants length (spot_h) */
+static Mesh build_spot_box(Library* lib, Real h, Vector<3> spot, Real spot_h) {
+  auto mesh = build_box(lib->self(), OMEGA_H_SIMPLEX, 1., 1., 1., 4, 4, 4);
+  for (Int high_dim = 1; high_dim <= mesh.dim(); ++high_dim) {
+    for (Int low_dim = 0; low_dim < high_dim; ++low_dim) {
+      mesh.ask_up(low_dim, high_dim);
+    }
+  }
+  auto coords = mesh.coords();
+  Write<Real> metrics(mesh.nverts());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto at_spot = norm(get_vector<3>(coords, v) - spot) < 1e-6;
+    metrics[v] = metric_eigenvalue_from_length(at_spot ? spot_h : h);
+  };
+  parallel_for(mesh.nverts(), f);
+  mesh.add_tag(VERT, "metric", 1, Reals(metrics));
+  return mesh;
+}
+
+/* the modifications only touch the elements around one vertex, so
+   the upward adjacencies are patched rather than derived again */
+static void test_modify_adjs(Library* lib) {
+  auto mesh = build_spot_box(lib, 0.32, vector_3(0., 0., 0.), 0.05);
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  auto nelems = mesh.nelems();
+  OMEGA_H_CHECK(refine_by_size(&mesh, opts));
+  OMEGA_H_CHECK(mesh.nelems() * 8 < nelems * 9);
+  check_modified_adjs(&mesh);
+  mesh = build_spot_box(lib, 0.32, vector_3(0.5, 0.5, 0.5), 2.0);
+  nelems = mesh.nelems();
+  OMEGA_H_CHECK(coarsen_by_size(&mesh, opts));
+  OMEGA_H_CHECK(mesh.nelems() < nelems);
+  OMEGA_H_CHECK(mesh.nelems() * 9 > nelems * 8);
+  check_modified_adjs(&mesh);
+}
+
+/* the sorted vertex coordinates of each marked triangle */
+static std::set<std::vector<Real>> get_tri_points(
+    Mesh* mesh, Read<I8> marks) {
+  HostRead<Real> coords(mesh->coords());
+  HostRead<LO> ev2v(mesh->ask_elem_verts());
+  HostRead<I8> host_marks(marks);
+  std::set<std::vector<Real>> points;
+  for (LO e = 0; e < mesh->nelems(); ++e) {
+    if (!host_marks[e]) continue;
+    std::vector<std::pair<Real, Real>> tri_points;
+    for (Int i = 0; i < 3; ++i) {
+      auto v = ev2v[e * 3 + i];
+      tri_points.push_back({coords[v * 2 + 0], coords[v * 2 + 1]});
+    }
+    std::sort(tri_points.begin(), tri_points.end());
+    std::vector<Real> flat;
+    for (auto& p : tri_points) {
+      flat.push_back(p.first);
+      flat.push_back(p.second);
+    }
+    points.insert(flat);
+  }
+  return points;
+}
+
+/* elements outside the region and its buffer layer keep their
+   vertices, while the region itself is refined */
+static void test_adapt_region(Library* lib) {
+  auto mesh = build_box(lib->self(), OMEGA_H_SIMPLEX, 1., 1., 0., 8, 8, 0);
+  auto count_elems_within = [&](Real lo, Real hi) {
+    auto coords = mesh.coords();
+    auto ev2v = mesh.ask_elem_verts();
+    Write<I8> within_w(mesh.nelems());
+    auto f = OMEGA_H_LAMBDA(LO e) {
+      within_w[e] = 1;
+      for (Int i = 0; i < 3; ++i) {
+        auto x = coords[ev2v[e * 3 + i] * 2 + 0];
+        if (x < lo - 1e-10 || hi + 1e-10 < x) within_w[e] = 0;
+      }
+    };
+    parallel_for(mesh.nelems(), f);
+    return get_sum(read(within_w));
+  };
+  auto coords = mesh.coords();
+  auto ev2v = mesh.ask_elem_verts();
+  Write<I8> region_w(mesh.nelems());
+  auto f = OMEGA_H_LAMBDA(LO e) {
+    Real x = 0.0;
+    for (Int i = 0; i < 3; ++i) x += coords[ev2v[e * 3 + i] * 2 + 0] / 3.0;
+    region_w[e] = (x < 0.25);
+  };
+  parallel_for(mesh.nelems(), f);
+  mesh.add_tag(FACE, "region", 1, read(region_w));
+  mesh.add_tag(VERT, "metric", 1,
+      Reals(mesh.nverts(), metric_eigenvalue_from_length(0.05)));
+  auto nregion_elems = count_elems_within(0.0, 0.25);
+  auto verts_near = mark_down(&mesh, FACE, VERT, read(region_w));
+  auto elems_far = invert_marks(mark_up(&mesh, VERT, FACE, verts_near));
+  auto far_points = get_tri_points(&mesh, elems_far);
+  OMEGA_H_CHECK(!far_points.empty());
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  opts.region_name = "region";
+  opts.xfer_opts.type_map["region"] = OMEGA_H_INHERIT;
+  OMEGA_H_CHECK(adapt(&mesh, opts));
+  OMEGA_H_CHECK(count_elems_within(0.0, 0.25) > 4 * nregion_elems);
+  auto new_points = get_tri_points(&mesh, Read<I8>(mesh.nelems(), 1));
+  for (auto& points : far_points) OMEGA_H_CHECK(new_points.count(points));
+  OMEGA_H_CHECK(mesh.has_tag(VERT, "region"));
+  OMEGA_H_CHECK(!mesh.has_tag(VERT, "adapt_region"));
+  OMEGA_H_CHECK(print_adapt_status(&mesh, opts));
+}
+
+static void test_smooth_verts(Library* lib) {
+  auto mesh = build_box(lib->self(), OMEGA_H_SIMPLEX, 1., 1., 0., 4, 4, 0);
+  /* pull the center vertex most of the way towards a neighbor */
+  auto coords_w = deep_copy(mesh.coords());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<2>(coords_w, v);
+    if (norm(x - vector_2(0.5, 0.5)) < 1e-10) {
+      set_vector(coords_w, v, vector_2(0.72, 0.7));
+    }
+  };
+  parallel_for(mesh.nverts(), f);
+  mesh.set_coords(read(coords_w));
+  mesh.add_tag(VERT, "metric", 1,
+      Reals(mesh.nverts(), metric_eigenvalue_from_length(0.25)));
+  auto coords = mesh.coords();
+  Write<Real> u_w(mesh.nverts());
+  auto g = OMEGA_H_LAMBDA(LO v) {
+    u_w[v] = coords[v * 2] + 2.0 * coords[v * 2 + 1];
+  };
+  parallel_for(mesh.nverts(), g);
+  mesh.add_tag(VERT, "u", 1, read(u_w));
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  opts.xfer_opts.type_map["u"] = OMEGA_H_LINEAR_INTERP;
+  auto old_min_qual = get_min(mesh.ask_qualities());
+  OMEGA_H_CHECK(old_min_qual < opts.min_quality_desired);
+  OMEGA_H_CHECK(smooth_verts(&mesh, opts));
+  while (smooth_verts(&mesh, opts))
+    ;
+  OMEGA_H_CHECK(get_min(mesh.ask_qualities()) > old_min_qual + 0.1);
+  auto new_coords = mesh.coords();
+  auto u = mesh.get_array<Real>(VERT, "u");
+  Write<Real> expected_w(mesh.nverts());
+  auto h = OMEGA_H_LAMBDA(LO v) {
+    expected_w[v] = new_coords[v * 2] + 2.0 * new_coords[v * 2 + 1];
+  };
+  parallel_for(mesh.nverts(), h);
+  OMEGA_H_CHECK(are_close(u, read(expected_w)));
+  OMEGA_H_CHECK(!(mesh.coords() == coords));
+}
+
+static std::size_t count_calls(profile::History const& history,
+    char const* name) {
+  std::size_t n = 0;
+  for (std::size_t i = 0; i < history.frames.size(); ++i) {
+    if (0 == std::strcmp(history.get_name(i), name)) {
+      n += history.frames[i].number_of_calls;
+    }
+  }
+  return n;
+}
+
+static void test_smooth_then_swap(Library* lib) {
+  /* a pulled center vertex under a metric stretched across the
+     diagonals of the box: smoothing keeps finding small gains but
+     stalls, and only swapping the diagonals reaches the goal */
+  auto mesh = build_box(lib->self(), OMEGA_H_SIMPLEX, 1., 1., 0., 4, 4, 0);
+  auto coords_w = deep_copy(mesh.coords());
+  auto f = OMEGA_H_LAMBDA(LO v) {
+    auto x = get_vector<2>(coords_w, v);
+    if (norm(x - vector_2(0.5, 0.5)) < 1e-10) {
+      set_vector(coords_w, v, vector_2(0.72, 0.7));
+    }
+  };
+  parallel_for(mesh.nverts(), f);
+  mesh.set_coords(read(coords_w));
+  auto metric = compose_metric(rotate(PI / 4.0), vector_2(0.15, 0.5));
+  mesh.add_tag(VERT, "metric", 3, repeat_symm(mesh.nverts(), metric));
+  auto opts = AdaptOpts(&mesh);
+  opts.verbosity = SILENT;
+  opts.min_quality_allowed = 0.1;
+  opts.should_refine = false;
+  opts.should_coarsen = false;
+  opts.should_smooth = true;
+  auto smoothed = mesh;
+  Int npasses = 0;
+  while (smooth_verts(&smoothed, opts)) ++npasses;
+  OMEGA_H_CHECK(npasses > 1);
+  OMEGA_H_CHECK(get_min(smoothed.ask_qualities()) < opts.min_quality_desired);
+  if (!profile::global_singleton_history) {
+    profile::History history;
+    profile::global_singleton_history = &history;
+    auto adapted = adapt(&mesh, opts);
+    profile::global_singleton_history = nullptr;
+    OMEGA_H_CHECK(adapted);
+    OMEGA_H_CHECK(get_min(mesh.ask_qualities()) >= opts.min_quality_desired);
+    /* every smoothing pass is followed by a swapping pass */
+    auto nsmooth = count_calls(history, "smooth_verts");
+    OMEGA_H_CHECK(nsmooth > 0);
+    OMEGA_H_CHECK(count_calls(history, "swap_edges") == nsmooth);
+  }
+}
+
 static void test_mark_up_down(Library* lib) {
   auto mesh = Mesh(lib);
   build_box_internal(&mesh, OMEGA_H_SIMPLEX, 1., 1., 0., 1, 1, 0);
@@ -399,6 +687,106 @@ static void test_mark_up_down(Library* lib) {
       mark_up(&mesh, VERT, FACE, Read<I8>({0, 1, 0, 0})) == Read<I8>({1, 0}));
 }
 
+static void check_indset(Graph graph, Read<I8> candidates, Read<I8> indset) {
+  HostRead<LO> offsets(graph.a2ab);
+  HostRead<LO> values(graph.ab2b);
+  HostRead<I8> host_candidates(candidates);
+  HostRead<I8> host_indset(indset);
+  for (LO i = 0; i < host_indset.size(); ++i) {
+    bool has_neighbor_in = false;
+    for (auto j = offsets[i]; j < offsets[i + 1]; ++j) {
+      if (host_indset[values[j]]) has_neighbor_in = true;
+    }
+    if (host_indset[i]) {
+      OMEGA_H_CHECK(host_candidates[i]);
+      OMEGA_H_CHECK(!has_neighbor_in);
+    } else if (host_candidates[i]) {
+      OMEGA_H_CHECK(has_neighbor_in);
+    }
+  }
+}
+
+static void test_indset(Library* lib) {
+  auto mesh = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 0., 4, 4, 0);
+  auto graph = mesh.ask_star(EDGE);
+  auto globals = mesh.globals(EDGE);
+  Write<I8> candidates_w(mesh.nedges());
+  auto f = OMEGA_H_LAMBDA(LO i) { candidates_w[i] = (globals[i] % 3 != 0); };
+  parallel_for(mesh.nedges(), f);
+  Read<I8> candidates(candidates_w);
+  auto quality = measure_edges_real(&mesh);
+  auto by_quality = find_indset(&mesh, EDGE, quality, candidates);
+  check_indset(graph, candidates, by_quality);
+  /* no round runs past the one that decides everything */
+  if (!profile::global_singleton_history) {
+    profile::History history;
+    profile::global_singleton_history = &history;
+    find_indset(&mesh, EDGE, quality, Read<I8>(mesh.nedges(), 0));
+    auto no_round = history.find_root("indset::round");
+    Write<I8> one_w(mesh.nedges(), 0);
+    one_w.set(0, 1);
+    auto one = find_indset(&mesh, EDGE, quality, read(one_w));
+    profile::global_singleton_history = nullptr;
+    OMEGA_H_CHECK(no_round == profile::invalid);
+    OMEGA_H_CHECK(one == read(one_w));
+    auto round = history.find_root("indset::round");
+    OMEGA_H_CHECK(round != profile::invalid);
+    OMEGA_H_CHECK(history.frames[round].number_of_calls == 1);
+  }
+}
+
+static void test_multilevel_partition(Library* lib) {
+  auto mesh = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 0., 8, 8, 0);
+  auto nelems = mesh.nelems();
+  for (Int nparts = 2; nparts <= 4; ++nparts) {
+    auto parts =
+        multilevel::partition(&mesh, Reals(nelems, 1.0), nparts, 0.03);
+    HostRead<I32> host_parts(parts);
+    std::vector<LO> sizes(std::size_t(nparts), 0);
+    for (LO i = 0; i < nelems; ++i) ++sizes[std::size_t(host_parts[i])];
+    for (auto size : sizes) {
+      OMEGA_H_CHECK(size > 0);
+      OMEGA_H_CHECK(Real(size) <= Real(nelems) / nparts * 1.03 + 1.0);
+    }
+    /* at least as good as cutting the element ordering into blocks */
+    Write<I32> blocks(nelems);
+    auto f = OMEGA_H_LAMBDA(LO i) {
+      blocks[i] = I32(I64(i) * nparts / nelems);
+    };
+    parallel_for(nelems, f);
+    OMEGA_H_CHECK(multilevel::edge_cut(&mesh, parts) <=
+                  multilevel::edge_cut(&mesh, Read<I32>(blocks)));
+  }
+}
+
+static void test_hilbert_partition(Library* lib) {
+  auto mesh = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 0., 8, 8, 0);
+  auto nelems = mesh.nelems();
+  Write<Real> masses_w(nelems);
+  auto f = OMEGA_H_LAMBDA(LO i) { masses_w[i] = Real(1 + i % 3); };
+  parallel_for(nelems, f);
+  Reals masses(masses_w);
+  auto total = get_sum(masses);
+  auto centroids = average_field(&mesh, 2, 2, mesh.coords());
+  HostRead<LO> order(hilbert::sort_coords(centroids, 2));
+  HostRead<Real> host_masses(masses);
+  for (Int nparts = 1; nparts <= 4; ++nparts) {
+    HostRead<I32> parts(hilbert::partition(&mesh, masses, nparts));
+    std::vector<Real> weights(std::size_t(nparts), 0.0);
+    for (LO i = 0; i < nelems; ++i) {
+      weights[std::size_t(parts[i])] += host_masses[i];
+    }
+    for (auto weight : weights) {
+      OMEGA_H_CHECK(weight > 0.0);
+      OMEGA_H_CHECK(weight <= total / nparts + 3.0);
+    }
+    /* each part is one piece of the curve */
+    for (LO i = 1; i < nelems; ++i) {
+      OMEGA_H_CHECK(parts[order[i - 1]] <= parts[order[i]]);
+    }
+  }
+}
+
 static void test_compare_meshes(Library* lib) {
   auto a = build_box(lib->world(), OMEGA_H_SIMPLEX, 1., 1., 0., 4, 4, 0);
   OMEGA_H_CHECK(a == a);
@@ -765,6 +1153,8 @@ int main(int argc, char** argv) {
   test_form_uses();
   test_reflect_down();
   test_find_unique();
+  test_find_unique_methods(&lib, OMEGA_H_SIMPLEX);
+  test_find_unique_methods(&lib, OMEGA_H_HYPERCUBE);
   test_hilbert();
   test_bbox();
   test_build(&lib);
@@ -773,8 +1163,16 @@ int main(int argc, char** argv) {
   test_quality();
   test_inertial_bisect(&lib);
   test_average_field(&lib);
+  test_laplacian(&lib);
   test_refine_qualities(&lib);
+  test_modify_adjs(&lib);
+  test_adapt_region(&lib);
+  test_smooth_verts(&lib);
+  test_smooth_then_swap(&lib);
   test_mark_up_down(&lib);
+  test_indset(&lib);
+  test_multilevel_partition(&lib);
+  test_hilbert_partition(&lib);
   test_compare_meshes(&lib);
   test_swap2d_topology(&lib);
   test_swap3d_loop(&lib);